@@ -39,9 +39,14 @@ pub fn build(b: *std.Build) void {
     cozz_runtime.root_module.addCSourceFiles(.{
         .files = &.{
             "cozz/cozz_runtime.cpp",
+            // Kernel tiers select their instruction set with target pragmas and
+            // are picked at runtime from cpu features, so they take no -m flags;
+            // on other archs a tier compiles to a null table.
+            "cozz/cozz_kernels_avx2.cpp",
 
             "ozz/src_fused/ozz_animation.cc",
             "ozz/src_fused/ozz_base.cc",
+            "ozz/src_fused/ozz_geometry.cc",
         },
         .flags = &.{
             "-std=c++20",
@@ -76,6 +81,8 @@ pub fn build(b: *std.Build) void {
     });
     cozz_offline.root_module.link_libc = true;
     cozz_offline.root_module.link_libcpp = true;
+    // Offline tools sample runtime clips and load/save runtime assets.
+    cozz_offline.root_module.linkLibrary(cozz_runtime);
 
     //
     // Example
@@ -0,0 +1,17 @@
+
+#pragma once
+
+#include "cozz_runtime.h"
+
+// Allocation category shared by the runtime and offline libraries. Every
+// block ozz allocates on this thread is counted under the current category.
+// Returns the previous one.
+ozz_alloc_category_t cozz_swap_alloc_category(ozz_alloc_category_t category);
+
+struct CozzAllocScope {
+  explicit CozzAllocScope(ozz_alloc_category_t category) : previous(cozz_swap_alloc_category(category)) {}
+  ~CozzAllocScope() { cozz_swap_alloc_category(previous); }
+  CozzAllocScope(const CozzAllocScope&) = delete;
+  CozzAllocScope& operator=(const CozzAllocScope&) = delete;
+  ozz_alloc_category_t previous;
+};
@@ -0,0 +1,72 @@
+
+#pragma once
+
+#include "cozz_runtime.h"
+
+#include <cstddef>
+
+// Hot kernels built once per ISA tier and picked at runtime from cpu features.
+// The baseline tier lives in cozz_runtime.cpp and uses the target's default
+// instruction set. Other tiers compile a private copy of the ozz jobs
+// (ozz/src_fused/ozz_animation_jobs.inl) under a renamed namespace with their
+// own target, so no ozz inline math is shared between tiers with mismatched
+// instructions. Entry points only take plain
+// pointers; ozz objects are passed as the main build's jobs and matrices.
+
+// ozz_ltm_levels_t without its containers.
+struct cozz_ltm_levels_view_t {
+  int32_t num_groups;
+  const int32_t* joints;
+  const int32_t* parents;
+  const int32_t* local_offsets;
+  const uint8_t* lanes;
+};
+
+// ozz_motion_db_t's search data. Frames are costed a small box (4 x 4 lanes)
+// at a time, and skipped a box at a time when the box is farther from the
+// query than the best frame so far.
+static constexpr int32_t kMotionSmallBlock = 16;
+static constexpr int32_t kMotionLargeBlock = 64;
+
+struct cozz_motion_db_view_t {
+  int32_t num_frames;
+  int32_t padded_dims;       // normalized feature floats, padded to a multiple of 4
+  const float* features;     // [frame / 4][padded_dims][frame % 4], whole small boxes
+  const float* small_bounds; // [box][2][padded_dims]: min, then max
+  const float* large_bounds;
+};
+
+struct cozz_kernels_t {
+  const char* name;
+  // Run an ozz::animation::SamplingJob / BlendingJob / LocalToModelJob.
+  bool (*sampling)(const void* job);
+  bool (*blending)(const void* job);
+  bool (*local_to_model)(const void* job);
+  // SoaTransform locals -> Float4x4 models in level order.
+  void (*level_local_to_model)(const cozz_ltm_levels_view_t* levels, const float* locals, float* models);
+  // Local-to-model of the listed DF-ordered joints only, parents being
+  // computed already; also writes their palette entries.
+  void (*ltm_joints)(const float* locals, const int16_t* parents, const int32_t* joints, int32_t count,
+                     float* models, float* palette);
+  // Float4x4 models -> 3x4 palette, joint_stride floats apart; joint position
+  // min/max into bounds6 unless null.
+  void (*store_palette)(const float* models, int32_t num_joints, float* palette, size_t joint_stride, float* bounds6);
+  // ozz DecodeGV4Stream: decodes count values (a multiple of 4) and returns
+  // the bytes used. size covers 3 readable bytes past the encoded data.
+  size_t (*decode_gv4_stream)(const uint8_t* buffer, size_t size, uint32_t* values, size_t count);
+  // Frame with the smallest squared distance to a normalized, padded query
+  // (16-byte aligned). Database arrays need only be float aligned.
+  void (*motion_search)(const cozz_motion_db_view_t* db, const float* query, int32_t* out_frame, float* out_cost);
+  // Skins the leading multiple of 8 vertices of a validated desc and returns
+  // how many were done. Null when the tier has no skinning kernel.
+  int32_t (*skin)(const ozz_skinning_desc_t* desc);
+};
+
+const cozz_kernels_t* cozz_kernels_baseline();
+
+// Null when this build has no AVX2 tier.
+const cozz_kernels_t* cozz_kernels_avx2();
+
+// The main build's group varint decoder: the baseline tier's, and the tail of
+// other tiers' streams.
+size_t cozz_decode_gv4_stream(const uint8_t* buffer, size_t size, uint32_t* values, size_t count);
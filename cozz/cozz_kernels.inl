@@ -0,0 +1,208 @@
+
+// Kernel bodies shared by every ISA tier. Included once per tier, after the
+// ozz runtime headers: inside a tier `ozz` names that tier's private copy of
+// the library, so everything below is compiled with the tier's instruction set.
+// Jobs cross the boundary as the main build's objects, which have the same
+// layout in every copy.
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+inline ozz::math::SimdFloat4 gather_lanes(const float* base, const int32_t* offsets, int32_t component) {
+  const int32_t c = component * 4;
+  return ozz::math::simd_float4::Load(base[offsets[0] + c], base[offsets[1] + c],
+                                      base[offsets[2] + c], base[offsets[3] + c]);
+}
+
+// Parent * local for affine SoA matrices: the w row is known to be (0, 0, 0, 1).
+inline ozz::math::SoaFloat4x4 soa_affine_mul(const ozz::math::SoaFloat4x4& a, const ozz::math::SoaFloat4x4& b) {
+  ozz::math::SoaFloat4x4 r;
+  for (int c = 0; c < 4; ++c) {
+    const ozz::math::SoaFloat4& bc = b.cols[c];
+    r.cols[c].x = a.cols[0].x * bc.x + a.cols[1].x * bc.y + a.cols[2].x * bc.z;
+    r.cols[c].y = a.cols[0].y * bc.x + a.cols[1].y * bc.y + a.cols[2].y * bc.z;
+    r.cols[c].z = a.cols[0].z * bc.x + a.cols[1].z * bc.y + a.cols[2].z * bc.z;
+  }
+  r.cols[3].x = r.cols[3].x + a.cols[3].x;
+  r.cols[3].y = r.cols[3].y + a.cols[3].y;
+  r.cols[3].z = r.cols[3].z + a.cols[3].z;
+  r.cols[0].w = r.cols[1].w = r.cols[2].w = ozz::math::simd_float4::zero();
+  r.cols[3].w = ozz::math::simd_float4::one();
+  return r;
+}
+
+bool kernel_sampling(const void* job) {
+  return static_cast<const ozz::animation::SamplingJob*>(job)->Run();
+}
+
+bool kernel_blending(const void* job) {
+  return static_cast<const ozz::animation::BlendingJob*>(job)->Run();
+}
+
+bool kernel_local_to_model(const void* job) {
+  return static_cast<const ozz::animation::LocalToModelJob*>(job)->Run();
+}
+
+// Level-ordered LTM: locals are gathered straight from the DF-ordered SoA pose
+// and parents from already computed levels, so each group is a single SoA
+// FromAffine + multiply. Only the results go through a transpose to AoS.
+void kernel_level_local_to_model(const cozz_ltm_levels_view_t* levels, const float* locals, float* models) {
+  const ozz::math::Float4x4 identity = ozz::math::Float4x4::identity();
+  ozz::math::Float4x4* out_model = reinterpret_cast<ozz::math::Float4x4*>(models);
+
+  for (int32_t g = 0; g < levels->num_groups; ++g) {
+    const int32_t* offsets = levels->local_offsets + (size_t)g * 4u;
+    const ozz::math::SoaFloat3 t = {gather_lanes(locals, offsets, 0), gather_lanes(locals, offsets, 1),
+                                    gather_lanes(locals, offsets, 2)};
+    const ozz::math::SoaQuaternion q = {gather_lanes(locals, offsets, 3), gather_lanes(locals, offsets, 4),
+                                        gather_lanes(locals, offsets, 5), gather_lanes(locals, offsets, 6)};
+    const ozz::math::SoaFloat3 sc = {gather_lanes(locals, offsets, 7), gather_lanes(locals, offsets, 8),
+                                     gather_lanes(locals, offsets, 9)};
+    const ozz::math::SoaFloat4x4 local = ozz::math::SoaFloat4x4::FromAffine(t, q, sc);
+
+    const int32_t* parents = levels->parents + (size_t)g * 4u;
+    const ozz::math::Float4x4* p[4];
+    for (int lane = 0; lane < 4; ++lane) {
+      p[lane] = parents[lane] == ozz::animation::Skeleton::kNoParent ? &identity : &out_model[parents[lane]];
+    }
+    ozz::math::SoaFloat4x4 parent;
+    for (int c = 0; c < 4; ++c) {
+      const ozz::math::SimdFloat4 col[4] = {p[0]->cols[c], p[1]->cols[c], p[2]->cols[c], p[3]->cols[c]};
+      ozz::math::Transpose4x4(col, &parent.cols[c].x);
+    }
+
+    const ozz::math::SoaFloat4x4 model = soa_affine_mul(parent, local);
+    ozz::math::Float4x4 aos[4];
+    ozz::math::Transpose16x16(&model.cols[0].x, aos->cols);
+
+    const int32_t* joints = levels->joints + (size_t)g * 4u;
+    for (int lane = 0; lane < levels->lanes[(size_t)g]; ++lane) {
+      out_model[joints[lane]] = aos[lane];
+    }
+  }
+}
+
+// Same math as LocalToModelJob, restricted to the listed (DF ordered) joints:
+// SoA groups are converted once and reused while consecutive joints share them.
+// Writes each joint's model matrix and palette entry.
+void kernel_ltm_joints(const float* locals, const int16_t* parents, const int32_t* joints, int32_t count,
+                       float* models, float* palette) {
+  const ozz::math::SoaTransform* soa = reinterpret_cast<const ozz::math::SoaTransform*>(locals);
+  ozz::math::Float4x4* model = reinterpret_cast<ozz::math::Float4x4*>(models);
+  const ozz::math::Float4x4 identity = ozz::math::Float4x4::identity();
+  ozz::math::Float4x4 local_aos[4];
+  int32_t cached_soa = -1;
+  for (int32_t i = 0; i < count; ++i) {
+    const int32_t j = joints[i];
+    if ((j >> 2) != cached_soa) {
+      cached_soa = j >> 2;
+      const ozz::math::SoaTransform& t = soa[cached_soa];
+      const ozz::math::SoaFloat4x4 local_soa = ozz::math::SoaFloat4x4::FromAffine(t.translation, t.rotation, t.scale);
+      ozz::math::Transpose16x16(&local_soa.cols[0].x, local_aos->cols);
+    }
+    const int32_t parent = parents[j];
+    const ozz::math::Float4x4& parent_matrix = parent == ozz::animation::Skeleton::kNoParent ? identity : model[parent];
+    model[j] = parent_matrix * local_aos[j & 3];
+    float* out12 = palette + (size_t)j * 12u;
+    ozz::math::Store3PtrU(model[j].cols[0], out12 + 0);
+    ozz::math::Store3PtrU(model[j].cols[1], out12 + 3);
+    ozz::math::Store3PtrU(model[j].cols[2], out12 + 6);
+    ozz::math::Store3PtrU(model[j].cols[3], out12 + 9);
+  }
+}
+
+// Palette store fused with the joint position min/max reduction.
+// Offsets +3/+6/+9 are NOT 16-byte aligned -> must use Store3PtrU.
+void kernel_store_palette(const float* models, int32_t num_joints, float* palette, size_t joint_stride, float* bounds6) {
+  using namespace ozz::math;
+  const Float4x4* model = reinterpret_cast<const Float4x4*>(models);
+  SimdFloat4 min = simd_float4::Load1(std::numeric_limits<float>::max());
+  SimdFloat4 max = -min;
+  for (int32_t i = 0; i < num_joints; ++i) {
+    float* out12 = palette + (size_t)i * joint_stride;
+    Store3PtrU(model[i].cols[0], out12 + 0);
+    Store3PtrU(model[i].cols[1], out12 + 3);
+    Store3PtrU(model[i].cols[2], out12 + 6);
+    Store3PtrU(model[i].cols[3], out12 + 9);
+    min = Min(min, model[i].cols[3]);
+    max = Max(max, model[i].cols[3]);
+  }
+  if (bounds6) {
+    Store3PtrU(min, bounds6 + 0);
+    Store3PtrU(max, bounds6 + 3);
+  }
+}
+
+// Squared distance from query to the [lo, hi] box. Database floats live in
+// ozz::vectors, which only guarantee float alignment: loaded unaligned.
+inline float motion_box_cost(const float* lo, const float* hi, const float* query, int32_t padded_dims) {
+  using namespace ozz::math;
+  const SimdFloat4 zero = simd_float4::zero();
+  SimdFloat4 acc = zero;
+  for (int32_t k = 0; k < padded_dims; k += 4) {
+    const SimdFloat4 q = simd_float4::LoadPtr(query + k);
+    const SimdFloat4 d = Max(Max(simd_float4::LoadPtrU(lo + k) - q, q - simd_float4::LoadPtrU(hi + k)), zero);
+    acc = MAdd(d, d, acc);
+  }
+  return GetX(HAdd4(acc));
+}
+
+void kernel_motion_search(const cozz_motion_db_view_t* db, const float* query, int32_t* out_frame, float* out_cost) {
+  using namespace ozz::math;
+  const int32_t dims = db->padded_dims;
+  const size_t box_floats = (size_t)dims * 2u;
+  float best = std::numeric_limits<float>::infinity();
+  int32_t best_frame = -1;
+  for (int32_t large = 0; large * kMotionLargeBlock < db->num_frames; ++large) {
+    const float* large_box = db->large_bounds + (size_t)large * box_floats;
+    if (motion_box_cost(large_box, large_box + dims, query, dims) >= best) continue;
+
+    const int32_t large_end = std::min(db->num_frames, (large + 1) * kMotionLargeBlock);
+    for (int32_t first = large * kMotionLargeBlock; first < large_end; first += kMotionSmallBlock) {
+      const float* small_box = db->small_bounds + (size_t)(first / kMotionSmallBlock) * box_floats;
+      if (motion_box_cost(small_box, small_box + dims, query, dims) >= best) continue;
+
+      // One accumulator per 4 frames, so the chains overlap.
+      const float* lanes = db->features + (size_t)first * (size_t)dims;
+      const size_t group_floats = (size_t)dims * 4u;
+      SimdFloat4 acc[4] = {simd_float4::zero(), simd_float4::zero(), simd_float4::zero(), simd_float4::zero()};
+      for (int32_t k = 0; k < dims; ++k) {
+        const SimdFloat4 q = simd_float4::Load1(query[k]);
+        for (int g = 0; g < 4; ++g) {
+          const SimdFloat4 d = simd_float4::LoadPtrU(lanes + g * group_floats + (size_t)k * 4u) - q;
+          acc[g] = MAdd(d, d, acc[g]);
+        }
+      }
+      alignas(16) float costs[kMotionSmallBlock];
+      for (int g = 0; g < 4; ++g) StorePtr(acc[g], costs + 4 * g);
+      const int32_t count = std::min(kMotionSmallBlock, db->num_frames - first);
+      for (int32_t i = 0; i < count; ++i) {
+        if (costs[i] < best) {
+          best = costs[i];
+          best_frame = first + i;
+        }
+      }
+    }
+  }
+  *out_frame = best_frame;
+  *out_cost = best;
+}
+
+constexpr cozz_kernels_t make_kernels(const char* name,
+                                      size_t (*decode_gv4_stream)(const uint8_t*, size_t, uint32_t*, size_t),
+                                      int32_t (*skin)(const ozz_skinning_desc_t*)) {
+  return {name,
+          kernel_sampling,
+          kernel_blending,
+          kernel_local_to_model,
+          kernel_level_local_to_model,
+          kernel_ltm_joints,
+          kernel_store_palette,
+          decode_gv4_stream,
+          kernel_motion_search,
+          skin};
+}
+
+}  // namespace
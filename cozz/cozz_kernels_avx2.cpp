@@ -0,0 +1,331 @@
+
+#include "cozz_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+// Every standard header the ozz sources use is included before the target
+// switch, so the library code they instantiate is shared with the main build
+// and stays on the baseline instruction set.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+// Private copy of the ozz jobs (ozz_animation_jobs.inl): same sources, AVX2
+// math.
+#define ozz cozz_avx2_ozz
+#define OZZ_SIMD_AVX2
+#define OZZ_SIMD_FMA
+
+// Implicit constructors don't inherit the target below, and can't force-inline
+// the tier's math into baseline code, so the copy keeps inlining as a hint.
+#include "ozz/base/platform.h"
+#undef OZZ_INLINE
+#define OZZ_INLINE inline
+
+// The tier is selected with target attributes rather than -m flags: anything
+// compiled with -mavx2 outside of them, like static initializers or inline
+// functions the linker may pick over the baseline copy, would fault on older
+// cpus before dispatch gets a say.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma,f16c"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,f16c")
+#endif
+
+#include "../ozz/src_fused/ozz_animation_jobs.inl"
+#include "../ozz/src_fused/ozz_group_varint_ssse3.inl"
+
+// Group varint streams: whole groups with pshufb, whatever the build's flags,
+// and the last few with the main build's scalar decoder.
+static size_t decode_gv4_stream(const uint8_t* buffer, size_t size, uint32_t* values, size_t count) {
+  uint32_t* data = values;
+  const uint8_t* cursor = ozz::internal::DecodeGV4GroupsSSSE3(buffer, buffer + size, &data, values + count);
+  const size_t used = (size_t)(cursor - buffer);
+  return used + cozz_decode_gv4_stream(cursor, size - used, data, (size_t)(values + count - data));
+}
+
+// The only symbol the jobs reference from ozz_base, for iframe seeks.
+namespace ozz {
+span<const byte> DecodeGV4Stream(const span<const byte>& _buffer, const span<uint32_t>& _stream) {
+  const size_t used = decode_gv4_stream(_buffer.data(), _buffer.size(), _stream.data(), _stream.size());
+  return _buffer.subspan(used, _buffer.size() - used);
+}
+}  // namespace ozz
+
+#include "cozz_kernels.inl"
+
+// 8x8 transpose: in[k] holds row k, out[c] gets column c.
+static inline void transpose8x8(const __m256 in[8], __m256 out[8]) {
+  const __m256 t0 = _mm256_unpacklo_ps(in[0], in[1]);
+  const __m256 t1 = _mm256_unpackhi_ps(in[0], in[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(in[2], in[3]);
+  const __m256 t3 = _mm256_unpackhi_ps(in[2], in[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(in[4], in[5]);
+  const __m256 t5 = _mm256_unpackhi_ps(in[4], in[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(in[6], in[7]);
+  const __m256 t7 = _mm256_unpackhi_ps(in[6], in[7]);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  out[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  out[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  out[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  out[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  out[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  out[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  out[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  out[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// Deinterleaves 8 consecutive xyz vertices into x, y, z lanes.
+static inline void load_xyz8(const float* f32, const uint16_t* f16, int32_t v0, __m256* x, __m256* y, __m256* z) {
+  alignas(32) float tmp[24];
+  const float* src = f32 + v0 * 3;
+  if (f16) {
+    const __m128i* h = reinterpret_cast<const __m128i*>(f16 + v0 * 3);
+    _mm256_store_ps(tmp + 0, _mm256_cvtph_ps(_mm_loadu_si128(h + 0)));
+    _mm256_store_ps(tmp + 8, _mm256_cvtph_ps(_mm_loadu_si128(h + 1)));
+    _mm256_store_ps(tmp + 16, _mm256_cvtph_ps(_mm_loadu_si128(h + 2)));
+    src = tmp;
+  }
+  const __m256i stride3 = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  *x = _mm256_i32gather_ps(src + 0, stride3, 4);
+  *y = _mm256_i32gather_ps(src + 1, stride3, 4);
+  *z = _mm256_i32gather_ps(src + 2, stride3, 4);
+}
+
+static inline void store_xyz8(float* out, int32_t v0, __m256 x, __m256 y, __m256 z) {
+  alignas(32) float fx[8], fy[8], fz[8];
+  _mm256_store_ps(fx, x);
+  _mm256_store_ps(fy, y);
+  _mm256_store_ps(fz, z);
+  float* o = out + v0 * 3;
+  for (int k = 0; k < 8; ++k) {
+    o[k * 3 + 0] = fx[k];
+    o[k * 3 + 1] = fy[k];
+    o[k * 3 + 2] = fz[k];
+  }
+}
+
+// Blends one vertex' skinning matrix: 12 floats as an 8 + 4 split.
+template <typename JointT, typename WeightT>
+static inline void blend_matrix(const float* matrices, int32_t last, const JointT* joints, const WeightT* weights,
+                                float weight_scale, int32_t inf, __m256* lo, __m128* hi) {
+  __m256 acc_lo = _mm256_setzero_ps();
+  __m128 acc_hi = _mm_setzero_ps();
+  float weight_sum = 0.f;
+  for (int32_t i = 0; i < inf; ++i) {
+    float w;
+    if (i + 1 < inf) {
+      w = (float)weights[i] * weight_scale;
+      weight_sum += w;
+    } else {
+      w = 1.f - weight_sum;
+    }
+    const int32_t joint = (int32_t)joints[i] < last ? (int32_t)joints[i] : last;
+    const float* m = matrices + joint * 12;
+    acc_lo = _mm256_fmadd_ps(_mm256_loadu_ps(m), _mm256_set1_ps(w), acc_lo);
+    acc_hi = _mm_fmadd_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(w), acc_hi);
+  }
+  *lo = acc_lo;
+  *hi = acc_hi;
+}
+
+// Blends one vertex' dual quaternion (8 floats, real then dual). Influences
+// whose real part is in the other hemisphere than the first one's get their
+// weight negated, so blending takes the shortest path.
+template <typename JointT, typename WeightT>
+static inline __m256 blend_dual_quat(const float* dual_quats, int32_t last, const JointT* joints, const WeightT* weights,
+                                     float weight_scale, int32_t inf) {
+  const __m128 sign_mask = _mm_set1_ps(-0.f);
+  __m256 acc = _mm256_setzero_ps();
+  __m128 pivot = _mm_setzero_ps();
+  float weight_sum = 0.f;
+  for (int32_t i = 0; i < inf; ++i) {
+    float w;
+    if (i + 1 < inf) {
+      w = (float)weights[i] * weight_scale;
+      weight_sum += w;
+    } else {
+      w = 1.f - weight_sum;
+    }
+    const int32_t joint = (int32_t)joints[i] < last ? (int32_t)joints[i] : last;
+    const __m256 dq = _mm256_loadu_ps(dual_quats + joint * 8);
+    const __m128 real = _mm256_castps256_ps128(dq);
+    if (i == 0) pivot = real;
+    const __m128 flip = _mm_and_ps(_mm_dp_ps(real, pivot, 0xff), sign_mask);
+    const __m256 weight = _mm256_xor_ps(_mm256_set1_ps(w), _mm256_set_m128(flip, flip));
+    acc = _mm256_fmadd_ps(dq, weight, acc);
+  }
+  return acc;
+}
+
+static inline void cross8(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz,
+                          __m256* cx, __m256* cy, __m256* cz) {
+  *cx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+  *cy = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+  *cz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+}
+
+// v + 2 * r x (r x v + rw * v): rotation of v by the unit quaternion r.
+static inline void rotate8(const __m256 r[4], __m256* vx, __m256* vy, __m256* vz) {
+  __m256 cx, cy, cz;
+  cross8(r[0], r[1], r[2], *vx, *vy, *vz, &cx, &cy, &cz);
+  cx = _mm256_fmadd_ps(r[3], *vx, cx);
+  cy = _mm256_fmadd_ps(r[3], *vy, cy);
+  cz = _mm256_fmadd_ps(r[3], *vz, cz);
+  __m256 ux, uy, uz;
+  cross8(r[0], r[1], r[2], cx, cy, cz, &ux, &uy, &uz);
+  const __m256 two = _mm256_set1_ps(2.f);
+  *vx = _mm256_fmadd_ps(two, ux, *vx);
+  *vy = _mm256_fmadd_ps(two, uy, *vy);
+  *vz = _mm256_fmadd_ps(two, uz, *vz);
+}
+
+template <bool kDualQuat, typename JointT, typename WeightT>
+static int32_t skin_blocks(const ozz_skinning_desc_t* d, const JointT* joints, const WeightT* weights, float weight_scale) {
+  const int32_t blocks = d->vertex_count / 8;
+  const int32_t inf = d->influences;
+  const int32_t last = d->matrix_count - 1;
+  const bool normals = d->normals_f32 || d->normals_f16;
+
+  for (int32_t b = 0; b < blocks; ++b) {
+    const int32_t v0 = b * 8;
+
+    // Transforms are blended per vertex (AoS, in cache), then transposed so
+    // the rest runs on 8 vertices at once.
+    __m256 m[12];
+    if constexpr (kDualQuat) {
+      __m256 dq[8];
+      for (int32_t k = 0; k < 8; ++k) {
+        const int32_t v = v0 + k;
+        dq[k] = blend_dual_quat(d->dual_quats, last, joints + v * inf, weights + v * (inf - 1), weight_scale, inf);
+      }
+      // m[0..3] real xyzw, m[4..7] dual xyzw, normalized by the real norm.
+      transpose8x8(dq, m);
+      const __m256 norm2 = _mm256_fmadd_ps(m[0], m[0], _mm256_fmadd_ps(m[1], m[1], _mm256_fmadd_ps(m[2], m[2], _mm256_mul_ps(m[3], m[3]))));
+      const __m256 inv_norm = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(norm2));
+      for (int c = 0; c < 8; ++c) m[c] = _mm256_mul_ps(m[c], inv_norm);
+    } else {
+      __m256 lo[8];
+      __m128 hi[8];
+      for (int32_t k = 0; k < 8; ++k) {
+        const int32_t v = v0 + k;
+        blend_matrix(d->matrices_3x4, last, joints + v * inf, weights + v * (inf - 1), weight_scale, inf, &lo[k], &hi[k]);
+      }
+      // m[col * 3 + row]
+      transpose8x8(lo, m);
+      __m128 h0 = hi[0], h1 = hi[1], h2 = hi[2], h3 = hi[3];
+      __m128 h4 = hi[4], h5 = hi[5], h6 = hi[6], h7 = hi[7];
+      _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+      _MM_TRANSPOSE4_PS(h4, h5, h6, h7);
+      m[8] = _mm256_set_m128(h4, h0);
+      m[9] = _mm256_set_m128(h5, h1);
+      m[10] = _mm256_set_m128(h6, h2);
+      m[11] = _mm256_set_m128(h7, h3);
+    }
+
+    __m256 px, py, pz;
+    load_xyz8(d->positions_f32, d->positions_f16, v0, &px, &py, &pz);
+    if constexpr (kDualQuat) {
+      // Translation 2 * (rw * d - dw * r + r x d), d being the dual xyz.
+      __m256 tx, ty, tz;
+      cross8(m[0], m[1], m[2], m[4], m[5], m[6], &tx, &ty, &tz);
+      tx = _mm256_fnmadd_ps(m[7], m[0], _mm256_fmadd_ps(m[3], m[4], tx));
+      ty = _mm256_fnmadd_ps(m[7], m[1], _mm256_fmadd_ps(m[3], m[5], ty));
+      tz = _mm256_fnmadd_ps(m[7], m[2], _mm256_fmadd_ps(m[3], m[6], tz));
+      rotate8(m, &px, &py, &pz);
+      const __m256 two = _mm256_set1_ps(2.f);
+      store_xyz8(d->out_positions, v0, _mm256_fmadd_ps(two, tx, px), _mm256_fmadd_ps(two, ty, py), _mm256_fmadd_ps(two, tz, pz));
+    } else {
+      const __m256 ox = _mm256_fmadd_ps(m[0], px, _mm256_fmadd_ps(m[3], py, _mm256_fmadd_ps(m[6], pz, m[9])));
+      const __m256 oy = _mm256_fmadd_ps(m[1], px, _mm256_fmadd_ps(m[4], py, _mm256_fmadd_ps(m[7], pz, m[10])));
+      const __m256 oz = _mm256_fmadd_ps(m[2], px, _mm256_fmadd_ps(m[5], py, _mm256_fmadd_ps(m[8], pz, m[11])));
+      store_xyz8(d->out_positions, v0, ox, oy, oz);
+    }
+
+    if (normals) {
+      __m256 nx, ny, nz;
+      load_xyz8(d->normals_f32, d->normals_f16, v0, &nx, &ny, &nz);
+      if constexpr (kDualQuat) {
+        rotate8(m, &nx, &ny, &nz);
+        store_xyz8(d->out_normals, v0, nx, ny, nz);
+      } else {
+        const __m256 tx = _mm256_fmadd_ps(m[0], nx, _mm256_fmadd_ps(m[3], ny, _mm256_mul_ps(m[6], nz)));
+        const __m256 ty = _mm256_fmadd_ps(m[1], nx, _mm256_fmadd_ps(m[4], ny, _mm256_mul_ps(m[7], nz)));
+        const __m256 tz = _mm256_fmadd_ps(m[2], nx, _mm256_fmadd_ps(m[5], ny, _mm256_mul_ps(m[8], nz)));
+        store_xyz8(d->out_normals, v0, tx, ty, tz);
+      }
+    }
+  }
+  return blocks * 8;
+}
+
+template <bool kDualQuat>
+static int32_t skin_layout(const ozz_skinning_desc_t* d) {
+  // weights are unused with a single influence, any non-null pointer does.
+  static const float kNoWeights[1] = {0.f};
+  if (d->weights_unorm8) {
+    return d->joints_u8 ? skin_blocks<kDualQuat>(d, d->joints_u8, d->weights_unorm8, 1.f / 255.f)
+                        : skin_blocks<kDualQuat>(d, d->joints_u16, d->weights_unorm8, 1.f / 255.f);
+  }
+  const float* weights = d->weights_f32 ? d->weights_f32 : kNoWeights;
+  return d->joints_u8 ? skin_blocks<kDualQuat>(d, d->joints_u8, weights, 1.f)
+                      : skin_blocks<kDualQuat>(d, d->joints_u16, weights, 1.f);
+}
+
+static int32_t skin(const ozz_skinning_desc_t* d) {
+  return d->dual_quats ? skin_layout<true>(d) : skin_layout<false>(d);
+}
+
+static constexpr cozz_kernels_t kAvx2Kernels = make_kernels("avx2", decode_gv4_stream, skin);
+
+#undef ozz
+#undef OZZ_SIMD_AVX2
+#undef OZZ_SIMD_FMA
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+const cozz_kernels_t* cozz_kernels_avx2() { return &kAvx2Kernels; }
+
+#else
+
+const cozz_kernels_t* cozz_kernels_avx2() { return nullptr; }
+
+#endif
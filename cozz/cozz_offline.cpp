@@ -0,0 +1,532 @@
+
+#include "cozz_offline.h"
+#include "cozz_alloc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace offline = ozz::animation::offline;
+
+static thread_local std::string g_last_error;
+
+static ozz_result_t set_err(ozz_result_t code, const char* msg) {
+  g_last_error = msg ? msg : "";
+  return code;
+}
+const char* ozz_offline_last_error(void) { return g_last_error.c_str(); }
+void ozz_offline_clear_error(void) { g_last_error.clear(); }
+
+template <typename T>
+static ozz_result_t load_ozz_object_from_file(const char* path, T* out_obj) {
+  if (!path || !out_obj) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "rb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::IArchive ar(&file);
+  if (!ar.TestTag<T>()) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> *out_obj;
+  return OZZ_OK;
+}
+
+template <typename T>
+static ozz_result_t save_ozz_object_to_file(const char* path, const T& obj) {
+  if (!path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "wb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::OArchive ar(&file);
+  ar << obj;
+  return OZZ_OK;
+}
+
+// Glob match supporting '*' (any run) and '?' (any single char).
+static bool name_matches(const char* pattern, const char* name) {
+  const char* star = nullptr;
+  const char* resume = nullptr;
+  while (*name) {
+    if (*pattern == '*') {
+      star = pattern++;
+      resume = name;
+    } else if (*pattern == '?' || *pattern == *name) {
+      ++pattern;
+      ++name;
+    } else if (star) {
+      pattern = star + 1;
+      name = ++resume;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '*') ++pattern;
+  return *pattern == '\0';
+}
+
+// Reads one joint lane out of a SoA pose, same layout as GetJointLocalRestPose.
+static ozz::math::Transform soa_joint_transform(const ozz::math::SoaTransform* pose, int32_t joint) {
+  const float* f = reinterpret_cast<const float*>(pose + (joint >> 2)) + (joint & 3);
+  ozz::math::Transform t;
+  t.translation = ozz::math::Float3(f[0], f[4], f[8]);
+  t.rotation = ozz::math::Quaternion(f[12], f[16], f[20], f[24]);
+  t.scale = ozz::math::Float3(f[28], f[32], f[36]);
+  return t;
+}
+static_assert(sizeof(ozz::math::SoaTransform) == 40 * sizeof(float), "SoaTransform is expected to be 10 packed SimdFloat4");
+
+// Inverse of soa_joint_transform over a whole pose; padding lanes stay identity.
+static void soa_pose_from_transforms(const ozz::vector<ozz::math::Transform>& in,
+                                     ozz::vector<ozz::math::SoaTransform>* out) {
+  std::fill(out->begin(), out->end(), ozz::math::SoaTransform::identity());
+  for (size_t joint = 0; joint < in.size(); ++joint) {
+    float* f = reinterpret_cast<float*>(out->data() + (joint >> 2)) + (joint & 3);
+    const ozz::math::Transform& t = in[joint];
+    f[0] = t.translation.x; f[4] = t.translation.y; f[8] = t.translation.z;
+    f[12] = t.rotation.x; f[16] = t.rotation.y; f[20] = t.rotation.z; f[24] = t.rotation.w;
+    f[28] = t.scale.x; f[32] = t.scale.y; f[36] = t.scale.z;
+  }
+}
+
+// Resamples a runtime clip at its timepoints into raw, track j coming from
+// clip track tracks[j] (track j itself when tracks is null). Every track holds
+// its exact key values at the clip timepoints, so resampling there
+// reproduces the runtime clip.
+static ozz_result_t raw_from_clip(const ozz::animation::Animation& anim, const int32_t* tracks, int32_t num_tracks,
+                                  offline::RawAnimation* raw) {
+  raw->duration = anim.duration();
+  raw->name = anim.name();
+  raw->tracks.resize((size_t)num_tracks);
+
+  ozz::animation::SamplingJob::Context ctx(anim.num_tracks());
+  ozz::vector<ozz::math::SoaTransform> locals((size_t)anim.num_soa_tracks());
+  for (const float ratio : anim.timepoints()) {
+    ozz::animation::SamplingJob job;
+    job.animation = &anim;
+    job.context = &ctx;
+    job.ratio = ratio;
+    job.output = ozz::make_span(locals);
+    if (!job.Run()) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+
+    const float time = ratio * raw->duration;
+    for (int32_t j = 0; j < num_tracks; ++j) {
+      const ozz::math::Transform t = soa_joint_transform(locals.data(), tracks ? tracks[j] : j);
+      offline::RawAnimation::JointTrack& track = raw->tracks[(size_t)j];
+      track.translations.push_back({time, t.translation});
+      track.rotations.push_back({time, t.rotation});
+      track.scales.push_back({time, t.scale});
+    }
+  }
+  return OZZ_OK;
+}
+
+// ---- Skeleton LOD ----
+
+static offline::RawSkeleton::Joint lod_raw_joint(const ozz::animation::Skeleton& skel,
+                                                 const ozz::vector<uint8_t>& keep,
+                                                 const ozz::vector<ozz::vector<int32_t>>& children,
+                                                 int32_t joint) {
+  offline::RawSkeleton::Joint out;
+  out.name = skel.joint_names()[(size_t)joint];
+  out.transform = ozz::animation::GetJointLocalRestPose(skel, joint);
+  for (const int32_t child : children[(size_t)joint]) {
+    if (keep[(size_t)child]) out.children.push_back(lod_raw_joint(skel, keep, children, child));
+  }
+  return out;
+}
+
+ozz_result_t ozz_offline_build_skeleton_lod(const char* skeleton_path, const ozz_skeleton_lod_desc_t* desc,
+                                            const char* out_skeleton_path,
+                                            int32_t* out_lod_to_full, int32_t lod_capacity,
+                                            int32_t* out_full_to_lod, int32_t full_capacity,
+                                            int32_t* out_num_joints) {
+  ozz_offline_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_OFFLINE);
+  if (!desc || !out_skeleton_path || !out_lod_to_full || !out_num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (desc->drop_pattern_count > 0 && !desc->drop_patterns) return set_err(OZZ_ERR_INVALID_ARGUMENT, "drop_patterns null");
+
+  ozz::animation::Skeleton full;
+  ozz_result_t r = load_ozz_object_from_file(skeleton_path, &full);
+  if (r != OZZ_OK) return r;
+
+  const int32_t num_joints = (int32_t)full.num_joints();
+  if (out_full_to_lod && full_capacity < num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "full_to_lod smaller than skeleton joint count");
+
+  // Parents come first in ozz's depth-first order, so a single forward pass
+  // propagates depth and drops.
+  const auto parents = full.joint_parents();
+  const auto names = full.joint_names();
+  ozz::vector<uint8_t> keep((size_t)num_joints, 0);
+  ozz::vector<int32_t> depth((size_t)num_joints, 0);
+  ozz::vector<ozz::vector<int32_t>> children((size_t)num_joints);
+  for (int32_t j = 0; j < num_joints; ++j) {
+    const int32_t parent = parents[(size_t)j];
+    if (parent == ozz::animation::Skeleton::kNoParent) {
+      keep[(size_t)j] = 1;
+      continue;
+    }
+    children[(size_t)parent].push_back(j);
+    depth[(size_t)j] = depth[(size_t)parent] + 1;
+
+    bool dropped = !keep[(size_t)parent] || (desc->max_depth >= 0 && depth[(size_t)j] > desc->max_depth);
+    for (int32_t p = 0; !dropped && p < desc->drop_pattern_count; ++p) {
+      const char* pattern = desc->drop_patterns[p];
+      dropped = pattern && name_matches(pattern, names[(size_t)j]);
+    }
+    keep[(size_t)j] = dropped ? 0 : 1;
+  }
+
+  offline::RawSkeleton raw;
+  for (int32_t j = 0; j < num_joints; ++j) {
+    if (parents[(size_t)j] == ozz::animation::Skeleton::kNoParent) {
+      raw.roots.push_back(lod_raw_joint(full, keep, children, j));
+    }
+  }
+
+  offline::SkeletonBuilder builder;
+  ozz::unique_ptr<ozz::animation::Skeleton> lod = builder(raw);
+  if (!lod) return set_err(OZZ_ERR_OZZ, "SkeletonBuilder failed");
+
+  const int32_t lod_joints = (int32_t)lod->num_joints();
+  if (lod_capacity < lod_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "lod_to_full smaller than LOD joint count");
+
+  // Joint names are unique in the source, so they identify joints across both skeletons.
+  for (int32_t j = 0; j < lod_joints; ++j) {
+    out_lod_to_full[j] = (int32_t)ozz::animation::FindJoint(full, lod->joint_names()[(size_t)j]);
+  }
+  if (out_full_to_lod) {
+    for (int32_t j = 0; j < num_joints; ++j) {
+      out_full_to_lod[j] = keep[(size_t)j]
+          ? (int32_t)ozz::animation::FindJoint(*lod, names[(size_t)j])
+          : out_full_to_lod[parents[(size_t)j]];
+    }
+  }
+
+  r = save_ozz_object_to_file(out_skeleton_path, *lod);
+  if (r != OZZ_OK) return r;
+  *out_num_joints = lod_joints;
+  return OZZ_OK;
+}
+
+// ---- LOD clips ----
+
+ozz_result_t ozz_offline_build_lod_animation(const char* lod_skeleton_path, const char* animation_path,
+                                             const int32_t* lod_to_full, int32_t num_lod_joints,
+                                             float tolerance, const char* out_animation_path) {
+  ozz_offline_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_OFFLINE);
+  if (!lod_to_full || !out_animation_path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+
+  ozz::animation::Skeleton lod;
+  ozz_result_t r = load_ozz_object_from_file(lod_skeleton_path, &lod);
+  if (r != OZZ_OK) return r;
+  if (num_lod_joints != (int32_t)lod.num_joints()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "lod_to_full does not match LOD joint count");
+
+  ozz::animation::Animation anim;
+  r = load_ozz_object_from_file(animation_path, &anim);
+  if (r != OZZ_OK) return r;
+  for (int32_t j = 0; j < num_lod_joints; ++j) {
+    if (lod_to_full[j] < 0 || lod_to_full[j] >= anim.num_tracks()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "lod_to_full entry out of clip track range");
+  }
+
+  offline::RawAnimation raw;
+  r = raw_from_clip(anim, lod_to_full, num_lod_joints, &raw);
+  if (r != OZZ_OK) return r;
+
+  if (tolerance > 0.f) {
+    offline::AnimationOptimizer optimizer;
+    optimizer.setting.tolerance = tolerance;
+    offline::RawAnimation optimized;
+    if (!optimizer(raw, lod, &optimized)) return set_err(OZZ_ERR_OZZ, "AnimationOptimizer failed");
+    raw = std::move(optimized);
+  }
+
+  offline::AnimationBuilder builder;
+  ozz::unique_ptr<ozz::animation::Animation> out = builder(raw);
+  if (!out) return set_err(OZZ_ERR_OZZ, "AnimationBuilder failed");
+  return save_ozz_object_to_file(out_animation_path, *out);
+}
+
+// ---- Baked model-space clips ----
+
+ozz_result_t ozz_offline_bake_model_clip(const char* skeleton_path, const char* animation_path, float frame_rate,
+                                         const char* out_path) {
+  ozz_offline_clear_error();
+  if (!skeleton_path || !animation_path || !out_path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+
+  // Baking only needs runtime jobs: the runtime API does the work and
+  // reports through its own error, copied over here.
+  ozz_skeleton_t* skel = nullptr;
+  ozz_animation_t* anim = nullptr;
+  ozz_baked_clip_t* clip = nullptr;
+  ozz_result_t r = ozz_skeleton_load_from_file(skeleton_path, &skel);
+  if (r == OZZ_OK) r = ozz_animation_load_from_file(animation_path, &anim);
+  if (r == OZZ_OK) r = ozz_baked_clip_create(skel, anim, frame_rate, &clip);
+  if (r == OZZ_OK) r = ozz_baked_clip_save_to_file(clip, out_path);
+  if (r != OZZ_OK) set_err(r, ozz_last_error());
+  ozz_baked_clip_destroy(clip);
+  ozz_animation_destroy(anim);
+  ozz_skeleton_destroy(skel);
+  return r;
+}
+
+ozz_result_t ozz_offline_pack_library(const char* const* animation_paths, int32_t animation_count,
+                                      const char* out_path) {
+  ozz_offline_clear_error();
+  if (!animation_paths || animation_count <= 0 || !out_path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "invalid args");
+
+  // Same as baking, runtime API end to end.
+  ozz::vector<ozz_animation_t*> clips((size_t)animation_count, nullptr);
+  ozz_library_t* lib = nullptr;
+  ozz_result_t r = OZZ_OK;
+  for (int32_t i = 0; i < animation_count && r == OZZ_OK; ++i) {
+    r = ozz_animation_load_from_file(animation_paths[i], &clips[(size_t)i]);
+  }
+  if (r == OZZ_OK) r = ozz_library_create(clips.data(), animation_count, &lib);
+  if (r == OZZ_OK) r = ozz_library_save_to_file(lib, out_path);
+  if (r != OZZ_OK) set_err(r, ozz_last_error());
+  ozz_library_destroy(lib);
+  for (ozz_animation_t* clip : clips) ozz_animation_destroy(clip);
+  return r;
+}
+
+// ---- Compression benchmark ----
+
+// Raw archives load as is, runtime clips are resampled at their keys.
+static ozz_result_t load_raw_clip(const char* path, offline::RawAnimation* out_raw) {
+  if (!path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null animation path");
+  ozz::io::File file(path, "rb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::IArchive ar(&file);
+  if (ar.TestTag<offline::RawAnimation>()) {
+    ar >> *out_raw;
+    return OZZ_OK;
+  }
+  if (!ar.TestTag<ozz::animation::Animation>()) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ozz::animation::Animation anim;
+  ar >> anim;
+  return raw_from_clip(anim, nullptr, anim.num_tracks(), out_raw);
+}
+
+struct error_stats_t {
+  float max;
+  float mean;
+  float p95;
+  float p99;
+};
+
+// Reorders values.
+static error_stats_t error_stats(float* values, size_t count) {
+  error_stats_t stats = {0.f, 0.f, 0.f, 0.f};
+  if (count == 0) return stats;
+  double sum = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    sum += values[i];
+    stats.max = std::max(stats.max, values[i]);
+  }
+  stats.mean = (float)(sum / (double)count);
+  auto percentile = [&](float p) {
+    float* nth = values + (size_t)std::lround(p * (float)(count - 1));
+    std::nth_element(values, nth, values + count);
+    return *nth;
+  };
+  stats.p95 = percentile(.95f);
+  stats.p99 = percentile(.99f);
+  return stats;
+}
+
+// Quoted when it holds a separator, a quote or a line break.
+static void append_csv_field(std::string* csv, const char* field) {
+  if (!std::strpbrk(field, ",\"\r\n")) {
+    *csv += field;
+    return;
+  }
+  *csv += '"';
+  for (const char* c = field; *c; ++c) {
+    if (*c == '"') *csv += '"';
+    *csv += *c;
+  }
+  *csv += '"';
+}
+
+static void append_csv_row(std::string* csv, const char* animation, const ozz_compression_setting_t& setting,
+                           const ozz_compression_summary_t& summary, int32_t joint, const char* joint_name,
+                           const error_stats_t& stats) {
+  append_csv_field(csv, animation);
+  char buf[384];
+  std::snprintf(buf, sizeof(buf), ",%g,%g,%g,%zu,%zu,%.3f,%.1f,%.1f,%.1f,%d,", setting.tolerance, setting.distance,
+                setting.iframe_interval, summary.raw_bytes, summary.compressed_bytes, summary.build_ms,
+                summary.sample_ns, summary.sample_reverse_ns, summary.sample_scan_ns, joint);
+  *csv += buf;
+  append_csv_field(csv, joint_name);
+  std::snprintf(buf, sizeof(buf), ",%.6g,%.6g,%.6g,%.6g\n", stats.max, stats.mean, stats.p95, stats.p99);
+  *csv += buf;
+}
+
+ozz_result_t ozz_offline_compression_benchmark(const ozz_compression_bench_desc_t* desc, const char* out_csv_path,
+                                               ozz_compression_summary_t* out_summaries, int32_t summary_capacity) {
+  ozz_offline_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_OFFLINE);
+  if (!desc || !out_csv_path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (desc->animation_count < 0 || desc->setting_count < 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "negative count");
+  if ((desc->animation_count > 0 && !desc->animation_paths) || (desc->setting_count > 0 && !desc->settings)) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "null animation_paths/settings");
+  }
+  if (out_summaries && summary_capacity < desc->animation_count * desc->setting_count) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "summaries smaller than animation_count * setting_count");
+  }
+  const float sample_rate = desc->sample_rate > 0.f ? desc->sample_rate : 60.f;
+  const int32_t timing_passes = desc->timing_passes > 0 ? desc->timing_passes : 8;
+
+  ozz::animation::Skeleton skel;
+  ozz_result_t r = load_ozz_object_from_file(desc->skeleton_path, &skel);
+  if (r != OZZ_OK) return r;
+  const int32_t num_joints = (int32_t)skel.num_joints();
+  const auto names = skel.joint_names();
+
+  ozz::vector<ozz::math::Transform> raw_locals((size_t)num_joints);
+  ozz::vector<ozz::math::SoaTransform> locals((size_t)skel.num_soa_joints());
+  ozz::vector<ozz::math::Float4x4> models((size_t)num_joints);
+  ozz::animation::SamplingJob::Context ctx(num_joints);
+  auto local_to_model = [&]() {
+    ozz::animation::LocalToModelJob job;
+    job.skeleton = &skel;
+    job.input = ozz::make_span(locals);
+    job.output = ozz::make_span(models);
+    return job.Run();
+  };
+
+  std::string csv =
+      "animation,tolerance,distance,iframe_interval,raw_bytes,compressed_bytes,build_ms,sample_ns,"
+      "sample_reverse_ns,sample_scan_ns,joint,joint_name,error_max,error_mean,error_p95,error_p99\n";
+  for (int32_t a = 0; a < desc->animation_count; ++a) {
+    offline::RawAnimation raw;
+    r = load_raw_clip(desc->animation_paths[a], &raw);
+    if (r != OZZ_OK) return r;
+    if (raw.num_tracks() != num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "clip track count does not match skeleton");
+    if (!raw.Validate()) return set_err(OZZ_ERR_OZZ, "invalid raw animation");
+
+    // Reference joint positions at every sample time, sample major.
+    const size_t num_samples = std::max<size_t>(2, (size_t)std::ceil(raw.duration * sample_rate) + 1);
+    ozz::vector<float> reference(num_samples * (size_t)num_joints * 3u);
+    for (size_t i = 0; i < num_samples; ++i) {
+      const float time = raw.duration * (float)i / (float)(num_samples - 1);
+      if (!offline::SampleAnimation(raw, time, ozz::make_span(raw_locals))) return set_err(OZZ_ERR_OZZ, "raw sampling failed");
+      soa_pose_from_transforms(raw_locals, &locals);
+      if (!local_to_model()) return set_err(OZZ_ERR_OZZ, "LocalToModelJob failed");
+      for (int32_t j = 0; j < num_joints; ++j) {
+        ozz::math::Store3PtrU(models[(size_t)j].cols[3], &reference[(i * (size_t)num_joints + (size_t)j) * 3u]);
+      }
+    }
+
+    for (int32_t s = 0; s < desc->setting_count; ++s) {
+      const ozz_compression_setting_t& setting = desc->settings[s];
+      ozz_compression_summary_t summary = {};
+      summary.animation = a;
+      summary.setting = s;
+      summary.raw_bytes = raw.size();
+
+      const auto build_start = std::chrono::steady_clock::now();
+      offline::RawAnimation optimized;
+      const offline::RawAnimation* source = &raw;
+      if (setting.tolerance > 0.f) {
+        offline::AnimationOptimizer optimizer;
+        optimizer.setting = offline::AnimationOptimizer::Setting(setting.tolerance, setting.distance);
+        if (!optimizer(raw, skel, &optimized)) return set_err(OZZ_ERR_OZZ, "AnimationOptimizer failed");
+        source = &optimized;
+      }
+      offline::AnimationBuilder builder;
+      builder.iframe_interval = setting.iframe_interval;
+      ozz::unique_ptr<ozz::animation::Animation> anim = builder(*source);
+      if (!anim) return set_err(OZZ_ERR_OZZ, "AnimationBuilder failed");
+      summary.build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+      summary.compressed_bytes = anim->size();
+
+      // A new clip may reuse the previous one's address.
+      ctx.Invalidate();
+      ozz::animation::SamplingJob job;
+      job.animation = anim.get();
+      job.context = &ctx;
+      job.output = ozz::make_span(locals);
+
+      // Joint major, so each joint's errors are contiguous.
+      ozz::vector<float> errors(num_samples * (size_t)num_joints);
+      for (size_t i = 0; i < num_samples; ++i) {
+        job.ratio = (float)i / (float)(num_samples - 1);
+        if (!job.Run()) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+        if (!local_to_model()) return set_err(OZZ_ERR_OZZ, "LocalToModelJob failed");
+        for (int32_t j = 0; j < num_joints; ++j) {
+          const float* ref = &reference[(i * (size_t)num_joints + (size_t)j) * 3u];
+          const ozz::math::SimdFloat4 d =
+              models[(size_t)j].cols[3] - ozz::math::simd_float4::Load(ref[0], ref[1], ref[2], 1.f);
+          errors[(size_t)j * num_samples + i] = ozz::math::GetX(ozz::math::Length3(d));
+        }
+      }
+
+      auto time_playback = [&](bool reverse, double* ns) {
+        const auto sample_start = std::chrono::steady_clock::now();
+        for (int32_t pass = 0; pass < timing_passes; ++pass) {
+          for (size_t i = 0; i < num_samples; ++i) {
+            const size_t sample = reverse ? num_samples - 1 - i : i;
+            job.ratio = (float)sample / (float)(num_samples - 1);
+            if (!job.Run()) return false;
+          }
+        }
+        *ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - sample_start).count() /
+              (double)((size_t)timing_passes * num_samples);
+        return true;
+      };
+      if (!time_playback(false, &summary.sample_ns)) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+      if (!time_playback(true, &summary.sample_reverse_ns)) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+      // Same playback with keys mapped back to tracks by scanning the cache.
+      anim->DropTrackIndex();
+      ctx.Invalidate();
+      if (!time_playback(false, &summary.sample_scan_ns)) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+
+      float worst = -1.f;
+      for (int32_t j = 0; j < num_joints; ++j) {
+        float* joint_errors = &errors[(size_t)j * num_samples];
+        const float joint_max = *std::max_element(joint_errors, joint_errors + num_samples);
+        if (joint_max > worst) {
+          worst = joint_max;
+          summary.worst_joint = j;
+        }
+        append_csv_row(&csv, desc->animation_paths[a], setting, summary, j, names[(size_t)j],
+                       error_stats(joint_errors, num_samples));
+      }
+      const error_stats_t all = error_stats(errors.data(), errors.size());
+      summary.error_max = all.max;
+      summary.error_mean = all.mean;
+      summary.error_p95 = all.p95;
+      summary.error_p99 = all.p99;
+      append_csv_row(&csv, desc->animation_paths[a], setting, summary, -1, "", all);
+      if (out_summaries) out_summaries[a * desc->setting_count + s] = summary;
+    }
+  }
+
+  ozz::io::File file(out_csv_path, "wb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  if (file.Write(csv.data(), csv.size()) != csv.size()) return set_err(OZZ_ERR_IO, "write failed");
+  return OZZ_OK;
+}
@@ -0,0 +1,102 @@
+
+#pragma once
+
+#include "cozz_runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Offline tools report errors through their own thread-local message.
+const char* ozz_offline_last_error(void);
+void ozz_offline_clear_error(void);
+
+// Skeleton LOD
+// A joint is dropped, with its whole subtree, when its name matches one of
+// drop_patterns ('*' and '?' wildcards) or when it is deeper than max_depth.
+// Roots are always kept.
+typedef struct ozz_skeleton_lod_desc_t {
+  const char* const* drop_patterns;
+  int32_t drop_pattern_count;
+  int32_t max_depth; // roots are at depth 0, < 0 keeps every depth
+} ozz_skeleton_lod_desc_t;
+
+// Writes the reduced skeleton to out_skeleton_path.
+// out_lod_to_full[lod_joint] = full joint: usable as target_to_source with
+// ozz_retarget_create_with_map, and as the track table of LOD clips.
+// out_full_to_lod[full_joint] = LOD joint, or the closest kept ancestor for
+// dropped joints (remaps skinning indices). Optional.
+ozz_result_t ozz_offline_build_skeleton_lod(const char* skeleton_path, const ozz_skeleton_lod_desc_t* desc,
+                                            const char* out_skeleton_path,
+                                            int32_t* out_lod_to_full, int32_t lod_capacity,
+                                            int32_t* out_full_to_lod, int32_t full_capacity,
+                                            int32_t* out_num_joints);
+
+// Rewrites a full skeleton clip with one track per LOD joint. Keys are
+// resampled at every clip timepoint, then reduced with ozz's AnimationOptimizer
+// against the LOD skeleton when tolerance > 0 (meters). With tolerance 0 each
+// track keeps a key per timepoint, which can outgrow the source clip.
+ozz_result_t ozz_offline_build_lod_animation(const char* lod_skeleton_path, const char* animation_path,
+                                             const int32_t* lod_to_full, int32_t num_lod_joints,
+                                             float tolerance, const char* out_animation_path);
+
+// Bakes the clip at animation_path on its skeleton into a model-space clip
+// (see ozz_baked_clip_create) written for ozz_baked_clip_load_from_file.
+ozz_result_t ozz_offline_bake_model_clip(const char* skeleton_path, const char* animation_path, float frame_rate,
+                                         const char* out_path);
+
+// Packs the clips at animation_paths, in that order, into an animation library
+// (see ozz_library_create) written for ozz_library_load_from_file.
+ozz_result_t ozz_offline_pack_library(const char* const* animation_paths, int32_t animation_count,
+                                      const char* out_path);
+
+// Compression benchmark
+// Builds every clip of a corpus at each setting (AnimationOptimizer, then
+// AnimationBuilder) and measures the result against the source clip: size,
+// build time, playback sampling time, and model-space joint position error
+// through LocalToModelJob.
+typedef struct ozz_compression_setting_t {
+  float tolerance;        // AnimationOptimizer tolerance (meters), <= 0 skips the optimizer
+  float distance;         // AnimationOptimizer distance (meters)
+  float iframe_interval;  // AnimationBuilder iframe interval (seconds), 0 for none
+} ozz_compression_setting_t;
+
+typedef struct ozz_compression_bench_desc_t {
+  const char* skeleton_path;
+  // RawAnimation archives, or runtime clips resampled at their keys (errors
+  // are then relative to the already compressed clip).
+  const char* const* animation_paths;
+  int32_t animation_count;
+  const ozz_compression_setting_t* settings;
+  int32_t setting_count;
+  float sample_rate;      // error and timing samples per second of clip, 0 means 60
+  int32_t timing_passes;  // timed playbacks of each built clip, 0 means 8
+} ozz_compression_bench_desc_t;
+
+typedef struct ozz_compression_summary_t {
+  int32_t animation;        // index into animation_paths
+  int32_t setting;          // index into settings
+  size_t raw_bytes;         // RawAnimation::size()
+  size_t compressed_bytes;  // Animation::size()
+  double build_ms;          // optimizer + builder
+  double sample_ns;         // per SamplingJob, playing the clip forward
+  double sample_reverse_ns; // same, playing the clip backward
+  double sample_scan_ns;    // forward, without the key-to-track index
+  // Joint position error (meters) over every joint and sample.
+  float error_max;
+  float error_mean;
+  float error_p95;
+  float error_p99;
+  int32_t worst_joint;
+} ozz_compression_summary_t;
+
+// Writes a CSV (header line first) with one row per clip, setting and joint,
+// plus a joint -1 row per clip and setting over all joints. out_summaries,
+// when set, gets those joint -1 rows: animation_count * setting_count of them,
+// clip major.
+ozz_result_t ozz_offline_compression_benchmark(const ozz_compression_bench_desc_t* desc, const char* out_csv_path,
+                                               ozz_compression_summary_t* out_summaries, int32_t summary_capacity);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
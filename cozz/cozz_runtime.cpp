@@ -1,11 +1,18 @@
 
 #include "cozz_runtime.h"
+#include "cozz_alloc.h"
+#include "cozz_kernels.h"
 
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <limits>
 #include <new>
 #include <cstring>
 #include <cstdint>
+#include <cstdlib>
 #include <mutex>
 #include <vector>
 
@@ -17,17 +24,27 @@
 #include "ozz/animation/runtime/ik_two_bone_job.h"
 #include "ozz/animation/runtime/ik_aim_job.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/geometry/runtime/skinning_job.h"
 
+#include "ozz/base/containers/unordered_map.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/encode/group_varint.h"
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/span.h"
 #include "ozz/base/maths/vec_float.h"
 
+#include "cozz_kernels.inl"
+
 static thread_local std::string g_last_error;
 
 static inline bool vec3_is_near_zero(ozz_vec3_t v) {
@@ -41,9 +58,93 @@ static ozz_result_t set_err(ozz_result_t code, const char* msg) {
 const char* ozz_last_error(void) { return g_last_error.c_str(); }
 void ozz_clear_error(void) { g_last_error.clear(); }
 
+// ---- kernel tiers ----
+static bool cpu_has_avx2_fma_f16c() {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                                __builtin_cpu_supports("f16c");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+const cozz_kernels_t* cozz_kernels_baseline() {
+  // Group varint streams take the ozz decoder, SIMD in SSSE3 builds only.
+  static constexpr cozz_kernels_t kBaselineKernels = make_kernels("baseline", cozz_decode_gv4_stream, nullptr);
+  return &kBaselineKernels;
+}
+
+size_t cozz_decode_gv4_stream(const uint8_t* buffer, size_t size, uint32_t* values, size_t count) {
+  const ozz::span<const ozz::byte> left = ozz::DecodeGV4Stream(ozz::span<const ozz::byte>(buffer, size), ozz::span<uint32_t>(values, count));
+  return (size_t)(left.data() - buffer);
+}
+
+static const cozz_kernels_t* best_kernels() {
+  const cozz_kernels_t* avx2 = cozz_kernels_avx2();
+  return avx2 && cpu_has_avx2_fma_f16c() ? avx2 : cozz_kernels_baseline();
+}
+
+static std::atomic<const cozz_kernels_t*> g_kernels{nullptr};
+
+// Picked on first use, unless ozz_set_kernel_tier got there first.
+static inline const cozz_kernels_t* kernels() {
+  const cozz_kernels_t* k = g_kernels.load(std::memory_order_acquire);
+  if (k) return k;
+  const cozz_kernels_t* best = best_kernels();
+  return g_kernels.compare_exchange_strong(k, best, std::memory_order_acq_rel) ? best : k;
+}
+
+const char* ozz_kernel_tier(void) { return kernels()->name; }
+
+ozz_result_t ozz_set_kernel_tier(const char* name) {
+  ozz_clear_error();
+  const cozz_kernels_t* k = best_kernels();
+  if (name) {
+    if (std::strcmp(name, "baseline") == 0) {
+      k = cozz_kernels_baseline();
+    } else if (std::strcmp(name, "avx2") == 0 && cozz_kernels_avx2()) {
+      if (!cpu_has_avx2_fma_f16c()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "cpu lacks avx2/fma/f16c");
+      k = cozz_kernels_avx2();
+    } else {
+      return set_err(OZZ_ERR_INVALID_ARGUMENT, "unknown kernel tier");
+    }
+  }
+  g_kernels.store(k, std::memory_order_release);
+  return OZZ_OK;
+}
+
+// ---- SoA lane addressing ----
+static constexpr int32_t kSoaTransformFloats = (int32_t)(sizeof(ozz::math::SoaTransform) / sizeof(float));
+static_assert(kSoaTransformFloats == 40, "SoaTransform is expected to be 10 packed SimdFloat4");
+
+// Float offset of a joint lane inside a SoaTransform array: soa * 40 + lane.
+// Component c of that lane then lives at offset + c * 4.
+static inline int32_t soa_lane_offset(int32_t joint) {
+  return (joint >> 2) * kSoaTransformFloats + (joint & 3);
+}
+
+// Joints regrouped by hierarchy depth, 4 per SoA group. Lanes of a group never
+// depend on each other, so a group can be multiplied by its gathered parents
+// in one go. The last group of a level is padded by repeating its first joint.
+struct ozz_ltm_levels_t {
+  int32_t num_groups = 0;
+  ozz::vector<int32_t> joints;        // [num_groups * 4]
+  ozz::vector<int32_t> parents;       // [num_groups * 4], kNoParent for roots
+  ozz::vector<int32_t> local_offsets; // [num_groups * 4], soa_lane_offset of joints
+  ozz::vector<uint8_t> lanes;         // [num_groups], valid lanes
+};
+
 // ---- Opaque handles ----
-struct ozz_skeleton_t { ozz::animation::Skeleton skel; };
-struct ozz_animation_t { ozz::animation::Animation anim; };
+struct ozz_skeleton_t {
+  ozz::animation::Skeleton skel;
+  ozz_ltm_levels_t levels; // built at load
+};
+static std::atomic<uint64_t> g_next_animation_id{1};
+struct ozz_animation_t {
+  ozz::animation::Animation anim;
+  uint64_t id = g_next_animation_id.fetch_add(1, std::memory_order_relaxed); // keys shared segments, never reused
+};
 
 // ---- bump-alloc into caller memory ----
 static inline uintptr_t align_up_uintptr(uintptr_t p, size_t a) {
@@ -77,16 +178,6 @@ static inline void* bump_alloc_bytes(void*& cursor, size_t& left, size_t bytes,
 static inline int32_t num_soa_from_joints(int32_t n) { return (n + 3) / 4; }
 
 namespace {
-struct SamplingContextInterpSoaFloat3 {
-  ozz::math::SimdFloat4 ratio[2];
-  ozz::math::SoaFloat3 value[2];
-};
-
-struct SamplingContextInterpSoaQuaternion {
-  ozz::math::SimdFloat4 ratio[2];
-  ozz::math::SoaQuaternion value[2];
-};
-
 class CallbackAllocator final : public ozz::memory::Allocator {
  public:
   void configure(void* user_data, ozz_alloc_fn alloc_fn, ozz_dealloc_fn dealloc_fn) {
@@ -115,70 +206,430 @@ class CallbackAllocator final : public ozz::memory::Allocator {
   ozz_dealloc_fn dealloc_fn_ = nullptr;
 };
 
-static size_t sampling_context_required_bytes(int32_t num_joints) {
-  const size_t max_soa_tracks = (size_t)num_soa_from_joints(num_joints);
-  const size_t max_tracks = max_soa_tracks * 4;
-  const size_t num_outdated = (max_soa_tracks + 7) / 8;
-  return sizeof(SamplingContextInterpSoaFloat3) * max_soa_tracks +
-      sizeof(SamplingContextInterpSoaQuaternion) * max_soa_tracks +
-      sizeof(SamplingContextInterpSoaFloat3) * max_soa_tracks +
-      sizeof(uint32_t) * max_tracks * 3 +
-      sizeof(uint8_t) * 3 * num_outdated;
-}
+// Size-class pools on one arena per thread. Blocks up to kMaxClassSize come
+// from 64 KiB chunks dedicated to one class; the chunk header, found by
+// masking the block address, names the class and the owning arena, so blocks
+// carry no header. Chunks are registered in a lock-free set, which tells them
+// apart from large blocks on free. A block freed by another thread is pushed
+// on its owner's remote list and recycled on the owner's next miss.
+class ArenaAllocator final : public ozz::memory::Allocator {
+ public:
+  static constexpr size_t kChunkSize = size_t(64) << 10;
+  static constexpr size_t kChunkHeaderSize = 64;  // also the max pooled alignment
+  static constexpr size_t kChunksPerSegment = 16;
+  static constexpr size_t kSegmentSize = kChunkSize * kChunksPerSegment;
+  static constexpr int kNumClasses = 9;  // 16 B .. 4 KiB
+  static constexpr size_t kMaxClassSize = size_t(16) << (kNumClasses - 1);
+  static constexpr size_t kRegistrySize = size_t(1) << 14;  // 1 GiB of chunks at 75% load
+
+  struct Arena;
+
+  void* Allocate(size_t size, size_t alignment) override {
+    Arena* arena = thread_arena();
+    if (!arena) return nullptr;
+    add_relaxed(arena->allocations, 1);
+    const size_t need = std::max({size, alignment, size_t(16)});
+    if (need <= kMaxClassSize && alignment <= kChunkHeaderSize) {
+      const int cls = (int)std::bit_width(need - 1) - 4;
+      if (void* block = allocate_small(arena, cls)) {
+        add_relaxed(arena->small_live, size_t(16) << cls);
+        note_peak(arena);
+        return block;
+      }
+    }
+    return allocate_large(arena, size, alignment);
+  }
+
+  void Deallocate(void* block) override {
+    if (!block) return;
+    const uintptr_t chunk = (uintptr_t)block & ~(uintptr_t)(kChunkSize - 1);
+    if (!is_chunk(chunk)) return free_large(block);
+    const ChunkHeader* header = (const ChunkHeader*)chunk;
+    Arena* owner = header->owner;
+    const size_t class_size = size_t(16) << header->size_class;
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    if (owner == t_arena_slot.arena) {
+      freed->next = owner->free[header->size_class];
+      owner->free[header->size_class] = freed;
+      owner->small_live.store(owner->small_live.load(std::memory_order_relaxed) - class_size,
+                              std::memory_order_relaxed);
+      return;
+    }
+    FreeBlock* head = owner->remote.load(std::memory_order_relaxed);
+    do {
+      freed->next = head;
+    } while (!owner->remote.compare_exchange_weak(head, freed, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    owner->remote_freed.fetch_add(class_size, std::memory_order_relaxed);
+  }
+
+  // Everything below needs no concurrent Allocate/Deallocate.
+  bool has_live_blocks() {
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    for (Arena* a = arenas_; a; a = a->next) {
+      if (live_bytes(a) != 0) return true;
+    }
+    return false;
+  }
+
+  // Returns every chunk to malloc, drops exited threads' arenas and restarts
+  // the statistics. Only valid once no arena block is live.
+  void release() {
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    Arena** link = &arenas_;
+    while (Arena* a = *link) {
+      for (ChunkHeader* segment = a->segments; segment;) {
+        ChunkHeader* next = segment->segment_next;
+        std::free(segment->segment_raw);
+        segment = next;
+      }
+      if (a->orphaned) {
+        *link = a->next;
+        delete a;
+        continue;
+      }
+      Arena* next = a->next;
+      a->~Arena();
+      new (a) Arena();
+      a->next = next;
+      link = &a->next;
+    }
+    orphans_ = nullptr;
+    for (auto& slot : registry_) slot.store(0, std::memory_order_relaxed);
+    registered_.store(0, std::memory_order_relaxed);
+  }
+
+  int32_t stats(ozz_arena_stats_t* out, int32_t capacity) {
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    int32_t count = 0;
+    for (Arena* a = arenas_; a; a = a->next, ++count) {
+      if (!out || count >= capacity) continue;
+      out[count].live_bytes = live_bytes(a);
+      out[count].peak_bytes = a->peak.load(std::memory_order_relaxed);
+      out[count].reserved_bytes = a->segment_bytes.load(std::memory_order_relaxed) +
+                                  a->large_live.load(std::memory_order_relaxed);
+      out[count].allocations = a->allocations.load(std::memory_order_relaxed);
+      out[count].large_allocations = a->large_allocations.load(std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct ChunkHeader {
+    Arena* owner;
+    int32_t size_class;
+    // First chunk of a segment only.
+    ChunkHeader* segment_next;
+    void* segment_raw;
+  };
+
+  struct LargeHeader {
+    void* raw;
+    Arena* owner;
+    size_t bytes;
+    size_t pad;
+  };
+
+  struct Arena {
+    // Owner thread only.
+    FreeBlock* free[kNumClasses] = {};
+    char* cursor[kNumClasses] = {};
+    char* cursor_end[kNumClasses] = {};
+    char* segment_cursor = nullptr;
+    char* segment_end = nullptr;
+    ChunkHeader* segments = nullptr;
+    Arena* next = nullptr;
+    Arena* next_orphan = nullptr;
+    bool orphaned = false;
+    // Written by the owner, read by stats.
+    std::atomic<size_t> small_live{0};
+    std::atomic<size_t> peak{0};
+    std::atomic<size_t> segment_bytes{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> large_allocations{0};
+    // Written by any thread.
+    alignas(64) std::atomic<FreeBlock*> remote{nullptr};
+    std::atomic<size_t> remote_freed{0};
+    std::atomic<size_t> large_live{0};
+  };
+
+  // Hands a thread's arena over to the next new thread once it exits.
+  struct Slot {
+    Arena* arena = nullptr;
+    ~Slot();
+  };
+  static thread_local Slot t_arena_slot;
+
+  void orphan(Arena* arena) {
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    arena->orphaned = true;
+    arena->next_orphan = orphans_;
+    orphans_ = arena;
+  }
+
+ private:
+  template <typename T>
+  static void add_relaxed(std::atomic<T>& counter, std::type_identity_t<T> delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+  static size_t live_bytes(const Arena* a) {
+    const size_t small = a->small_live.load(std::memory_order_relaxed);
+    const size_t remote = a->remote_freed.load(std::memory_order_relaxed);
+    return (small > remote ? small - remote : 0) + a->large_live.load(std::memory_order_relaxed);
+  }
+
+  static void note_peak(Arena* a) {
+    const size_t live = live_bytes(a);
+    if (live > a->peak.load(std::memory_order_relaxed)) a->peak.store(live, std::memory_order_relaxed);
+  }
 
-static constexpr size_t kSamplingContextAlignment = alignof(SamplingContextInterpSoaFloat3);
+  Arena* thread_arena() {
+    if (Arena* arena = t_arena_slot.arena) return arena;
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    Arena* arena = orphans_;
+    if (arena) {
+      orphans_ = arena->next_orphan;
+      arena->orphaned = false;
+    } else {
+      arena = new (std::nothrow) Arena();
+      if (!arena) return nullptr;
+      arena->next = arenas_;
+      arenas_ = arena;
+    }
+    t_arena_slot.arena = arena;
+    return arena;
+  }
+
+  void* allocate_small(Arena* arena, int cls) {
+    FreeBlock* block = arena->free[cls];
+    if (!block && arena->remote.load(std::memory_order_relaxed)) {
+      drain_remote(arena);
+      block = arena->free[cls];
+    }
+    if (block) {
+      arena->free[cls] = block->next;
+      return block;
+    }
+    const size_t class_size = size_t(16) << cls;
+    if ((size_t)(arena->cursor_end[cls] - arena->cursor[cls]) < class_size) {
+      char* chunk = new_chunk(arena, cls);
+      if (!chunk) return nullptr;
+      arena->cursor[cls] = chunk + kChunkHeaderSize;
+      arena->cursor_end[cls] = chunk + kChunkSize;
+    }
+    void* out = arena->cursor[cls];
+    arena->cursor[cls] += class_size;
+    return out;
+  }
+
+  static void drain_remote(Arena* arena) {
+    FreeBlock* block = arena->remote.exchange(nullptr, std::memory_order_acquire);
+    while (block) {
+      FreeBlock* next = block->next;
+      const auto* header = (const ChunkHeader*)((uintptr_t)block & ~(uintptr_t)(kChunkSize - 1));
+      block->next = arena->free[header->size_class];
+      arena->free[header->size_class] = block;
+      block = next;
+    }
+  }
+
+  char* new_chunk(Arena* arena, int cls) {
+    if (arena->segment_cursor == arena->segment_end) {
+      // Keeps the registry's load under 75% so probes stay short and inserts
+      // can't fail; past that, blocks fall back to the large path.
+      if (registered_.fetch_add(kChunksPerSegment, std::memory_order_relaxed) + kChunksPerSegment >
+          kRegistrySize / 4 * 3) {
+        registered_.fetch_sub(kChunksPerSegment, std::memory_order_relaxed);
+        return nullptr;
+      }
+      void* raw = std::malloc(kSegmentSize + kChunkSize);
+      if (!raw) {
+        registered_.fetch_sub(kChunksPerSegment, std::memory_order_relaxed);
+        return nullptr;
+      }
+      char* segment = (char*)(((uintptr_t)raw + kChunkSize - 1) & ~(uintptr_t)(kChunkSize - 1));
+      for (size_t i = 0; i < kChunksPerSegment; ++i) register_chunk((uintptr_t)(segment + i * kChunkSize));
+      ChunkHeader* first = (ChunkHeader*)segment;
+      first->segment_next = arena->segments;
+      first->segment_raw = raw;
+      arena->segments = first;
+      arena->segment_cursor = segment;
+      arena->segment_end = segment + kSegmentSize;
+      add_relaxed(arena->segment_bytes, kSegmentSize + kChunkSize);
+    }
+    char* chunk = arena->segment_cursor;
+    arena->segment_cursor += kChunkSize;
+    ChunkHeader* header = (ChunkHeader*)chunk;
+    header->owner = arena;
+    header->size_class = cls;
+    return chunk;
+  }
+
+  void* allocate_large(Arena* arena, size_t size, size_t alignment) {
+    // The header fills the block's leading alignment padding.
+    const size_t align = std::max(alignment, alignof(std::max_align_t));
+    const size_t offset = std::max(sizeof(LargeHeader), alignment);
+    const size_t bytes = size + offset + align - 1;
+    void* raw = std::malloc(bytes);
+    if (!raw) return nullptr;
+    char* block = (char*)(((uintptr_t)raw + offset + align - 1) & ~(uintptr_t)(align - 1));
+    LargeHeader* header = (LargeHeader*)(block - sizeof(LargeHeader));
+    header->raw = raw;
+    header->owner = arena;
+    header->bytes = bytes;
+    arena->large_live.fetch_add(bytes, std::memory_order_relaxed);
+    add_relaxed(arena->large_allocations, 1);
+    note_peak(arena);
+    return block;
+  }
+
+  static void free_large(void* block) {
+    const LargeHeader* header = (const LargeHeader*)((char*)block - sizeof(LargeHeader));
+    header->owner->large_live.fetch_sub(header->bytes, std::memory_order_relaxed);
+    std::free(header->raw);
+  }
+
+  static size_t registry_slot(uintptr_t chunk) {
+    return (size_t)(((uint64_t)(chunk / kChunkSize) * 0x9E3779B97F4A7C15ull) >> 50);
+  }
+
+  void register_chunk(uintptr_t chunk) {
+    for (size_t slot = registry_slot(chunk);; slot = (slot + 1) & (kRegistrySize - 1)) {
+      uintptr_t expected = 0;
+      if (registry_[slot].compare_exchange_strong(expected, chunk, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  bool is_chunk(uintptr_t chunk) const {
+    for (size_t slot = registry_slot(chunk);; slot = (slot + 1) & (kRegistrySize - 1)) {
+      const uintptr_t entry = registry_[slot].load(std::memory_order_acquire);
+      if (entry == chunk) return true;
+      if (entry == 0) return false;
+    }
+  }
+
+  std::mutex arenas_mutex_;
+  Arena* arenas_ = nullptr;
+  Arena* orphans_ = nullptr;
+  std::atomic<size_t> registered_{0};
+  std::atomic<uintptr_t> registry_[kRegistrySize] = {};
+};
+static_assert((size_t(1) << (64 - 50)) == ArenaAllocator::kRegistrySize, "registry hash width");
+static_assert(sizeof(ArenaAllocator::ChunkHeader) <= ArenaAllocator::kChunkHeaderSize, "chunk header");
+
+thread_local ArenaAllocator::Slot ArenaAllocator::t_arena_slot;
 
-class FixedBlockAllocator final : public ozz::memory::Allocator {
+static thread_local ozz_alloc_category_t t_alloc_category = OZZ_ALLOC_OTHER;
+static thread_local bool t_in_hot_path = false;
+static std::atomic<bool> g_hot_path_guard{false};
+
+// Always ozz's default allocator: tags each block with the calling thread's
+// category and forwards to the selected allocator (ozz's heap, the external
+// callbacks or the arena). The 16 bytes header keeps the category and size
+// for the free.
+class AccountingAllocator final : public ozz::memory::Allocator {
  public:
-  FixedBlockAllocator(void* block, size_t block_size)
-      : block_(static_cast<unsigned char*>(block)), block_size_(block_size) {}
+  struct Header {
+    uint64_t size;
+    uint32_t offset;
+    uint32_t category;
+  };
+
+  void select(ozz::memory::Allocator* allocator) { selected_.store(allocator, std::memory_order_release); }
+  ozz::memory::Allocator* selected() const { return selected_.load(std::memory_order_acquire); }
 
   void* Allocate(size_t size, size_t alignment) override {
-    if (used_) return nullptr;
-    const uintptr_t base = reinterpret_cast<uintptr_t>(block_);
-    const uintptr_t aligned = align_up_uintptr(base, alignment);
-    const size_t padding = (size_t)(aligned - base);
-    if (padding + size > block_size_) return nullptr;
-    used_ = true;
-    allocation_ = reinterpret_cast<void*>(aligned);
-    return allocation_;
+    const size_t offset = std::max(sizeof(Header), alignment);
+    char* raw = (char*)selected()->Allocate(size + offset, std::max(alignment, alignof(Header)));
+    if (!raw) return nullptr;
+    Header* header = (Header*)(raw + offset) - 1;
+    header->size = size;
+    header->offset = (uint32_t)offset;
+    header->category = (uint32_t)t_alloc_category;
+
+    Counters& counters = counters_[t_alloc_category];
+    const size_t live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    counters.live_blocks.fetch_add(1, std::memory_order_relaxed);
+    counters.total_blocks.fetch_add(1, std::memory_order_relaxed);
+    if (t_in_hot_path) hot_path_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return raw + offset;
   }
 
   void Deallocate(void* block) override {
-    if (!block || block == allocation_) return;
+    if (!block) return;
+    const Header* header = (const Header*)block - 1;
+    Counters& counters = counters_[header->category];
+    counters.live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    counters.live_blocks.fetch_sub(1, std::memory_order_relaxed);
+    selected()->Deallocate((char*)block - header->offset);
+  }
+
+  void read(ozz_alloc_category_t category, ozz_alloc_counters_t* out) const {
+    const Counters& counters = counters_[category];
+    out->live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+    out->peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    out->live_blocks = counters.live_blocks.load(std::memory_order_relaxed);
+    out->total_blocks = counters.total_blocks.load(std::memory_order_relaxed);
   }
 
-  bool used_block() const { return used_; }
+  uint64_t hot_path_allocations() const { return hot_path_allocations_.load(std::memory_order_relaxed); }
+
+  // Blocks of every category not yet freed, whichever allocator served them.
+  uint64_t live_blocks() const {
+    uint64_t blocks = 0;
+    for (const Counters& counters : counters_) blocks += counters.live_blocks.load(std::memory_order_relaxed);
+    return blocks;
+  }
 
  private:
-  unsigned char* block_ = nullptr;
-  size_t block_size_ = 0;
-  void* allocation_ = nullptr;
-  bool used_ = false;
+  struct Counters {
+    std::atomic<size_t> live_bytes{0};
+    std::atomic<size_t> peak_bytes{0};
+    std::atomic<uint64_t> live_blocks{0};
+    std::atomic<uint64_t> total_blocks{0};
+  };
+  std::atomic<ozz::memory::Allocator*> selected_{nullptr};
+  Counters counters_[OZZ_ALLOC_CATEGORY_COUNT];
+  std::atomic<uint64_t> hot_path_allocations_{0};
+};
+static_assert(sizeof(AccountingAllocator::Header) == 16, "accounting header");
+
+// Marks a cozz entry point that must not allocate, when the guard is on.
+struct HotPathScope {
+  HotPathScope() : previous(t_in_hot_path) {
+    if (g_hot_path_guard.load(std::memory_order_relaxed)) t_in_hot_path = true;
+  }
+  ~HotPathScope() { t_in_hot_path = previous; }
+  bool previous;
 };
 
 static std::mutex g_ozz_allocator_mutex;
 static CallbackAllocator g_callback_allocator;
-static ozz::memory::Allocator* g_base_ozz_allocator = nullptr;
+static ArenaAllocator g_arena_allocator;
+static AccountingAllocator g_accounting_allocator;
 
-template <typename Fn>
-static auto with_temporary_ozz_allocator(ozz::memory::Allocator* allocator, Fn&& fn)
-    -> decltype(fn()) {
-  std::lock_guard<std::mutex> lock(g_ozz_allocator_mutex);
-  ozz::memory::Allocator* previous = ozz::memory::SetDefaulAllocator(allocator);
-  struct RestoreAllocator {
-    ozz::memory::Allocator* previous;
-    ~RestoreAllocator() { ozz::memory::SetDefaulAllocator(previous); }
-  } restore{previous};
-  return fn();
+ArenaAllocator::Slot::~Slot() {
+  if (arena) g_arena_allocator.orphan(arena);
 }
 
-static ozz::memory::Allocator* get_base_ozz_allocator_locked() {
-  if (!g_base_ozz_allocator) {
-    g_base_ozz_allocator = ozz::memory::default_allocator();
-  }
-  return g_base_ozz_allocator;
+// Put in front of ozz's heap allocator during static initialization, before
+// anything can allocate through ozz.
+static ozz::memory::Allocator* install_accounting_allocator() {
+  ozz::memory::Allocator* heap = ozz::memory::SetDefaulAllocator(&g_accounting_allocator);
+  g_accounting_allocator.select(heap);
+  return heap;
 }
+static ozz::memory::Allocator* const g_base_ozz_allocator = install_accounting_allocator();
 
 template <typename T, typename... Args>
 static T* alloc_with_ozz_allocator(Args&&... args) {
@@ -210,38 +661,126 @@ ozz_result_t ozz_set_external_allocator(void* user_data, ozz_alloc_fn alloc_fn,
   ozz_clear_error();
   if (!alloc_fn || !dealloc_fn) return set_err(OZZ_ERR_INVALID_ARGUMENT, "allocator callbacks null");
   std::lock_guard<std::mutex> lock(g_ozz_allocator_mutex);
-  get_base_ozz_allocator_locked();
-  g_callback_allocator.configure(user_data, alloc_fn, dealloc_fn);
-  if (ozz::memory::default_allocator() != &g_callback_allocator) {
-    ozz::memory::SetDefaulAllocator(&g_callback_allocator);
+  if (g_accounting_allocator.selected() == &g_arena_allocator) {
+    if (g_arena_allocator.has_live_blocks()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "arena allocator has live blocks");
+    g_arena_allocator.release();
   }
+  g_callback_allocator.configure(user_data, alloc_fn, dealloc_fn);
+  g_accounting_allocator.select(&g_callback_allocator);
   return OZZ_OK;
 }
 
 ozz_result_t ozz_reset_external_allocator(void) {
   ozz_clear_error();
   std::lock_guard<std::mutex> lock(g_ozz_allocator_mutex);
-  ozz::memory::Allocator* base = get_base_ozz_allocator_locked();
-  g_callback_allocator.clear();
-  if (ozz::memory::default_allocator() == &g_callback_allocator) {
-    ozz::memory::SetDefaulAllocator(base);
+  if (g_accounting_allocator.selected() == &g_arena_allocator) {
+    if (g_arena_allocator.has_live_blocks()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "arena allocator has live blocks");
+    g_arena_allocator.release();
   }
+  g_callback_allocator.clear();
+  g_accounting_allocator.select(g_base_ozz_allocator);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_set_arena_allocator(void) {
+  ozz_clear_error();
+  std::lock_guard<std::mutex> lock(g_ozz_allocator_mutex);
+  if (g_accounting_allocator.selected() == &g_arena_allocator) return OZZ_OK;
+  // Blocks carry no owner, so heap or callback blocks freed after the switch
+  // would reach the arena.
+  if (g_accounting_allocator.live_blocks() != 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "allocator has live blocks");
+  g_callback_allocator.clear();
+  g_accounting_allocator.select(&g_arena_allocator);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_arena_allocator_reset(void) {
+  ozz_clear_error();
+  std::lock_guard<std::mutex> lock(g_ozz_allocator_mutex);
+  if (g_arena_allocator.has_live_blocks()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "arena allocator has live blocks");
+  g_arena_allocator.release();
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_arena_allocator_stats(ozz_arena_stats_t* out, int32_t capacity, int32_t* out_count) {
+  ozz_clear_error();
+  if (!out_count || capacity < 0 || (!out && capacity > 0)) return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad stats buffer");
+  *out_count = g_arena_allocator.stats(out, capacity);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_alloc_counters(ozz_alloc_category_t category, ozz_alloc_counters_t* out) {
+  ozz_clear_error();
+  if (!out) return set_err(OZZ_ERR_INVALID_ARGUMENT, "out null");
+  if ((int)category < 0 || category >= OZZ_ALLOC_CATEGORY_COUNT) return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad category");
+  g_accounting_allocator.read(category, out);
   return OZZ_OK;
 }
 
+void ozz_set_hot_path_guard(int32_t enabled) { g_hot_path_guard.store(enabled != 0, std::memory_order_relaxed); }
+uint64_t ozz_hot_path_allocations(void) { return g_accounting_allocator.hot_path_allocations(); }
+
+ozz_alloc_category_t cozz_swap_alloc_category(ozz_alloc_category_t category) {
+  const ozz_alloc_category_t previous = t_alloc_category;
+  t_alloc_category = category;
+  return previous;
+}
+
+static void build_ltm_levels(const ozz::animation::Skeleton& skel, ozz_ltm_levels_t* out) {
+  const auto parents = skel.joint_parents();
+  const int32_t num_joints = (int32_t)skel.num_joints();
+
+  // Parents precede children in DF order, so depths resolve in one pass.
+  ozz::vector<int32_t> depth((size_t)num_joints, 0);
+  int32_t max_depth = 0;
+  for (int32_t j = 0; j < num_joints; ++j) {
+    const int32_t parent = parents[(size_t)j];
+    depth[(size_t)j] = parent == ozz::animation::Skeleton::kNoParent ? 0 : depth[(size_t)parent] + 1;
+    if (depth[(size_t)j] > max_depth) max_depth = depth[(size_t)j];
+  }
+
+  *out = ozz_ltm_levels_t();
+  for (int32_t d = 0; d <= max_depth && num_joints > 0; ++d) {
+    int32_t lane = 0;
+    int32_t first = 0;
+    for (int32_t j = 0; j < num_joints; ++j) {
+      if (depth[(size_t)j] != d) continue;
+      if (lane == 0) first = j;
+      out->joints.push_back(j);
+      out->parents.push_back(parents[(size_t)j]);
+      out->local_offsets.push_back(soa_lane_offset(j));
+      if (++lane == 4) {
+        out->lanes.push_back(4);
+        lane = 0;
+      }
+    }
+    if (lane == 0) continue;
+    out->lanes.push_back((uint8_t)lane);
+    for (; lane < 4; ++lane) {
+      out->joints.push_back(first);
+      out->parents.push_back(parents[(size_t)first]);
+      out->local_offsets.push_back(soa_lane_offset(first));
+    }
+  }
+  out->num_groups = (int32_t)out->lanes.size();
+}
+
 ozz_result_t ozz_skeleton_load_from_file(const char* path, ozz_skeleton_t** out_skel) {
   ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_SKELETON);
   if (!out_skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "out_skel null");
   auto* h = alloc_with_ozz_allocator<ozz_skeleton_t>();
   if (!h) return set_err(OZZ_ERR, "oom");
   ozz_result_t r = load_ozz_object_from_file(path, &h->skel);
   if (r != OZZ_OK) { free_with_ozz_allocator(h); return r; }
+  build_ltm_levels(h->skel, &h->levels);
   *out_skel = h;
   return OZZ_OK;
 }
 
 ozz_result_t ozz_animation_load_from_file(const char* path, ozz_animation_t** out_anim) {
   ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
   if (!out_anim) return set_err(OZZ_ERR_INVALID_ARGUMENT, "out_anim null");
   auto* h = alloc_with_ozz_allocator<ozz_animation_t>();
   if (!h) return set_err(OZZ_ERR, "oom");
@@ -275,16 +814,211 @@ int32_t ozz_skeleton_joint_parent(const ozz_skeleton_t* skel, int32_t joint) {
 float ozz_animation_duration(const ozz_animation_t* anim) {
   return anim ? anim->anim.duration() : 0.0f;
 }
+size_t ozz_animation_size_bytes(const ozz_animation_t* anim) {
+  return anim ? anim->anim.size() : 0u;
+}
+
+// ---- Retargeting ----
+// Everything is precompiled per target SoA group so the per-frame pass is a
+// lane gather from the sampled source pose followed by SoA math.
+struct ozz_retarget_t {
+  const ozz::animation::Skeleton* source;
+  const ozz::animation::Skeleton* target;
+  int32_t source_tracks;
+  int32_t source_soa;
+  int32_t target_joints;
+  int32_t target_soa;
+  bool sparse; // unmapped joints are masked out of normal layers
+
+  ozz::vector<int32_t> source_joint;       // [target_joints], -1 if unmapped
+  ozz::vector<int32_t> lane_offsets;       // [target_soa * 4], float offset of the source lane
+  ozz::vector<ozz::math::SimdInt4> mapped; // [target_soa], lane mask of mapped joints
+  ozz::vector<uint8_t> any_mapped;         // [target_soa], 0 when the whole group is unmapped
+  ozz::vector<ozz::math::SoaQuaternion> rest_delta;  // [target_soa]
+  ozz::vector<ozz::math::SoaFloat3> translation_scale; // [target_soa]
+};
+
+// `source_h` is null for sparse-track maps: tracks have no rest pose of their
+// own, so deltas stay identity and translations are not scaled.
+static ozz_result_t retarget_build(const ozz_skeleton_t* source_h, int32_t source_tracks,
+                                   const ozz_skeleton_t* target_h,
+                                   const int32_t* target_to_source, ozz_retarget_t** out_rt) {
+  const ozz::animation::Skeleton* source = source_h ? &source_h->skel : nullptr;
+  const ozz::animation::Skeleton& target = target_h->skel;
+
+  auto* rt = alloc_with_ozz_allocator<ozz_retarget_t>();
+  if (!rt) return set_err(OZZ_ERR, "oom");
+
+  rt->source = source;
+  rt->target = &target;
+  rt->sparse = source == nullptr;
+  rt->source_tracks = source_tracks;
+  rt->source_soa = num_soa_from_joints(rt->source_tracks);
+  rt->target_joints = (int32_t)target.num_joints();
+  rt->target_soa = num_soa_from_joints(rt->target_joints);
+
+  rt->source_joint.assign((size_t)rt->target_joints, -1);
+  rt->lane_offsets.assign((size_t)rt->target_soa * 4u, 0);
+  rt->mapped.resize((size_t)rt->target_soa);
+  rt->any_mapped.assign((size_t)rt->target_soa, 0);
+  rt->rest_delta.resize((size_t)rt->target_soa);
+  rt->translation_scale.resize((size_t)rt->target_soa);
+
+  for (int32_t soa = 0; soa < rt->target_soa; ++soa) {
+    alignas(16) int32_t mask[4] = {0, 0, 0, 0};
+    alignas(16) float dx[4], dy[4], dz[4], dw[4];
+    alignas(16) float scale[4];
+
+    for (int32_t lane = 0; lane < 4; ++lane) {
+      const int32_t j = soa * 4 + lane;
+      dx[lane] = dy[lane] = dz[lane] = 0.f;
+      dw[lane] = 1.f;
+      scale[lane] = 1.f;
+      if (j >= rt->target_joints) continue;
+
+      const int32_t s = target_to_source[j];
+      if (s < 0 || s >= rt->source_tracks) continue;
+
+      rt->source_joint[(size_t)j] = s;
+      rt->lane_offsets[(size_t)j] = soa_lane_offset(s);
+      rt->any_mapped[(size_t)soa] = 1;
+      mask[lane] = -1;
+      if (!source) continue;
+
+      const ozz::math::Transform src_rest = ozz::animation::GetJointLocalRestPose(*source, s);
+      const ozz::math::Transform dst_rest = ozz::animation::GetJointLocalRestPose(target, j);
+
+      const ozz::math::Quaternion delta = Conjugate(src_rest.rotation) * dst_rest.rotation;
+      dx[lane] = delta.x;
+      dy[lane] = delta.y;
+      dz[lane] = delta.z;
+      dw[lane] = delta.w;
+
+      // Bone length ratio. Degenerate source bones (roots at origin...) keep
+      // the source translation untouched.
+      const float src_len = Length(src_rest.translation);
+      const float dst_len = Length(dst_rest.translation);
+      scale[lane] = src_len > 1e-6f ? dst_len / src_len : 1.f;
+    }
+
+    rt->mapped[(size_t)soa] = ozz::math::simd_int4::LoadPtr(mask);
+    rt->rest_delta[(size_t)soa] = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::LoadPtr(dx), ozz::math::simd_float4::LoadPtr(dy),
+        ozz::math::simd_float4::LoadPtr(dz), ozz::math::simd_float4::LoadPtr(dw));
+    const ozz::math::SimdFloat4 s4 = ozz::math::simd_float4::LoadPtr(scale);
+    rt->translation_scale[(size_t)soa] = ozz::math::SoaFloat3::Load(s4, s4, s4);
+  }
+
+  *out_rt = rt;
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_retarget_create(const ozz_skeleton_t* source, const ozz_skeleton_t* target, ozz_retarget_t** out_rt) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!source || !target || !out_rt) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+
+  const auto names = target->skel.joint_names();
+  ozz::vector<int32_t> map(names.size(), -1);
+  for (size_t j = 0; j < names.size(); ++j) {
+    map[j] = (int32_t)ozz::animation::FindJoint(source->skel, names[j]);
+  }
+  return retarget_build(source, (int32_t)source->skel.num_joints(), target, map.data(), out_rt);
+}
+
+ozz_result_t ozz_retarget_create_with_map(const ozz_skeleton_t* source, const ozz_skeleton_t* target,
+                                          const int32_t* target_to_source, int32_t count,
+                                          ozz_retarget_t** out_rt) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!source || !target || !target_to_source || !out_rt) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (count < (int32_t)target->skel.num_joints()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "map smaller than target joint count");
+  return retarget_build(source, (int32_t)source->skel.num_joints(), target, target_to_source, out_rt);
+}
+
+ozz_result_t ozz_retarget_create_sparse(const ozz_skeleton_t* target,
+                                        const int32_t* track_to_joint, int32_t num_tracks,
+                                        ozz_retarget_t** out_rt) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!target || !track_to_joint || !out_rt) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (num_tracks <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no tracks");
+
+  // Inverts the track table into the target_to_source layout.
+  const int32_t num_joints = (int32_t)target->skel.num_joints();
+  ozz::vector<int32_t> map((size_t)num_joints, -1);
+  for (int32_t track = 0; track < num_tracks; ++track) {
+    const int32_t j = track_to_joint[track];
+    if (j < 0) continue;
+    if (j >= num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "track joint out of range");
+    if (map[(size_t)j] >= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "joint driven by several tracks");
+    map[(size_t)j] = track;
+  }
+  return retarget_build(nullptr, num_tracks, target, map.data(), out_rt);
+}
+
+void ozz_retarget_destroy(ozz_retarget_t* rt) { free_with_ozz_allocator(rt); }
+
+int32_t ozz_retarget_source_joint(const ozz_retarget_t* rt, int32_t target_joint) {
+  if (!rt || target_joint < 0 || target_joint >= rt->target_joints) return -1;
+  return rt->source_joint[(size_t)target_joint];
+}
+
+int32_t ozz_retarget_source_tracks(const ozz_retarget_t* rt) { return rt ? rt->source_tracks : 0; }
+
+// Converts a pose sampled on the source skeleton into the target skeleton.
+// Additive clips are deltas, so they skip the rest-pose delta and unmapped
+// joints receive the identity instead of the rest pose.
+static void retarget_pose(const ozz_retarget_t* rt,
+                          const ozz::math::SoaTransform* source_pose,
+                          bool additive,
+                          ozz::math::SoaTransform* out) {
+  using namespace ozz::math;
+  const float* base = reinterpret_cast<const float*>(source_pose);
+  const auto rest = rt->target->joint_rest_poses();
+  const SoaTransform identity = SoaTransform::identity();
+
+  for (int32_t soa = 0; soa < rt->target_soa; ++soa) {
+    const SoaTransform& fallback = additive ? identity : rest[(size_t)soa];
+    if (!rt->any_mapped[(size_t)soa]) {
+      out[soa] = fallback;
+      continue;
+    }
+
+    const int32_t* offsets = rt->lane_offsets.data() + (size_t)soa * 4u;
+    const SimdInt4 mapped = rt->mapped[(size_t)soa];
+
+    const SoaFloat3 t = SoaFloat3::Load(gather_lanes(base, offsets, 0), gather_lanes(base, offsets, 1),
+                                        gather_lanes(base, offsets, 2)) *
+                        rt->translation_scale[(size_t)soa];
+    SoaQuaternion r = SoaQuaternion::Load(gather_lanes(base, offsets, 3), gather_lanes(base, offsets, 4),
+                                          gather_lanes(base, offsets, 5), gather_lanes(base, offsets, 6));
+    if (!additive) r = r * rt->rest_delta[(size_t)soa];
+    const SoaFloat3 s = SoaFloat3::Load(gather_lanes(base, offsets, 7), gather_lanes(base, offsets, 8),
+                                        gather_lanes(base, offsets, 9));
+
+    SoaTransform& o = out[soa];
+    o.translation.x = Select(mapped, t.x, fallback.translation.x);
+    o.translation.y = Select(mapped, t.y, fallback.translation.y);
+    o.translation.z = Select(mapped, t.z, fallback.translation.z);
+    o.rotation.x = Select(mapped, r.x, fallback.rotation.x);
+    o.rotation.y = Select(mapped, r.y, fallback.rotation.y);
+    o.rotation.z = Select(mapped, r.z, fallback.rotation.z);
+    o.rotation.w = Select(mapped, r.w, fallback.rotation.w);
+    o.scale.x = Select(mapped, s.x, fallback.scale.x);
+    o.scale.y = Select(mapped, s.y, fallback.scale.y);
+    o.scale.z = Select(mapped, s.z, fallback.scale.z);
+  }
+}
 
 // ---- Instance + Workspace ----
 struct ozz_instance_t {
   const ozz::animation::Skeleton* skel;
   int32_t num_joints;
   int32_t num_soa;
+  int32_t max_tracks; // sampling context capacity, >= num_joints
 
-  ozz::animation::SamplingJob::Context sampling_ctx;
-  void* sampling_ctx_mem;
-  size_t sampling_ctx_mem_bytes;
+  ozz::animation::SamplingJob::Context sampling_ctx; // placed in the instance memory
 
   ozz::math::SoaTransform* accum; // persistent pose (SoA)
   ozz::math::SimdFloat4* layer_joint_weights; // [OZZ_MAX_LAYERS * num_soa]
@@ -295,6 +1029,22 @@ struct ozz_instance_t {
 
   ozz_ik_job_t ik[OZZ_MAX_IK_JOBS];
   int32_t ik_count;
+
+  const ozz_ltm_levels_t* levels;
+  ozz_ltm_mode_t ltm_mode;
+
+  const ozz_mesh_remap_t* bounds_mesh; // null: bounds enclose joint positions
+  int32_t baked_layer_count;
+
+  // Update-rate LOD (ozz_instance_set_update_rate).
+  int32_t update_interval;
+  int32_t update_phase;
+  ozz_update_mode_t update_mode;
+  float* history;            // caller memory: [2][12 * num_joints], last two full evals
+  float history_bounds[2][6];
+  uint64_t history_frame[2];
+  int32_t history_count;     // 0..2
+  int32_t history_newest;
 };
 
 struct ozz_workspace_t {
@@ -304,26 +1054,48 @@ struct ozz_workspace_t {
 
   ozz::math::SoaTransform* sampled_normal;   // [OZZ_MAX_LAYERS * num_soa]
   ozz::math::SoaTransform* sampled_additive; // [OZZ_MAX_LAYERS * num_soa]
+  ozz::math::SoaTransform* retarget_source;  // [max_soa_tracks], source-skeleton pose scratch
+  int32_t max_soa_tracks;
   ozz::math::Float4x4* model;         // scratch
   float* palette;                     // output: 12*num_joints floats
+  float bounds[6];                    // output: model-space min xyz, max xyz
 };
 
+// Defined with the mesh palettes.
+static const ozz::animation::Skeleton* mesh_remap_skeleton(const ozz_mesh_remap_t* mesh);
+static bool mesh_bounds(const ozz_mesh_remap_t* mesh, const ozz::math::Float4x4* model,
+                        ozz::math::SimdFloat4* min, ozz::math::SimdFloat4* max);
+
+static inline int32_t clamp_max_tracks(const ozz_skeleton_t* skel_h, int32_t max_tracks) {
+  const int32_t n = (int32_t)skel_h->skel.num_joints();
+  return max_tracks > n ? max_tracks : n;
+}
+
 size_t ozz_instance_required_bytes(const ozz_skeleton_t* skel_h) {
+  return ozz_instance_required_bytes_ex(skel_h, 0);
+}
+
+size_t ozz_instance_required_bytes_ex(const ozz_skeleton_t* skel_h, int32_t max_tracks) {
   if (!skel_h) return 0;
   const int32_t n = (int32_t)skel_h->skel.num_joints();
   const int32_t ns = num_soa_from_joints(n);
+  const int32_t nt = clamp_max_tracks(skel_h, max_tracks);
 
   size_t bytes = 0;
   auto bump = [&](size_t sz, size_t al) { bytes = (bytes + (al - 1)) & ~(al - 1); bytes += sz; };
 
   bump(sizeof(ozz_instance_t), alignof(ozz_instance_t));
-  bump(sampling_context_required_bytes(n), kSamplingContextAlignment);
+  bump(ozz::animation::SamplingJob::Context::RequiredBytes(nt), ozz::animation::SamplingJob::Context::kBufferAlignment);
   bump(sizeof(ozz::math::SoaTransform) * (size_t)ns, alignof(ozz::math::SoaTransform));
   bump(sizeof(ozz::math::SimdFloat4) * (size_t)(ns * OZZ_MAX_LAYERS), alignof(ozz::math::SimdFloat4));
   return bytes;
 }
 
 ozz_result_t ozz_instance_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel_h, ozz_instance_t** out_inst) {
+  return ozz_instance_init_ex(mem, mem_bytes, skel_h, 0, out_inst);
+}
+
+ozz_result_t ozz_instance_init_ex(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel_h, int32_t max_tracks, ozz_instance_t** out_inst) {
   ozz_clear_error();
   if (!mem || !skel_h || !out_inst) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
 
@@ -335,22 +1107,21 @@ ozz_result_t ozz_instance_init(void* mem, size_t mem_bytes, const ozz_skeleton_t
   new (inst) ozz_instance_t();
 
   inst->skel = &skel_h->skel;
+  inst->levels = &skel_h->levels;
+  inst->ltm_mode = OZZ_LTM_DEPTH_FIRST;
   inst->num_joints = (int32_t)skel_h->skel.num_joints();
   inst->num_soa = num_soa_from_joints(inst->num_joints);
-  inst->sampling_ctx_mem_bytes = sampling_context_required_bytes(inst->num_joints);
-  inst->sampling_ctx_mem = bump_alloc_bytes(cur, left, inst->sampling_ctx_mem_bytes, kSamplingContextAlignment);
-  if (!inst->sampling_ctx_mem) {
+  inst->max_tracks = clamp_max_tracks(skel_h, max_tracks);
+  // The context is placed in caller memory: no allocator, no global lock.
+  const size_t sampling_ctx_bytes = ozz::animation::SamplingJob::Context::RequiredBytes(inst->max_tracks);
+  void* sampling_ctx_mem = bump_alloc_bytes(cur, left, sampling_ctx_bytes, ozz::animation::SamplingJob::Context::kBufferAlignment);
+  if (!sampling_ctx_mem) {
     inst->~ozz_instance_t();
     return set_err(OZZ_ERR_INVALID_ARGUMENT, "mem too small (sampling_ctx)");
   }
-
-  FixedBlockAllocator sampling_ctx_allocator(inst->sampling_ctx_mem, inst->sampling_ctx_mem_bytes);
-  with_temporary_ozz_allocator(&sampling_ctx_allocator, [&]() {
-    inst->sampling_ctx.Resize(inst->num_joints);
-  });
-  if (!sampling_ctx_allocator.used_block()) {
+  if (!inst->sampling_ctx.Resize(inst->max_tracks, {static_cast<ozz::byte*>(sampling_ctx_mem), sampling_ctx_bytes})) {
     inst->~ozz_instance_t();
-    return set_err(OZZ_ERR, "sampling context allocation failed");
+    return set_err(OZZ_ERR, "sampling context placement failed");
   }
 
   inst->accum = bump_alloc<ozz::math::SoaTransform>(cur, left, (size_t)inst->num_soa);
@@ -366,8 +1137,12 @@ ozz_result_t ozz_instance_init(void* mem, size_t mem_bytes, const ozz_skeleton_t
   }
 
   inst->layer_count = 0;
+  inst->baked_layer_count = 0;
   inst->ik_count = 0;
   std::memset(inst->layer_has_joint_weights, 0, sizeof(inst->layer_has_joint_weights));
+  inst->update_interval = 1;
+  inst->history = nullptr;
+  inst->history_count = 0;
 
   *out_inst = inst;
   return OZZ_OK;
@@ -375,35 +1150,47 @@ ozz_result_t ozz_instance_init(void* mem, size_t mem_bytes, const ozz_skeleton_t
 
 void ozz_instance_deinit(ozz_instance_t* inst) {
   if (!inst) return;
-  FixedBlockAllocator sampling_ctx_allocator(inst->sampling_ctx_mem, inst->sampling_ctx_mem_bytes);
-  with_temporary_ozz_allocator(&sampling_ctx_allocator, [&]() {
-    inst->~ozz_instance_t();
-  });
+  inst->~ozz_instance_t();
 }
 
 void ozz_instance_set_layers(ozz_instance_t* inst, const ozz_layer_desc_t* layers, int32_t count) {
   if (!inst) return;
+  inst->baked_layer_count = 0;
   if (!layers || count <= 0) { inst->layer_count = 0; std::memset(inst->layer_has_joint_weights, 0, sizeof(inst->layer_has_joint_weights)); return; }
   if (count > OZZ_MAX_LAYERS) count = OZZ_MAX_LAYERS;
   inst->layer_count = count;
   for (int32_t i = 0; i < count; ++i) {
     inst->layers[i] = layers[i];
     inst->layer_has_joint_weights[i] = 0;
+    if (layers[i].baked) ++inst->baked_layer_count;
 
-    if (!layers[i].joint_weights || layers[i].joint_weights_count <= 0) {
+    const bool has_weights = layers[i].joint_weights && layers[i].joint_weights_count > 0;
+    if (!has_weights) {
       inst->layers[i].joint_weights = nullptr;
       inst->layers[i].joint_weights_count = 0;
-      continue;
     }
 
+    // Sparse-track layers only weigh in on the joints they drive.
+    const ozz_retarget_t* rt = layers[i].retarget;
+    const bool coverage = rt && rt->sparse && rt->target_soa == inst->num_soa &&
+                          layers[i].mode != OZZ_LAYER_ADDITIVE;
+    if (!has_weights && !coverage) continue;
+
     ozz::math::SimdFloat4* dst = inst->layer_joint_weights + (size_t)i * (size_t)inst->num_soa;
     for (int32_t soa = 0; soa < inst->num_soa; ++soa) {
-      const int32_t base = soa * 4;
-      const float x = base + 0 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 0] : 0.f;
-      const float y = base + 1 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 1] : 0.f;
-      const float z = base + 2 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 2] : 0.f;
-      const float w = base + 3 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 3] : 0.f;
-      dst[soa] = ozz::math::simd_float4::Load(x, y, z, w);
+      ozz::math::SimdFloat4 w = ozz::math::simd_float4::one();
+      if (has_weights) {
+        const int32_t base = soa * 4;
+        const float x = base + 0 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 0] : 0.f;
+        const float y = base + 1 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 1] : 0.f;
+        const float z = base + 2 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 2] : 0.f;
+        const float w4 = base + 3 < layers[i].joint_weights_count ? layers[i].joint_weights[base + 3] : 0.f;
+        w = ozz::math::simd_float4::Load(x, y, z, w4);
+      }
+      if (coverage) {
+        w = ozz::math::And(w, rt->mapped[(size_t)soa]);
+      }
+      dst[soa] = w;
     }
 
     inst->layer_has_joint_weights[i] = 1;
@@ -413,6 +1200,19 @@ void ozz_instance_set_layers(ozz_instance_t* inst, const ozz_layer_desc_t* layer
   }
 }
 
+void ozz_instance_set_ltm_mode(ozz_instance_t* inst, ozz_ltm_mode_t mode) {
+  if (!inst) return;
+  inst->ltm_mode = mode == OZZ_LTM_LEVEL_SOA ? OZZ_LTM_LEVEL_SOA : OZZ_LTM_DEPTH_FIRST;
+}
+
+ozz_result_t ozz_instance_set_bounds_mesh(ozz_instance_t* inst, const ozz_mesh_remap_t* mesh) {
+  ozz_clear_error();
+  if (!inst) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst");
+  if (mesh && mesh_remap_skeleton(mesh) != inst->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+  inst->bounds_mesh = mesh;
+  return OZZ_OK;
+}
+
 void ozz_instance_set_ik_jobs(ozz_instance_t* inst, const ozz_ik_job_t* jobs, int32_t count) {
   if (!inst) return;
   if (!jobs || count <= 0) { inst->ik_count = 0; return; }
@@ -422,9 +1222,14 @@ void ozz_instance_set_ik_jobs(ozz_instance_t* inst, const ozz_ik_job_t* jobs, in
 }
 
 size_t ozz_workspace_required_bytes(const ozz_skeleton_t* skel_h) {
+  return ozz_workspace_required_bytes_ex(skel_h, 0);
+}
+
+size_t ozz_workspace_required_bytes_ex(const ozz_skeleton_t* skel_h, int32_t max_tracks) {
   if (!skel_h) return 0;
   const int32_t n = (int32_t)skel_h->skel.num_joints();
   const int32_t ns = num_soa_from_joints(n);
+  const int32_t nst = num_soa_from_joints(clamp_max_tracks(skel_h, max_tracks));
 
   size_t bytes = 0;
   auto bump = [&](size_t sz, size_t al) { bytes = (bytes + (al - 1)) & ~(al - 1); bytes += sz; };
@@ -432,12 +1237,17 @@ size_t ozz_workspace_required_bytes(const ozz_skeleton_t* skel_h) {
   bump(sizeof(ozz_workspace_t), alignof(ozz_workspace_t));
   bump(sizeof(ozz::math::SoaTransform) * (size_t)(ns * OZZ_MAX_LAYERS), alignof(ozz::math::SoaTransform)); // sampled_normal
   bump(sizeof(ozz::math::SoaTransform) * (size_t)(ns * OZZ_MAX_LAYERS), alignof(ozz::math::SoaTransform)); // sampled_additive
+  bump(sizeof(ozz::math::SoaTransform) * (size_t)nst, alignof(ozz::math::SoaTransform));                  // retarget_source
   bump(sizeof(ozz::math::Float4x4) * (size_t)n, alignof(ozz::math::Float4x4));          // model
   bump(sizeof(float) * (size_t)(12 * n), alignof(float));                               // palette
   return bytes;
 }
 
 ozz_result_t ozz_workspace_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel_h, ozz_workspace_t** out_ws) {
+  return ozz_workspace_init_ex(mem, mem_bytes, skel_h, 0, out_ws);
+}
+
+ozz_result_t ozz_workspace_init_ex(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel_h, int32_t max_tracks, ozz_workspace_t** out_ws) {
   ozz_clear_error();
   if (!mem || !skel_h || !out_ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
 
@@ -458,6 +1268,10 @@ ozz_result_t ozz_workspace_init(void* mem, size_t mem_bytes, const ozz_skeleton_
   ws->sampled_additive = bump_alloc<ozz::math::SoaTransform>(cur, left, (size_t)(ws->num_soa * OZZ_MAX_LAYERS));
   if (!ws->sampled_additive) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mem too small (sampled_additive)");
 
+  ws->max_soa_tracks = num_soa_from_joints(clamp_max_tracks(skel_h, max_tracks));
+  ws->retarget_source = bump_alloc<ozz::math::SoaTransform>(cur, left, (size_t)ws->max_soa_tracks);
+  if (!ws->retarget_source) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mem too small (retarget_source)");
+
   ws->model = bump_alloc<ozz::math::Float4x4>(cur, left, (size_t)ws->num_joints);
   if (!ws->model) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mem too small (model)");
 
@@ -476,6 +1290,207 @@ void ozz_workspace_deinit(ozz_workspace_t* ws) {
 const float* ozz_workspace_palette_3x4(const ozz_workspace_t* ws) { return ws ? ws->palette : nullptr; }
 int32_t ozz_workspace_palette_floats(const ozz_workspace_t* ws) { return ws ? (12 * ws->num_joints) : 0; }
 
+ozz_result_t ozz_workspace_bounds(const ozz_workspace_t* ws, ozz_vec3_t* out_min, ozz_vec3_t* out_max) {
+  ozz_clear_error();
+  if (!ws || !out_min || !out_max) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  *out_min = {ws->bounds[0], ws->bounds[1], ws->bounds[2]};
+  *out_max = {ws->bounds[3], ws->bounds[4], ws->bounds[5]};
+  return OZZ_OK;
+}
+
+// ---- shared keyframe segments ----
+// Decompressed keyframes (ozz SamplingJob::Segment) of any clip and timepoint
+// interval, for every sampling job of the process while the cache is
+// installed. Slots come in sets of kSegmentWays: a key hashes to one set and
+// replaces its least recently used slot, so memory stays what the desc asked.
+// Readers take no lock. A slot's sequence is odd while it's written, and a job
+// sampled from a slot only counts if the sequence didn't move meanwhile;
+// otherwise it samples again with its own context. A slot is read with the
+// layout of the reader's clip, which fits the slot whatever it holds, so
+// racing a writer never reads outside of it. Writers publish under try_lock
+// and give up when another thread is publishing: no job ever waits. Lookup
+// counters are sharded per thread so that crowds don't all write one line.
+static constexpr int32_t kSegmentWays = 4;
+static constexpr uint32_t kSegmentCounterShards = 16;
+
+struct alignas(64) SegmentSlot {
+  std::atomic<uint32_t> sequence{0};
+  std::atomic<uint64_t> clip{0}; // ozz_animation_t::id, 0 when empty
+  std::atomic<uint32_t> interval{0};
+  std::atomic<uint64_t> last_use{0};
+  ozz::byte* data = nullptr;
+};
+
+struct alignas(64) SegmentCounters {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> conflicts{0};
+  std::atomic<uint64_t> bypasses{0};
+};
+
+struct ozz_segment_cache_t {
+  // Read-only once created.
+  size_t slot_bytes = 0;
+  int32_t num_sets = 0;
+  SegmentSlot* slots = nullptr; // num_sets * kSegmentWays
+  void* data = nullptr;
+  // Written by publishers.
+  alignas(64) std::mutex publish;
+  std::atomic<uint64_t> tick{0}; // bumped by each publish, stamps last_use
+  std::atomic<uint64_t> inserts{0};
+  std::atomic<uint64_t> evictions{0};
+  // Written by lookups, shard picked per thread.
+  SegmentCounters counters[kSegmentCounterShards];
+
+  ~ozz_segment_cache_t() {
+    if (slots) {
+      for (int32_t i = 0; i < num_sets * kSegmentWays; ++i) slots[i].~SegmentSlot();
+    }
+    ozz::memory::default_allocator()->Deallocate(slots);
+    ozz::memory::default_allocator()->Deallocate(data);
+  }
+};
+
+static std::atomic<ozz_segment_cache_t*> g_segment_cache{nullptr};
+
+ozz_result_t ozz_segment_cache_create(const ozz_segment_cache_desc_t* desc, ozz_segment_cache_t** out_cache) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!desc || !out_cache || desc->max_tracks <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "invalid args");
+  const size_t align = ozz::animation::SamplingJob::Context::kBufferAlignment;
+  const size_t slot_bytes = ozz::Align(ozz::animation::SamplingJob::Segment::RequiredBytes(desc->max_tracks), align);
+  const size_t num_sets = desc->budget_bytes / (slot_bytes * kSegmentWays);
+  if (num_sets == 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "budget below one set of slots");
+  if (num_sets > (size_t)std::numeric_limits<int32_t>::max() / kSegmentWays) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "budget too big");
+  }
+
+  auto* cache = alloc_with_ozz_allocator<ozz_segment_cache_t>();
+  if (!cache) return set_err(OZZ_ERR, "oom");
+  const size_t num_slots = num_sets * kSegmentWays;
+  cache->slots = (SegmentSlot*)ozz::memory::default_allocator()->Allocate(num_slots * sizeof(SegmentSlot),
+                                                                          alignof(SegmentSlot));
+  cache->data = ozz::memory::default_allocator()->Allocate(num_slots * slot_bytes, align);
+  if (!cache->slots || !cache->data) {
+    ozz::memory::default_allocator()->Deallocate(cache->slots);
+    cache->slots = nullptr;
+    free_with_ozz_allocator(cache);
+    return set_err(OZZ_ERR, "oom");
+  }
+  cache->slot_bytes = slot_bytes;
+  cache->num_sets = (int32_t)num_sets;
+  for (size_t i = 0; i < num_slots; ++i) {
+    new (&cache->slots[i]) SegmentSlot();
+    cache->slots[i].data = (ozz::byte*)cache->data + i * slot_bytes;
+  }
+  *out_cache = cache;
+  return OZZ_OK;
+}
+
+void ozz_segment_cache_destroy(ozz_segment_cache_t* cache) { free_with_ozz_allocator(cache); }
+
+void ozz_set_segment_cache(ozz_segment_cache_t* cache) { g_segment_cache.store(cache, std::memory_order_release); }
+
+ozz_segment_cache_t* ozz_segment_cache(void) { return g_segment_cache.load(std::memory_order_acquire); }
+
+static std::atomic<uint32_t> g_next_segment_shard{0};
+static thread_local uint32_t t_segment_shard =
+    g_next_segment_shard.fetch_add(1, std::memory_order_relaxed) % kSegmentCounterShards;
+
+static inline SegmentCounters& segment_counters(ozz_segment_cache_t* cache) {
+  return cache->counters[t_segment_shard];
+}
+
+void ozz_segment_cache_stats(const ozz_segment_cache_t* cache, ozz_segment_cache_stats_t* out) {
+  if (!out) return;
+  *out = {};
+  if (!cache) return;
+  for (const SegmentCounters& shard : cache->counters) {
+    out->hits += shard.hits.load(std::memory_order_relaxed);
+    out->misses += shard.misses.load(std::memory_order_relaxed);
+    out->conflicts += shard.conflicts.load(std::memory_order_relaxed);
+    out->bypasses += shard.bypasses.load(std::memory_order_relaxed);
+  }
+  out->inserts = cache->inserts.load(std::memory_order_relaxed);
+  out->evictions = cache->evictions.load(std::memory_order_relaxed);
+  out->slots = cache->num_sets * kSegmentWays;
+  out->bytes = (size_t)out->slots * cache->slot_bytes;
+}
+
+// Interval i of a clip runs from timepoints[i] up to timepoints[i + 1], the
+// last one including ratio 1.
+static inline uint32_t segment_interval(ozz::span<const float> timepoints, float ratio) {
+  const size_t after = (size_t)(std::upper_bound(timepoints.begin(), timepoints.end(), ratio) - timepoints.begin());
+  return (uint32_t)std::min(after > 0 ? after - 1 : 0, timepoints.size() - 2);
+}
+
+static inline SegmentSlot* segment_set(const ozz_segment_cache_t* cache, uint64_t clip, uint32_t interval) {
+  const uint64_t hash = (clip * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)interval * 0xC2B2AE3D27D4EB4Full);
+  return cache->slots + (size_t)((hash >> 32) % (uint64_t)cache->num_sets) * kSegmentWays;
+}
+
+// Runs job from a shared segment. False when there's none, or when it was
+// rewritten while sampling: the job then has to run with its context.
+static bool sample_shared_segment(ozz_segment_cache_t* cache, ozz::animation::SamplingJob* job, uint64_t clip,
+                                  uint32_t interval, bool* ok) {
+  SegmentSlot* set = segment_set(cache, clip, interval);
+  for (int32_t way = 0; way < kSegmentWays; ++way) {
+    SegmentSlot& slot = set[way];
+    const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if ((sequence & 1u) || slot.clip.load(std::memory_order_relaxed) != clip ||
+        slot.interval.load(std::memory_order_relaxed) != interval) {
+      continue;
+    }
+    const ozz::animation::SamplingJob::Segment segment =
+        ozz::animation::SamplingJob::Segment::View(*job->animation, {slot.data, cache->slot_bytes});
+    job->segment = &segment;
+    *ok = kernels()->sampling(job);
+    job->segment = nullptr;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      segment_counters(cache).conflicts.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    // Only the first hit after a publish writes the slot.
+    const uint64_t tick = cache->tick.load(std::memory_order_relaxed);
+    if (slot.last_use.load(std::memory_order_relaxed) != tick) slot.last_use.store(tick, std::memory_order_relaxed);
+    segment_counters(cache).hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  segment_counters(cache).misses.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+// Publishes the segment ctx just decompressed, over the set's least recently
+// used slot.
+static void publish_segment(ozz_segment_cache_t* cache, const ozz::animation::SamplingJob::Context& ctx,
+                            uint64_t clip, uint32_t interval) {
+  std::unique_lock<std::mutex> lock(cache->publish, std::try_to_lock);
+  if (!lock.owns_lock()) return;
+  SegmentSlot* set = segment_set(cache, clip, interval);
+  SegmentSlot* victim = set;
+  for (int32_t way = 0; way < kSegmentWays; ++way) {
+    SegmentSlot& slot = set[way];
+    if (slot.clip.load(std::memory_order_relaxed) == clip && slot.interval.load(std::memory_order_relaxed) == interval) {
+      return; // Published by another job meanwhile.
+    }
+    if (slot.last_use.load(std::memory_order_relaxed) < victim->last_use.load(std::memory_order_relaxed)) {
+      victim = &slot;
+    }
+  }
+
+  const uint32_t sequence = victim->sequence.load(std::memory_order_relaxed);
+  victim->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  if (victim->clip.load(std::memory_order_relaxed) != 0) cache->evictions.fetch_add(1, std::memory_order_relaxed);
+  victim->clip.store(clip, std::memory_order_relaxed);
+  victim->interval.store(interval, std::memory_order_relaxed);
+  ozz::animation::SamplingJob::Segment::Store(ctx.segment(), {victim->data, cache->slot_bytes});
+  victim->last_use.store(cache->tick.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  victim->sequence.store(sequence + 2, std::memory_order_release);
+  cache->inserts.fetch_add(1, std::memory_order_relaxed);
+}
+
 // ---- helpers ----
 static inline bool ratio_is_valid(float ratio) {
   return std::isfinite(ratio) && ratio >= 0.0f && ratio <= 1.0f;
@@ -494,40 +1509,69 @@ static inline ozz::math::SimdFloat4 load3(float x, float y, float z, float w) {
   return ozz::math::simd_float4::Load(x, y, z, w);
 }
 
-static inline ozz_result_t sample_into(ozz_instance_t* inst,
-                                       const ozz_animation_t* anim_h,
-                                       float ratio,
-                                       ozz::math::SoaTransform* out) {
-  if (!anim_h) return OZZ_ERR_INVALID_ARGUMENT;
-  if ((int32_t)anim_h->anim.num_tracks() != inst->num_joints) return OZZ_ERR_INVALID_ARGUMENT;
-  if (!ratio_is_valid(ratio)) return OZZ_ERR_INVALID_ARGUMENT;
-
+static inline ozz_result_t run_sampling_job(ozz::animation::SamplingJob::Context* ctx,
+                                            const ozz_animation_t* anim_h,
+                                            float ratio,
+                                            ozz::math::SoaTransform* out,
+                                            int32_t out_soa) {
   ozz::animation::SamplingJob job;
   job.animation = &anim_h->anim;
-  job.context = &inst->sampling_ctx;
+  job.context = ctx;
   job.ratio = ratio;
-  job.output = ozz::span<ozz::math::SoaTransform>(out, inst->num_soa);
+  job.output = ozz::span<ozz::math::SoaTransform>(out, out_soa);
+
+  // Clips with no keyframes to decompress skip the shared cache.
+  ozz_segment_cache_t* cache = g_segment_cache.load(std::memory_order_acquire);
+  const size_t segment_bytes = cache ? ozz::animation::SamplingJob::Segment::RequiredBytes(anim_h->anim) : 0;
+  if (segment_bytes == 0) return kernels()->sampling(&job) ? OZZ_OK : OZZ_ERR_OZZ;
+  if (segment_bytes > cache->slot_bytes) {
+    segment_counters(cache).bypasses.fetch_add(1, std::memory_order_relaxed);
+    return kernels()->sampling(&job) ? OZZ_OK : OZZ_ERR_OZZ;
+  }
 
-  return job.Run() ? OZZ_OK : OZZ_ERR_OZZ;
+  const uint32_t interval = segment_interval(anim_h->anim.timepoints(), std::clamp(ratio, 0.f, 1.f));
+  bool ok = false;
+  if (sample_shared_segment(cache, &job, anim_h->id, interval, &ok)) return ok ? OZZ_OK : OZZ_ERR_OZZ;
+  if (!kernels()->sampling(&job)) return OZZ_ERR_OZZ;
+  publish_segment(cache, *ctx, anim_h->id, interval);
+  return OZZ_OK;
 }
 
+// Samples a layer into `out` (num_soa target joints). Retargeted layers are
+// sampled into `scratch` on their source skeleton first, then converted.
 static inline ozz_result_t sample_into_context(int32_t num_joints,
                                                int32_t num_soa,
                                                ozz::animation::SamplingJob::Context* ctx,
-                                               const ozz_animation_t* anim_h,
-                                               float ratio,
+                                               const ozz_layer_desc_t& layer,
+                                               ozz::math::SoaTransform* scratch,
+                                               int32_t scratch_soa,
                                                ozz::math::SoaTransform* out) {
+  const ozz_animation_t* anim_h = layer.anim;
   if (!ctx || !anim_h) return OZZ_ERR_INVALID_ARGUMENT;
-  if ((int32_t)anim_h->anim.num_tracks() != num_joints) return OZZ_ERR_INVALID_ARGUMENT;
-  if (!ratio_is_valid(ratio)) return OZZ_ERR_INVALID_ARGUMENT;
+  if (!ratio_is_valid(layer.ratio)) return OZZ_ERR_INVALID_ARGUMENT;
 
-  ozz::animation::SamplingJob job;
-  job.animation = &anim_h->anim;
-  job.context = ctx;
-  job.ratio = ratio;
-  job.output = ozz::span<ozz::math::SoaTransform>(out, num_soa);
+  const ozz_retarget_t* rt = layer.retarget;
+  if (!rt) {
+    if ((int32_t)anim_h->anim.num_tracks() != num_joints) return OZZ_ERR_INVALID_ARGUMENT;
+    return run_sampling_job(ctx, anim_h, layer.ratio, out, num_soa);
+  }
+
+  if (rt->target_joints != num_joints) return OZZ_ERR_INVALID_ARGUMENT;
+  if ((int32_t)anim_h->anim.num_tracks() != rt->source_tracks) return OZZ_ERR_INVALID_ARGUMENT;
+  if (rt->source_soa > scratch_soa || rt->source_soa > ctx->max_soa_tracks()) return OZZ_ERR_INVALID_ARGUMENT;
+
+  ozz_result_t r = run_sampling_job(ctx, anim_h, layer.ratio, scratch, rt->source_soa);
+  if (r != OZZ_OK) return r;
+  retarget_pose(rt, scratch, layer.mode == OZZ_LAYER_ADDITIVE, out);
+  return OZZ_OK;
+}
 
-  return job.Run() ? OZZ_OK : OZZ_ERR_OZZ;
+static inline ozz_result_t sample_into(ozz_instance_t* inst,
+                                       ozz_workspace_t* ws,
+                                       const ozz_layer_desc_t& layer,
+                                       ozz::math::SoaTransform* out) {
+  return sample_into_context(inst->num_joints, inst->num_soa, &inst->sampling_ctx, layer,
+                             ws->retarget_source, ws->max_soa_tracks, out);
 }
 
 static inline bool should_skip_layer(const ozz_layer_desc_t& layer) {
@@ -536,14 +1580,27 @@ static inline bool should_skip_layer(const ozz_layer_desc_t& layer) {
   return false;
 }
 
-static inline ozz_result_t locals_to_model(const ozz_instance_t* inst,
-                                           const ozz::math::SoaTransform* locals,
-                                           ozz::math::Float4x4* out_model) {
+static inline ozz_result_t upstream_locals_to_model(const ozz_instance_t* inst,
+                                                    const ozz::math::SoaTransform* locals,
+                                                    ozz::math::Float4x4* out_model) {
   ozz::animation::LocalToModelJob job;
   job.skeleton = inst->skel;
   job.input = ozz::span<const ozz::math::SoaTransform>(locals, inst->num_soa);
   job.output = ozz::span<ozz::math::Float4x4>(out_model, inst->num_joints);
-  return job.Run() ? OZZ_OK : OZZ_ERR_OZZ;
+  return kernels()->local_to_model(&job) ? OZZ_OK : OZZ_ERR_OZZ;
+}
+
+static inline ozz_result_t locals_to_model(const ozz_instance_t* inst,
+                                           const ozz::math::SoaTransform* locals,
+                                           ozz::math::Float4x4* out_model) {
+  if (inst->ltm_mode == OZZ_LTM_LEVEL_SOA) {
+    const ozz_ltm_levels_t& levels = *inst->levels;
+    const cozz_ltm_levels_view_t view = {levels.num_groups, levels.joints.data(), levels.parents.data(),
+                                         levels.local_offsets.data(), levels.lanes.data()};
+    kernels()->level_local_to_model(&view, reinterpret_cast<const float*>(locals), reinterpret_cast<float*>(out_model));
+    return OZZ_OK;
+  }
+  return upstream_locals_to_model(inst, locals, out_model);
 }
 
 // Apply a SimdQuaternion correction to a single joint lane in SoA locals.
@@ -587,13 +1644,419 @@ static inline void apply_joint_rotation_correction(
   locals[soa].rotation.w = ozz::math::simd_float4::LoadPtr(ws);
 }
 
-// ---- main eval ----
-ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
+// ---- bounds ----
+static inline void store_bounds(ozz_workspace_t* ws, ozz::math::SimdFloat4 min, ozz::math::SimdFloat4 max) {
+  ozz::math::Store3PtrU(min, ws->bounds + 0);
+  ozz::math::Store3PtrU(max, ws->bounds + 3);
+}
+
+static void store_palette_and_bounds(const ozz_instance_t* inst, const ozz_workspace_t* ws, float* palette,
+                                     size_t joint_stride, float* bounds6) {
+  kernels()->store_palette(reinterpret_cast<const float*>(ws->model), inst->num_joints, palette, joint_stride, bounds6);
+  if (inst->bounds_mesh) {
+    ozz::math::SimdFloat4 min = load3(bounds6[0], bounds6[1], bounds6[2], 0.f);
+    ozz::math::SimdFloat4 max = load3(bounds6[3], bounds6[4], bounds6[5], 0.f);
+    mesh_bounds(inst->bounds_mesh, ws->model, &min, &max);
+    ozz::math::Store3PtrU(min, bounds6 + 0);
+    ozz::math::Store3PtrU(max, bounds6 + 3);
+  }
+}
+
+// ---- baked model-space clips ----
+// Frames hold each joint's model matrix as 16 quantized floats, float k
+// decoding as q * scale[k] + offset[k] (k = column * 4 + lane). Columns are
+// interleaved in pairs, lane i of column 2p at 8p + 2i and of column 2p + 1 at
+// 8p + 2i + 1, so a joint is two 4 x int32 loads whose low and high halves are
+// the four columns. The w lanes quantize to scale 0 but keep their slots, as
+// zeros: a joint takes 32 bytes per frame, of which 24 hold the 3x4 matrix,
+// so that its two loads stay 16-byte aligned.
+struct ozz_baked_clip_t {
+  int32_t num_joints = 0;
+  int32_t num_frames = 0;
+  float duration = 0.f;
+  float scale[16] = {};
+  float offset[16] = {};
+  ozz::vector<int16_t> frames; // [num_frames][num_joints][16]
+};
+
+static constexpr size_t baked_slot(int k) { return (size_t)((k >> 3) * 8 + (k & 3) * 2 + ((k >> 2) & 1)); }
+
+static const char kBakedClipTag[8] = {'c', 'o', 'z', 'z', 'b', 'a', 'k', 'e'};
+static constexpr int32_t kBakedClipVersion = 1;
+static constexpr int32_t kBakedClipMaxFrames = 1 << 20;
+
+ozz_result_t ozz_baked_clip_create(const ozz_skeleton_t* skel_h, const ozz_animation_t* anim_h, float frame_rate,
+                                   ozz_baked_clip_t** out_clip) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!skel_h || !anim_h || !out_clip) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (!std::isfinite(frame_rate) || frame_rate <= 0.f) return set_err(OZZ_ERR_INVALID_ARGUMENT, "frame_rate must be positive");
+  const ozz::animation::Skeleton& skel = skel_h->skel;
+  const ozz::animation::Animation& anim = anim_h->anim;
+  if (anim.num_tracks() != skel.num_joints()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "clip tracks do not match skeleton");
+  const double frames = std::ceil((double)anim.duration() * (double)frame_rate) + 1.0;
+  if (frames > (double)kBakedClipMaxFrames) return set_err(OZZ_ERR_INVALID_ARGUMENT, "too many frames");
+  const int32_t num_frames = std::max(2, (int32_t)frames);
+  const int32_t n = (int32_t)skel.num_joints();
+
+  // Float matrices first, quantized once every float's range is known.
+  ozz::vector<float> matrices((size_t)num_frames * (size_t)n * 16u);
+  ozz::animation::SamplingJob::Context ctx(anim.num_tracks());
+  ozz::vector<ozz::math::SoaTransform> locals((size_t)skel.num_soa_joints());
+  ozz::vector<ozz::math::Float4x4> models((size_t)n);
+  for (int32_t f = 0; f < num_frames; ++f) {
+    ozz::animation::SamplingJob sampling;
+    sampling.animation = &anim;
+    sampling.context = &ctx;
+    sampling.ratio = (float)f / (float)(num_frames - 1);
+    sampling.output = ozz::make_span(locals);
+    if (!sampling.Run()) return set_err(OZZ_ERR_OZZ, "SamplingJob failed");
+    ozz::animation::LocalToModelJob ltm;
+    ltm.skeleton = &skel;
+    ltm.input = ozz::make_span(locals);
+    ltm.output = ozz::make_span(models);
+    if (!ltm.Run()) return set_err(OZZ_ERR_OZZ, "LocalToModelJob failed");
+    for (int32_t j = 0; j < n; ++j) {
+      float* m = &matrices[((size_t)f * (size_t)n + (size_t)j) * 16u];
+      for (int c = 0; c < 4; ++c) ozz::math::StorePtrU(models[(size_t)j].cols[c], m + 4 * c);
+    }
+  }
+
+  auto* clip = alloc_with_ozz_allocator<ozz_baked_clip_t>();
+  if (!clip) return set_err(OZZ_ERR, "oom");
+  clip->num_joints = n;
+  clip->num_frames = num_frames;
+  clip->duration = anim.duration();
+  for (int k = 0; k < 16; ++k) {
+    float lo = std::numeric_limits<float>::max();
+    float hi = -lo;
+    for (size_t i = (size_t)k; i < matrices.size(); i += 16u) {
+      lo = std::min(lo, matrices[i]);
+      hi = std::max(hi, matrices[i]);
+    }
+    clip->offset[k] = (lo + hi) * .5f;
+    clip->scale[k] = (hi - lo) * .5f / 32767.f;
+  }
+  clip->frames.resize(matrices.size());
+  for (size_t i = 0; i < matrices.size(); i += 16u) {
+    for (int k = 0; k < 16; ++k) {
+      const float scale = clip->scale[k];
+      const long q = scale > 0.f ? std::lround((matrices[i + (size_t)k] - clip->offset[k]) / scale) : 0;
+      clip->frames[i + baked_slot(k)] = (int16_t)std::clamp(q, -32767l, 32767l);
+    }
+  }
+  *out_clip = clip;
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_baked_clip_save_to_file(const ozz_baked_clip_t* clip, const char* path) {
   ozz_clear_error();
+  if (!clip || !path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "wb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::OArchive ar(&file);
+  ar << ozz::io::MakeArray(kBakedClipTag);
+  ar << kBakedClipVersion;
+  ar << clip->num_joints;
+  ar << clip->num_frames;
+  ar << clip->duration;
+  ar << ozz::io::MakeArray(clip->scale);
+  ar << ozz::io::MakeArray(clip->offset);
+  ar << ozz::io::MakeArray(clip->frames.data(), clip->frames.size());
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_baked_clip_load_from_file(const char* path, ozz_baked_clip_t** out_clip) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!path || !out_clip) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "rb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::IArchive ar(&file);
+
+  char tag[sizeof(kBakedClipTag)] = {};
+  int32_t version = 0;
+  if (file.Size() < sizeof(tag) + sizeof(version)) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> ozz::io::MakeArray(tag);
+  if (std::memcmp(tag, kBakedClipTag, sizeof(tag)) != 0) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> version;
+  if (version != kBakedClipVersion) return set_err(OZZ_ERR_OZZ, "unsupported baked clip version");
+
+  auto* clip = alloc_with_ozz_allocator<ozz_baked_clip_t>();
+  if (!clip) return set_err(OZZ_ERR, "oom");
+  ar >> clip->num_joints;
+  ar >> clip->num_frames;
+  ar >> clip->duration;
+  const size_t count = (size_t)std::max(clip->num_joints, 0) * (size_t)std::max(clip->num_frames, 0) * 16u;
+  const size_t header = sizeof(clip->scale) + sizeof(clip->offset);
+  if (clip->num_joints <= 0 || clip->num_frames < 2 || clip->num_frames > kBakedClipMaxFrames ||
+      file.Size() - file.Tell() < header + count * sizeof(int16_t)) {
+    free_with_ozz_allocator(clip);
+    return set_err(OZZ_ERR_OZZ, "corrupt baked clip");
+  }
+  ar >> ozz::io::MakeArray(clip->scale);
+  ar >> ozz::io::MakeArray(clip->offset);
+  clip->frames.resize(count);
+  ar >> ozz::io::MakeArray(clip->frames.data(), count);
+  *out_clip = clip;
+  return OZZ_OK;
+}
+
+void ozz_baked_clip_destroy(ozz_baked_clip_t* clip) { free_with_ozz_allocator(clip); }
+
+int32_t ozz_baked_clip_num_joints(const ozz_baked_clip_t* clip) { return clip ? clip->num_joints : 0; }
+int32_t ozz_baked_clip_num_frames(const ozz_baked_clip_t* clip) { return clip ? clip->num_frames : 0; }
+float ozz_baked_clip_duration(const ozz_baked_clip_t* clip) { return clip ? clip->duration : 0.f; }
+
+// Decodes the frame at ratio, or a lerp of the two around it, into models.
+// Sign-extending the halves of each int32 lane relies on little-endian int16
+// pairs, as does the rest of the runtime's in-memory data.
+static void sample_baked_clip(const ozz_baked_clip_t& clip, float ratio, bool nearest, ozz::math::Float4x4* models) {
+  using namespace ozz::math;
+  const float position = ratio * (float)(clip.num_frames - 1);
+  int32_t frame = std::min((int32_t)position, clip.num_frames - 2);
+  float alpha = position - (float)frame;
+  if (nearest) {
+    if (alpha >= .5f) ++frame;
+    alpha = 0.f;
+  }
+  const size_t frame_values = (size_t)clip.num_joints * 16u;
+  const int16_t* a = clip.frames.data() + (size_t)frame * frame_values;
+
+  SimdFloat4 scale[4];
+  SimdFloat4 offset[4];
+  for (int c = 0; c < 4; ++c) {
+    scale[c] = simd_float4::LoadPtrU(clip.scale + 4 * c);
+    offset[c] = simd_float4::LoadPtrU(clip.offset + 4 * c);
+  }
+  auto decode = [&](const int16_t* q, Float4x4* out) {
+    const int* lanes = reinterpret_cast<const int*>(q);
+    for (int p = 0; p < 2; ++p) {
+      const SimdInt4 v = simd_int4::LoadPtrU(lanes + 4 * p);
+      out->cols[2 * p] = simd_float4::FromInt(ShiftR(ShiftL(v, 16), 16)) * scale[2 * p] + offset[2 * p];
+      out->cols[2 * p + 1] = simd_float4::FromInt(ShiftR(v, 16)) * scale[2 * p + 1] + offset[2 * p + 1];
+    }
+  };
+  if (alpha <= 0.f) {
+    for (int32_t j = 0; j < clip.num_joints; ++j) decode(a + (size_t)j * 16u, &models[j]);
+    return;
+  }
+  const SimdFloat4 t = simd_float4::Load1(alpha);
+  for (int32_t j = 0; j < clip.num_joints; ++j) {
+    Float4x4 next;
+    decode(a + (size_t)j * 16u, &models[j]);
+    decode(a + frame_values + (size_t)j * 16u, &next);
+    for (int c = 0; c < 4; ++c) models[j].cols[c] = Lerp(models[j].cols[c], next.cols[c], t);
+  }
+}
+
+// A baked layer replaces the whole eval: ws->model comes from the clip.
+static ozz_result_t eval_baked(ozz_instance_t* inst, ozz_workspace_t* ws, float* palette, size_t joint_stride,
+                               float* bounds6) {
+  if (!ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst/ws");
+  if (inst->skel != ws->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+  if (inst->layer_count != 1 || inst->ik_count > 0) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "baked layers evaluate alone, without IK");
+  }
+  const ozz_layer_desc_t& layer = inst->layers[0];
+  if (layer.baked->num_joints != inst->num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "baked clip joint count mismatch");
+  if (!ratio_is_valid(layer.ratio)) return set_err(OZZ_ERR_INVALID_ARGUMENT, "ratio must be finite and within [0, 1]");
+  sample_baked_clip(*layer.baked, layer.ratio, layer.baked_nearest != 0, ws->model);
+  store_palette_and_bounds(inst, ws, palette, joint_stride, bounds6);
+  return OZZ_OK;
+}
+
+// ---- animation libraries ----
+// Constant SoA track values of every clip, pooled per component. Clips are
+// ozz animations loaded with LoadShared: their constant tracks hold entries
+// into these vectors, which never change once the library is built.
+struct ozz_library_t {
+  ozz::vector<ozz::math::SoaFloat3> translations;
+  ozz::vector<ozz::math::SoaQuaternion> rotations;
+  ozz::vector<ozz::math::SoaFloat3> scales;
+  ozz::vector<ozz_animation_t> clips;
+};
+
+static const char kLibraryTag[8] = {'c', 'o', 'z', 'z', 'l', 'i', 'b', 'r'};
+static constexpr int32_t kLibraryVersion = 1;
+
+// Values are pooled by their bytes: FNV-1a finds the candidate, memcmp
+// confirms it. A colliding value just gets an entry of its own.
+template <typename T>
+struct LibraryPoolBuilder {
+  ozz::vector<T>* values;
+  ozz::unordered_map<uint64_t, uint32_t> index;
+
+  uint32_t add(const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(T); ++i) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    const auto it = index.find(hash);
+    if (it != index.end() && std::memcmp(&(*values)[it->second], &value, sizeof(T)) == 0) return it->second;
+    const uint32_t entry = (uint32_t)values->size();
+    values->push_back(value);
+    if (it == index.end()) index.emplace(hash, entry);
+    return entry;
+  }
+
+  // Pool entries of a clip component's constant tracks, whether the clip owns
+  // its constants or reads them from another library.
+  void add_constants(const ozz::animation::Animation::KeyframesCtrlConst& ctrl, ozz::span<const T> constants,
+                     ozz::vector<uint32_t>* entries) {
+    entries->resize(ctrl.constant_soa_tracks.size());
+    for (size_t i = 0; i < entries->size(); ++i) {
+      (*entries)[i] = add(constants[ctrl.constant_entries.empty() ? i : ctrl.constant_entries[i]]);
+    }
+  }
+};
+
+static ozz::animation::Animation::ConstantPool library_pool(ozz_library_t* lib) {
+  return {ozz::make_span(lib->translations), ozz::make_span(lib->rotations), ozz::make_span(lib->scales)};
+}
+
+// Entries of a library clip, as loaded.
+static ozz::animation::Animation::ConstantEntries library_entries(const ozz::animation::Animation& anim) {
+  return {anim.translations_ctrl().constant_entries, anim.rotations_ctrl().constant_entries,
+          anim.scales_ctrl().constant_entries};
+}
+
+ozz_result_t ozz_library_create(const ozz_animation_t* const* clips, int32_t count, ozz_library_t** out_lib) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!clips || count <= 0 || !out_lib) return set_err(OZZ_ERR_INVALID_ARGUMENT, "invalid args");
+  for (int32_t i = 0; i < count; ++i) {
+    if (!clips[i]) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null clip");
+  }
+
+  auto* lib = alloc_with_ozz_allocator<ozz_library_t>();
+  if (!lib) return set_err(OZZ_ERR, "oom");
+  LibraryPoolBuilder<ozz::math::SoaFloat3> translations{&lib->translations, {}};
+  LibraryPoolBuilder<ozz::math::SoaQuaternion> rotations{&lib->rotations, {}};
+  LibraryPoolBuilder<ozz::math::SoaFloat3> scales{&lib->scales, {}};
+
+  // Clips go through their shared form, which the pool must be complete to
+  // load back.
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive ar(&stream);
+    ozz::vector<uint32_t> t_entries, r_entries, s_entries;
+    for (int32_t i = 0; i < count; ++i) {
+      const ozz::animation::Animation& anim = clips[i]->anim;
+      translations.add_constants(anim.translations_ctrl(), anim.translations_constants(), &t_entries);
+      rotations.add_constants(anim.rotations_ctrl(), anim.rotations_constants(), &r_entries);
+      scales.add_constants(anim.scales_ctrl(), anim.scales_constants(), &s_entries);
+      anim.SaveShared(ar, {ozz::make_span(t_entries), ozz::make_span(r_entries), ozz::make_span(s_entries)});
+    }
+  }
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive ar(&stream);
+  lib->clips.resize((size_t)count);
+  for (ozz_animation_t& clip : lib->clips) {
+    if (!clip.anim.LoadShared(ar, library_pool(lib))) {
+      free_with_ozz_allocator(lib);
+      return set_err(OZZ_ERR_OZZ, "clip failed to pool");
+    }
+  }
+  *out_lib = lib;
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_library_save_to_file(const ozz_library_t* lib, const char* path) {
+  ozz_clear_error();
+  if (!lib || !path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "wb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::OArchive ar(&file);
+  ar << ozz::io::MakeArray(kLibraryTag);
+  ar << kLibraryVersion;
+  ar << (uint32_t)lib->translations.size();
+  ar << (uint32_t)lib->rotations.size();
+  ar << (uint32_t)lib->scales.size();
+  ar << (uint32_t)lib->clips.size();
+  ar << ozz::io::MakeArray(lib->translations.data(), lib->translations.size());
+  ar << ozz::io::MakeArray(lib->rotations.data(), lib->rotations.size());
+  ar << ozz::io::MakeArray(lib->scales.data(), lib->scales.size());
+  for (const ozz_animation_t& clip : lib->clips) clip.anim.SaveShared(ar, library_entries(clip.anim));
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_library_load_from_file(const char* path, ozz_library_t** out_lib) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!path || !out_lib) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "rb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::IArchive ar(&file);
+
+  char tag[sizeof(kLibraryTag)] = {};
+  int32_t version = 0;
+  if (file.Size() < sizeof(tag) + sizeof(version)) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> ozz::io::MakeArray(tag);
+  if (std::memcmp(tag, kLibraryTag, sizeof(tag)) != 0) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> version;
+  if (version != kLibraryVersion) return set_err(OZZ_ERR_OZZ, "unsupported library version");
+
+  uint32_t t_count = 0, r_count = 0, s_count = 0, clip_count = 0;
+  ar >> t_count;
+  ar >> r_count;
+  ar >> s_count;
+  ar >> clip_count;
+  const size_t pool_bytes = ((size_t)t_count + s_count) * sizeof(ozz::math::SoaFloat3) +
+                            (size_t)r_count * sizeof(ozz::math::SoaQuaternion);
+  if (clip_count == 0 || file.Size() - file.Tell() < pool_bytes + clip_count) {
+    return set_err(OZZ_ERR_OZZ, "corrupt library");
+  }
+
+  auto* lib = alloc_with_ozz_allocator<ozz_library_t>();
+  if (!lib) return set_err(OZZ_ERR, "oom");
+  lib->translations.resize(t_count);
+  lib->rotations.resize(r_count);
+  lib->scales.resize(s_count);
+  ar >> ozz::io::MakeArray(lib->translations.data(), lib->translations.size());
+  ar >> ozz::io::MakeArray(lib->rotations.data(), lib->rotations.size());
+  ar >> ozz::io::MakeArray(lib->scales.data(), lib->scales.size());
+  lib->clips.resize(clip_count);
+  for (ozz_animation_t& clip : lib->clips) {
+    if (!clip.anim.LoadShared(ar, library_pool(lib))) {
+      free_with_ozz_allocator(lib);
+      return set_err(OZZ_ERR_OZZ, "corrupt library clip");
+    }
+  }
+  *out_lib = lib;
+  return OZZ_OK;
+}
+
+void ozz_library_destroy(ozz_library_t* lib) { free_with_ozz_allocator(lib); }
+
+int32_t ozz_library_num_clips(const ozz_library_t* lib) { return lib ? (int32_t)lib->clips.size() : 0; }
+
+const ozz_animation_t* ozz_library_clip(const ozz_library_t* lib, int32_t index) {
+  if (!lib || index < 0 || index >= (int32_t)lib->clips.size()) return nullptr;
+  return &lib->clips[(size_t)index];
+}
+
+int32_t ozz_library_pool_entries(const ozz_library_t* lib) {
+  return lib ? (int32_t)(lib->translations.size() + lib->rotations.size() + lib->scales.size()) : 0;
+}
+
+size_t ozz_library_size_bytes(const ozz_library_t* lib) {
+  if (!lib) return 0;
+  size_t bytes = sizeof(*lib) + lib->translations.size() * sizeof(ozz::math::SoaFloat3) +
+                 lib->rotations.size() * sizeof(ozz::math::SoaQuaternion) +
+                 lib->scales.size() * sizeof(ozz::math::SoaFloat3);
+  for (const ozz_animation_t& clip : lib->clips) bytes += clip.anim.size();
+  return bytes;
+}
+
+// ---- main eval ----
+// Steps 1-3 of an eval: sample, blend and IK into inst->accum.
+static ozz_result_t eval_locals(ozz_instance_t* inst, ozz_workspace_t* ws) {
   if (!inst || !ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst/ws");
   if (inst->skel != ws->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
   if (inst->num_joints != ws->num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "size mismatch");
   if (inst->layer_count <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no layers");
+  if (inst->baked_layer_count > 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "baked layers only go through full evals");
 
   ozz::animation::BlendingJob::Layer normal_layers[OZZ_MAX_LAYERS];
   ozz::animation::BlendingJob::Layer additive_layers[OZZ_MAX_LAYERS];
@@ -607,7 +2070,7 @@ ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
     if (L.mode == OZZ_LAYER_ADDITIVE) {
       if (additive_count >= OZZ_MAX_LAYERS) continue;
       ozz::math::SoaTransform* dst = ws->sampled_additive + (size_t)additive_count * (size_t)inst->num_soa;
-      ozz_result_t r = sample_into(inst, L.anim, L.ratio, dst);
+      ozz_result_t r = sample_into(inst, ws, L, dst);
       if (r != OZZ_OK) return set_err(r, "sample failed");
 
       additive_layers[additive_count].transform = ozz::span<const ozz::math::SoaTransform>(dst, inst->num_soa);
@@ -619,7 +2082,7 @@ ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
     } else {
       if (normal_count >= OZZ_MAX_LAYERS) continue;
       ozz::math::SoaTransform* dst = ws->sampled_normal + (size_t)normal_count * (size_t)inst->num_soa;
-      ozz_result_t r = sample_into(inst, L.anim, L.ratio, dst);
+      ozz_result_t r = sample_into(inst, ws, L, dst);
       if (r != OZZ_OK) return set_err(r, "sample failed");
 
       normal_layers[normal_count].transform = ozz::span<const ozz::math::SoaTransform>(dst, inst->num_soa);
@@ -642,7 +2105,7 @@ ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
   blend_job.output = ozz::span<ozz::math::SoaTransform>(inst->accum, inst->num_soa);
 
   if (!blend_job.Validate()) return set_err(OZZ_ERR_OZZ, "blend validate failed");
-  if (!blend_job.Run()) return set_err(OZZ_ERR_OZZ, "blend run failed");
+  if (!kernels()->blending(&blend_job)) return set_err(OZZ_ERR_OZZ, "blend run failed");
 
   // 3) IK
   if (inst->ik_count > 0) {
@@ -714,16 +2177,490 @@ ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
     }
   }
 
+  return OZZ_OK;
+}
+
+static ozz_result_t eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws, float* palette, size_t joint_stride,
+                                   float* bounds6) {
+  if (inst && inst->baked_layer_count > 0) return eval_baked(inst, ws, palette, joint_stride, bounds6);
+  ozz_result_t r = eval_locals(inst, ws);
+  if (r != OZZ_OK) return r;
+
   // 4) final LTM + palette
-  {
-    ozz_result_t r = locals_to_model(inst, inst->accum, ws->model);
-    if (r != OZZ_OK) return set_err(r, "ltm failed");
+  r = locals_to_model(inst, inst->accum, ws->model);
+  if (r != OZZ_OK) return set_err(r, "ltm failed");
+
+  store_palette_and_bounds(inst, ws, palette, joint_stride, bounds6);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst/ws");
+  return eval_model_3x4(inst, ws, ws->palette, 12u, ws->bounds);
+}
+
+ozz_result_t ozz_eval_model_3x4_into(ozz_instance_t* inst, ozz_workspace_t* ws, float* out_palette, size_t joint_stride) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!ws || !out_palette) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null ws/out_palette");
+  if (joint_stride < 12u) return set_err(OZZ_ERR_INVALID_ARGUMENT, "joint stride below 12 floats");
+  return eval_model_3x4(inst, ws, out_palette, joint_stride, ws->bounds);
+}
+
+// ---- update-rate LOD ----
+static std::atomic<uint32_t> g_next_update_phase{0};
+
+size_t ozz_update_history_required_bytes(const ozz_skeleton_t* skel_h) {
+  if (!skel_h) return 0;
+  return sizeof(float) * 24u * (size_t)skel_h->skel.num_joints();
+}
+
+ozz_result_t ozz_instance_set_update_rate(ozz_instance_t* inst, int32_t interval, int32_t phase,
+                                          ozz_update_mode_t mode, void* history_mem, size_t history_bytes) {
+  ozz_clear_error();
+  if (!inst) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst");
+  if (interval < 1 || phase >= interval) return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad interval/phase");
+  if (mode != OZZ_UPDATE_INTERPOLATE && mode != OZZ_UPDATE_EXTRAPOLATE_ROOT) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad update mode");
+  }
+  if (interval > 1 && (!history_mem || history_bytes < sizeof(float) * 24u * (size_t)inst->num_joints)) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "history mem too small");
+  }
+  if (phase < 0) phase = (int32_t)(g_next_update_phase.fetch_add(1, std::memory_order_relaxed) % (uint32_t)interval);
+
+  inst->update_interval = interval;
+  inst->update_phase = phase;
+  inst->update_mode = mode;
+  inst->history = interval > 1 ? static_cast<float*>(history_mem) : nullptr;
+  inst->history_count = 0;
+  inst->history_newest = 0;
+  return OZZ_OK;
+}
+
+static inline bool update_due(const ozz_instance_t* inst, uint64_t frame) {
+  if (inst->update_interval <= 1 || inst->history_count == 0) return true;
+  const uint64_t last = inst->history_frame[inst->history_newest];
+  if (frame == last) return false;
+  // Rewound, or the scheduled frame was skipped.
+  if (frame < last || frame - last >= (uint64_t)inst->update_interval) return true;
+  return frame % (uint64_t)inst->update_interval == (uint64_t)inst->update_phase;
+}
+
+int32_t ozz_instance_update_due(const ozz_instance_t* inst, uint64_t frame) {
+  return inst && update_due(inst, frame) ? 1 : 0;
+}
+
+// Palette of `frame` from the history: a lerp of the last two full evals, or
+// the newest one shifted by the root velocity. With a single full eval both
+// modes hold it.
+static void store_history_palette(const ozz_instance_t* inst, uint64_t frame, float* palette, size_t joint_stride,
+                                  float* bounds6) {
+  using namespace ozz::math;
+  const size_t floats = (size_t)inst->num_joints * 12u;
+  const int32_t newest = inst->history_newest;
+  const int32_t older = inst->history_count > 1 ? 1 - newest : newest;
+  const float* b = inst->history + (size_t)newest * floats;
+  const float* a = inst->history + (size_t)older * floats;
+  const float* bounds_b = inst->history_bounds[newest];
+  const float* bounds_a = inst->history_bounds[older];
+
+  const uint64_t span = inst->history_frame[newest] - inst->history_frame[older];
+  const float progress = span ? (float)(frame - inst->history_frame[newest]) / (float)span : 0.f;
+  float alpha = 1.f;
+  float offset[3] = {0.f, 0.f, 0.f};
+  if (inst->update_mode == OZZ_UPDATE_INTERPOLATE) {
+    alpha = progress < 1.f ? progress : 1.f;
+  } else {
+    for (int k = 0; k < 3; ++k) offset[k] = (b[9 + k] - a[9 + k]) * progress;
+    a = b;
+    bounds_a = bounds_b;
+  }
+
+  // 12 floats per joint as three float4s; the translation is lanes 1-3 of the last.
+  const SimdFloat4 t = simd_float4::Load1(alpha);
+  const SimdFloat4 shift = simd_float4::Load(0.f, offset[0], offset[1], offset[2]);
+  for (int32_t j = 0; j < inst->num_joints; ++j) {
+    const float* ja = a + (size_t)j * 12u;
+    const float* jb = b + (size_t)j * 12u;
+    float* out12 = palette + (size_t)j * joint_stride;
+    StorePtrU(Lerp(simd_float4::LoadPtrU(ja + 0), simd_float4::LoadPtrU(jb + 0), t), out12 + 0);
+    StorePtrU(Lerp(simd_float4::LoadPtrU(ja + 4), simd_float4::LoadPtrU(jb + 4), t), out12 + 4);
+    StorePtrU(Lerp(simd_float4::LoadPtrU(ja + 8), simd_float4::LoadPtrU(jb + 8), t) + shift, out12 + 8);
+  }
+  for (int k = 0; k < 3; ++k) {
+    bounds6[k] = bounds_a[k] + (bounds_b[k] - bounds_a[k]) * alpha + offset[k];
+    bounds6[3 + k] = bounds_a[3 + k] + (bounds_b[3 + k] - bounds_a[3 + k]) * alpha + offset[k];
+  }
+}
+
+// ws->model of a palette, so that the outputs reading the model matrices (dual
+// quaternions, mesh palettes) agree with it.
+static void palette_to_models(const float* palette, int32_t num_joints, ozz::math::Float4x4* models) {
+  using namespace ozz::math;
+  for (int32_t j = 0; j < num_joints; ++j) {
+    const float* in12 = palette + (size_t)j * 12u;
+    models[j].cols[0] = simd_float4::Load(in12[0], in12[1], in12[2], 0.f);
+    models[j].cols[1] = simd_float4::Load(in12[3], in12[4], in12[5], 0.f);
+    models[j].cols[2] = simd_float4::Load(in12[6], in12[7], in12[8], 0.f);
+    models[j].cols[3] = simd_float4::Load(in12[9], in12[10], in12[11], 1.f);
+  }
+}
+
+// Full eval into the history when due, then the frame's palette from it.
+// Instances without an update rate evaluate straight into the output.
+static ozz_result_t eval_model_3x4_at(ozz_instance_t* inst, ozz_workspace_t* ws, uint64_t frame, float* palette,
+                                      size_t joint_stride, float* bounds6) {
+  if (!inst || inst->update_interval <= 1) return eval_model_3x4(inst, ws, palette, joint_stride, bounds6);
+  if (update_due(inst, frame)) {
+    if (inst->history_count > 0 && frame < inst->history_frame[inst->history_newest]) inst->history_count = 0;
+    const int32_t slot = inst->history_count == 0 ? 0 : 1 - inst->history_newest;
+    float* slot_palette = inst->history + (size_t)slot * (size_t)inst->num_joints * 12u;
+    ozz_result_t r = eval_model_3x4(inst, ws, slot_palette, 12u, inst->history_bounds[slot]);
+    if (r != OZZ_OK) return r;
+    inst->history_frame[slot] = frame;
+    inst->history_newest = slot;
+    if (inst->history_count < 2) ++inst->history_count;
+  } else if (inst->skel != ws->skel) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+  }
+  store_history_palette(inst, frame, palette, joint_stride, bounds6);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_model_3x4_at(ozz_instance_t* inst, ozz_workspace_t* ws, uint64_t frame) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst/ws");
+  ozz_result_t r = eval_model_3x4_at(inst, ws, frame, ws->palette, 12u, ws->bounds);
+  // The palette came from the history, not from ws->model.
+  if (r == OZZ_OK && inst->update_interval > 1) palette_to_models(ws->palette, ws->num_joints, ws->model);
+  return r;
+}
 
-    for (int32_t i = 0; i < inst->num_joints; ++i) {
-      store_3x4_col_major(ws->model[i], ws->palette + (size_t)i * 12u);
+ozz_result_t ozz_eval_batch_3x4(const ozz_batch_item_t* items, int32_t count, ozz_workspace_t* ws, uint64_t frame,
+                                float* out_palettes, size_t palette_stride, ozz_vec3_t* out_bounds,
+                                int32_t* out_evaluated) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (out_evaluated) *out_evaluated = 0;
+  if (!ws || count < 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null ws or negative count");
+  if (count > 0 && (!items || !out_palettes)) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null items/out_palettes");
+  if (palette_stride < (size_t)ws->num_joints * 12u) return set_err(OZZ_ERR_INVALID_ARGUMENT, "palette stride too small");
+
+  for (int32_t i = 0; i < count; ++i) {
+    const ozz_batch_item_t& item = items[i];
+    if (item.layers) {
+      if (item.layer_count > OZZ_MAX_LAYERS) return set_err(OZZ_ERR_INVALID_ARGUMENT, "too many layers");
+      ozz_instance_set_layers(item.instance, item.layers, item.layer_count);
     }
+    float bounds[6];
+    ozz_result_t r = eval_model_3x4_at(item.instance, ws, frame, out_palettes + (size_t)i * palette_stride, 12u, bounds);
+    if (r != OZZ_OK) return r;
+    if (out_bounds) {
+      out_bounds[2 * i + 0] = {bounds[0], bounds[1], bounds[2]};
+      out_bounds[2 * i + 1] = {bounds[3], bounds[4], bounds[5]};
+    }
+    if (out_evaluated) *out_evaluated = i + 1;
   }
+  return OZZ_OK;
+}
+
+// ---- palette ring ----
+// Slot state: reader count, plus kRingSlotWriting while the writer owns it.
+// The writer only claims idle slots other than `latest`; readers pin a slot
+// first and then confirm it is still the latest, so a pinned slot always
+// holds a complete published eval.
+static constexpr uint32_t kRingSlotWriting = 1u << 31;
+
+struct ozz_palette_ring_slot_t {
+  std::atomic<uint32_t> state{0};
+  uint64_t sequence = 0;
+  ozz_vec3_t bounds_min{};
+  ozz_vec3_t bounds_max{};
+};
+
+struct ozz_palette_ring_t {
+  int32_t depth;
+  int32_t num_joints;
+  size_t joint_stride;
+  size_t slot_stride;
+  float* palettes;
+  ozz_palette_ring_slot_t* slots;
+  std::atomic<int32_t> latest{-1};
+  uint64_t published = 0;  // writer only
+};
+
+// Floats of one packed slot, rounded up to keep slots 16-byte aligned.
+static inline size_t ring_slot_floats(int32_t num_joints, size_t joint_stride) {
+  const size_t floats = (size_t)(num_joints - 1) * joint_stride + 12u;
+  return (floats + 3u) & ~size_t(3);
+}
+
+static inline size_t ring_joint_stride(const ozz_palette_ring_desc_t* desc) {
+  return desc->joint_stride ? desc->joint_stride : 12u;
+}
+
+size_t ozz_palette_ring_required_bytes(const ozz_skeleton_t* skel_h, const ozz_palette_ring_desc_t* desc) {
+  if (!skel_h || !desc || desc->depth < 2) return 0;
+  const int32_t n = (int32_t)skel_h->skel.num_joints();
+
+  size_t bytes = 0;
+  auto bump = [&](size_t sz, size_t al) { bytes = (bytes + (al - 1)) & ~(al - 1); bytes += sz; };
+
+  bump(sizeof(ozz_palette_ring_t), alignof(ozz_palette_ring_t));
+  bump(sizeof(ozz_palette_ring_slot_t) * (size_t)desc->depth, alignof(ozz_palette_ring_slot_t));
+  if (!desc->slots) bump(sizeof(float) * ring_slot_floats(n, ring_joint_stride(desc)) * (size_t)desc->depth, 16);
+  return bytes;
+}
 
+ozz_result_t ozz_palette_ring_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel_h,
+                                   const ozz_palette_ring_desc_t* desc, ozz_palette_ring_t** out_ring) {
+  ozz_clear_error();
+  if (!mem || !skel_h || !desc || !out_ring) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (desc->depth < 2) return set_err(OZZ_ERR_INVALID_ARGUMENT, "ring depth below 2");
+  const size_t joint_stride = ring_joint_stride(desc);
+  if (joint_stride < 12u) return set_err(OZZ_ERR_INVALID_ARGUMENT, "joint stride below 12 floats");
+  const int32_t n = (int32_t)skel_h->skel.num_joints();
+  const size_t packed = ring_slot_floats(n, joint_stride);
+  const size_t slot_stride = desc->slots && desc->slot_stride ? desc->slot_stride : packed;
+  if (slot_stride < (size_t)(n - 1) * joint_stride + 12u) return set_err(OZZ_ERR_INVALID_ARGUMENT, "slot stride too small");
+
+  void* cur = mem;
+  size_t left = mem_bytes;
+  ozz_palette_ring_t* ring = bump_alloc<ozz_palette_ring_t>(cur, left, 1);
+  ozz_palette_ring_slot_t* slots = bump_alloc<ozz_palette_ring_slot_t>(cur, left, (size_t)desc->depth);
+  float* palettes = desc->slots;
+  if (!palettes) palettes = (float*)bump_alloc_bytes(cur, left, sizeof(float) * packed * (size_t)desc->depth, 16);
+  if (!ring || !slots || !palettes) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mem too small");
+
+  ring = new (ring) ozz_palette_ring_t();
+  for (int32_t i = 0; i < desc->depth; ++i) new (&slots[i]) ozz_palette_ring_slot_t();
+  ring->depth = desc->depth;
+  ring->num_joints = n;
+  ring->joint_stride = joint_stride;
+  ring->slot_stride = slot_stride;
+  ring->palettes = palettes;
+  ring->slots = slots;
+  *out_ring = ring;
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_model_3x4_ring(ozz_instance_t* inst, ozz_workspace_t* ws, ozz_palette_ring_t* ring) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!ws || !ring) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null ws/ring");
+  if (ring->num_joints != ws->num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "size mismatch");
+
+  // Oldest slots first: they are the least likely to still be pinned.
+  const int32_t latest = ring->latest.load(std::memory_order_relaxed);
+  int32_t slot = -1;
+  for (int32_t k = 1; k <= ring->depth && slot < 0; ++k) {
+    const int32_t candidate = (latest + k) % ring->depth;
+    uint32_t idle = 0;
+    if (candidate != latest &&
+        ring->slots[candidate].state.compare_exchange_strong(idle, kRingSlotWriting, std::memory_order_acquire)) {
+      slot = candidate;
+    }
+  }
+  if (slot < 0) return set_err(OZZ_ERR_BUSY, "every ring slot is pinned");
+
+  ozz_palette_ring_slot_t& s = ring->slots[slot];
+  float bounds[6];
+  ozz_result_t r = eval_model_3x4(inst, ws, ring->palettes + (size_t)slot * ring->slot_stride, ring->joint_stride, bounds);
+  if (r == OZZ_OK) {
+    s.sequence = ++ring->published;
+    s.bounds_min = {bounds[0], bounds[1], bounds[2]};
+    s.bounds_max = {bounds[3], bounds[4], bounds[5]};
+  }
+  // Readers that bumped the count while we held the slot back out on their
+  // own, so drop only our bit and leave their counts in place.
+  s.state.fetch_and(~kRingSlotWriting, std::memory_order_release);
+  if (r == OZZ_OK) ring->latest.store(slot, std::memory_order_release);
+  return r;
+}
+
+ozz_result_t ozz_palette_ring_acquire(ozz_palette_ring_t* ring, ozz_palette_frame_t* out_frame) {
+  ozz_clear_error();
+  if (!ring || !out_frame) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null ring/out_frame");
+  for (;;) {
+    const int32_t slot = ring->latest.load(std::memory_order_acquire);
+    if (slot < 0) return set_err(OZZ_ERR_BUSY, "nothing published yet");
+    ozz_palette_ring_slot_t& s = ring->slots[slot];
+    const uint32_t state = s.state.fetch_add(1, std::memory_order_seq_cst);
+    if (!(state & kRingSlotWriting) && ring->latest.load(std::memory_order_seq_cst) == slot) {
+      out_frame->palette = ring->palettes + (size_t)slot * ring->slot_stride;
+      out_frame->joint_stride = ring->joint_stride;
+      out_frame->bounds_min = s.bounds_min;
+      out_frame->bounds_max = s.bounds_max;
+      out_frame->sequence = s.sequence;
+      out_frame->slot = slot;
+      return OZZ_OK;
+    }
+    s.state.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void ozz_palette_ring_release(ozz_palette_ring_t* ring, int32_t slot) {
+  if (!ring || slot < 0 || slot >= ring->depth) return;
+  ring->slots[slot].state.fetch_sub(1, std::memory_order_release);
+}
+
+// ---- parallel local-to-model ----
+struct ozz_ltm_subtree_t {
+  int32_t root;
+  int32_t end; // one past the last joint of the subtree (DF order keeps it contiguous)
+};
+
+struct ozz_ltm_partition_t {
+  const ozz::animation::Skeleton* skel;
+  ozz::vector<int32_t> trunk;               // joints above the split depth, DF order
+  ozz::vector<ozz_ltm_subtree_t> subtrees;  // grouped per task
+  ozz::vector<int32_t> task_offsets;        // [task_count + 1] into subtrees
+  ozz::vector<int32_t> task_joints;         // [task_count]
+};
+
+ozz_result_t ozz_ltm_partition_create(const ozz_skeleton_t* skel_h, int32_t split_depth, int32_t max_tasks,
+                                      ozz_ltm_partition_t** out_partition) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!skel_h || !out_partition) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (split_depth < 0 || max_tasks <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "invalid split depth or task count");
+
+  const ozz::animation::Skeleton& skel = skel_h->skel;
+  const int32_t num_joints = (int32_t)skel.num_joints();
+
+  // Depth-first walk: a subtree starts at every joint reaching split_depth and
+  // spans all following joints until the walk climbs back above it.
+  ozz::vector<int32_t> depth((size_t)num_joints, 0);
+  ozz::vector<int32_t> trunk;
+  ozz::vector<ozz_ltm_subtree_t> subtrees;
+  ozz::animation::IterateJointsDF(skel, [&](int joint, int parent) {
+    depth[(size_t)joint] = parent == ozz::animation::Skeleton::kNoParent ? 0 : depth[(size_t)parent] + 1;
+    if (depth[(size_t)joint] < split_depth) {
+      trunk.push_back(joint);
+    } else if (depth[(size_t)joint] == split_depth) {
+      subtrees.push_back({joint, joint + 1});
+    } else {
+      subtrees.back().end = joint + 1;
+    }
+  });
+
+  // Longest-processing-time first: biggest subtrees go to the least loaded task.
+  std::sort(subtrees.begin(), subtrees.end(), [](const ozz_ltm_subtree_t& a, const ozz_ltm_subtree_t& b) {
+    return (a.end - a.root) > (b.end - b.root);
+  });
+  const int32_t task_count = subtrees.empty() ? 0 : std::min<int32_t>(max_tasks, (int32_t)subtrees.size());
+  ozz::vector<int32_t> owner(subtrees.size(), 0);
+  ozz::vector<int32_t> load((size_t)task_count, 0);
+  for (size_t i = 0; i < subtrees.size(); ++i) {
+    const int32_t task = (int32_t)(std::min_element(load.begin(), load.end()) - load.begin());
+    owner[i] = task;
+    load[(size_t)task] += subtrees[i].end - subtrees[i].root;
+  }
+
+  auto* p = alloc_with_ozz_allocator<ozz_ltm_partition_t>();
+  if (!p) return set_err(OZZ_ERR, "oom");
+  p->skel = &skel;
+  p->trunk = std::move(trunk);
+  p->task_joints = load;
+  p->task_offsets.assign((size_t)task_count + 1u, 0);
+  for (size_t i = 0; i < subtrees.size(); ++i) ++p->task_offsets[(size_t)owner[i] + 1u];
+  for (int32_t t = 0; t < task_count; ++t) p->task_offsets[(size_t)t + 1u] += p->task_offsets[(size_t)t];
+
+  // Within a task, subtrees stay in DF order so memory is walked forward.
+  p->subtrees.resize(subtrees.size());
+  ozz::vector<int32_t> cursor(p->task_offsets.begin(), p->task_offsets.end() - 1);
+  for (size_t i = 0; i < subtrees.size(); ++i) p->subtrees[(size_t)cursor[(size_t)owner[i]]++] = subtrees[i];
+  for (int32_t t = 0; t < task_count; ++t) {
+    std::sort(p->subtrees.begin() + p->task_offsets[(size_t)t], p->subtrees.begin() + p->task_offsets[(size_t)t + 1u],
+              [](const ozz_ltm_subtree_t& a, const ozz_ltm_subtree_t& b) { return a.root < b.root; });
+  }
+
+  *out_partition = p;
+  return OZZ_OK;
+}
+
+void ozz_ltm_partition_destroy(ozz_ltm_partition_t* partition) { free_with_ozz_allocator(partition); }
+
+int32_t ozz_ltm_partition_task_count(const ozz_ltm_partition_t* partition) {
+  return partition ? (int32_t)partition->task_joints.size() : 0;
+}
+
+int32_t ozz_ltm_partition_task_joints(const ozz_ltm_partition_t* partition, int32_t task) {
+  if (!partition || task < 0 || task >= (int32_t)partition->task_joints.size()) return 0;
+  return partition->task_joints[(size_t)task];
+}
+
+int32_t ozz_ltm_partition_trunk_joints(const ozz_ltm_partition_t* partition) {
+  return partition ? (int32_t)partition->trunk.size() : 0;
+}
+
+static inline ozz_result_t check_partition(const ozz_instance_t* inst, const ozz_workspace_t* ws,
+                                           const ozz_ltm_partition_t* partition) {
+  if (!inst || !ws || !partition) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (inst->skel != ws->skel || inst->skel != partition->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_locals(ozz_instance_t* inst, ozz_workspace_t* ws) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  return eval_locals(inst, ws);
+}
+
+ozz_result_t ozz_eval_ltm_trunk(ozz_instance_t* inst, ozz_workspace_t* ws, const ozz_ltm_partition_t* partition) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  ozz_result_t r = check_partition(inst, ws, partition);
+  if (r != OZZ_OK) return r;
+
+  kernels()->ltm_joints(reinterpret_cast<const float*>(inst->accum), inst->skel->joint_parents().data(),
+                        partition->trunk.data(), (int32_t)partition->trunk.size(),
+                        reinterpret_cast<float*>(ws->model), ws->palette);
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_ltm_task(ozz_instance_t* inst, ozz_workspace_t* ws, const ozz_ltm_partition_t* partition, int32_t task) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  ozz_result_t r = check_partition(inst, ws, partition);
+  if (r != OZZ_OK) return r;
+  if (task < 0 || task >= (int32_t)partition->task_joints.size()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "task out of range");
+
+  // Subtree roots' parents belong to the trunk, so each subtree only reads
+  // trunk matrices and writes its own joints.
+  ozz::animation::LocalToModelJob job;
+  job.skeleton = inst->skel;
+  job.input = ozz::span<const ozz::math::SoaTransform>(inst->accum, inst->num_soa);
+  job.output = ozz::span<ozz::math::Float4x4>(ws->model, inst->num_joints);
+  for (int32_t i = partition->task_offsets[(size_t)task]; i < partition->task_offsets[(size_t)task + 1u]; ++i) {
+    const ozz_ltm_subtree_t& subtree = partition->subtrees[(size_t)i];
+    job.from = subtree.root;
+    job.to = subtree.end - 1;
+    if (!kernels()->local_to_model(&job)) return set_err(OZZ_ERR_OZZ, "ltm failed");
+    kernels()->store_palette(reinterpret_cast<const float*>(ws->model + subtree.root), subtree.end - subtree.root,
+                             ws->palette + (size_t)subtree.root * 12u, 12u, nullptr);
+  }
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_eval_bounds(const ozz_instance_t* inst, ozz_workspace_t* ws) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!inst || !ws) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null inst/ws");
+  if (inst->skel != ws->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+
+  using namespace ozz::math;
+  SimdFloat4 min = simd_float4::Load1(std::numeric_limits<float>::max());
+  SimdFloat4 max = -min;
+  for (int32_t i = 0; i < inst->num_joints; ++i) {
+    min = Min(min, ws->model[i].cols[3]);
+    max = Max(max, ws->model[i].cols[3]);
+  }
+  if (inst->bounds_mesh) mesh_bounds(inst->bounds_mesh, ws->model, &min, &max);
+  store_bounds(ws, min, max);
   return OZZ_OK;
 }
 
@@ -738,7 +2675,8 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
   std::vector<ozz::animation::BlendingJob::Layer> normal_layers;
   std::vector<ozz::animation::BlendingJob::Layer> additive_layers;
   std::vector<ozz::math::SoaTransform> locals((size_t)inst->num_soa);
-  ozz::animation::SamplingJob::Context sampling_ctx(inst->num_joints);
+  std::vector<ozz::math::SoaTransform> retarget_source((size_t)num_soa_from_joints(inst->max_tracks));
+  ozz::animation::SamplingJob::Context sampling_ctx(inst->max_tracks);
 
   sampled_normal.reserve((size_t)inst->num_soa * (size_t)OZZ_MAX_LAYERS);
   sampled_additive.reserve((size_t)inst->num_soa * (size_t)OZZ_MAX_LAYERS);
@@ -753,7 +2691,7 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
       if ((int32_t)additive_layers.size() >= OZZ_MAX_LAYERS) continue;
       const size_t offset = sampled_additive.size();
       sampled_additive.resize(offset + (size_t)inst->num_soa);
-      ozz_result_t r = sample_into_context(inst->num_joints, inst->num_soa, &sampling_ctx, L.anim, L.ratio, sampled_additive.data() + offset);
+      ozz_result_t r = sample_into_context(inst->num_joints, inst->num_soa, &sampling_ctx, L, retarget_source.data(), (int32_t)retarget_source.size(), sampled_additive.data() + offset);
       if (r != OZZ_OK) return set_err(r, "reference sample failed");
 
       ozz::animation::BlendingJob::Layer layer;
@@ -767,7 +2705,7 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
       if ((int32_t)normal_layers.size() >= OZZ_MAX_LAYERS) continue;
       const size_t offset = sampled_normal.size();
       sampled_normal.resize(offset + (size_t)inst->num_soa);
-      ozz_result_t r = sample_into_context(inst->num_joints, inst->num_soa, &sampling_ctx, L.anim, L.ratio, sampled_normal.data() + offset);
+      ozz_result_t r = sample_into_context(inst->num_joints, inst->num_soa, &sampling_ctx, L, retarget_source.data(), (int32_t)retarget_source.size(), sampled_normal.data() + offset);
       if (r != OZZ_OK) return set_err(r, "reference sample failed");
 
       ozz::animation::BlendingJob::Layer layer;
@@ -793,7 +2731,7 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
   if (!blend_job.Run()) return set_err(OZZ_ERR_OZZ, "reference blend run failed");
 
   if (inst->ik_count > 0) {
-    ozz_result_t r = locals_to_model(inst, locals.data(), ws->model);
+    ozz_result_t r = upstream_locals_to_model(inst, locals.data(), ws->model);
     if (r != OZZ_OK) return set_err(r, "reference ltm pre-IK failed");
 
     for (int32_t i = 0; i < inst->ik_count; ++i) {
@@ -861,7 +2799,7 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
     }
   }
 
-  ozz_result_t r = locals_to_model(inst, locals.data(), ws->model);
+  ozz_result_t r = upstream_locals_to_model(inst, locals.data(), ws->model);
   if (r != OZZ_OK) return set_err(r, "reference ltm failed");
 
   for (int32_t i = 0; i < inst->num_joints; ++i) {
@@ -870,3 +2808,794 @@ extern "C" ozz_result_t ozz_eval_model_3x4_reference(ozz_instance_t* inst, ozz_w
 
   return OZZ_OK;
 }
+
+// ---- skinning ----
+static inline float half_to_float(uint16_t h) {
+  const uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+  const uint32_t exp = (h >> 10) & 0x1fu;
+  const uint32_t mant = h & 0x3ffu;
+  uint32_t bits;
+  if (exp == 0x1fu) {
+    bits = sign | 0x7f800000u | (mant << 13);
+  } else if (exp != 0) {
+    bits = sign | ((exp + 112u) << 23) | (mant << 13);
+  } else if (mant == 0) {
+    bits = sign;
+  } else {
+    // Subnormal half: renormalize.
+    uint32_t e = 113u;
+    uint32_t m = mant;
+    while (!(m & 0x400u)) { m <<= 1; --e; }
+    bits = sign | (e << 23) | ((m & 0x3ffu) << 13);
+  }
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static inline float skin_input(const float* f32, const uint16_t* f16, int32_t i) {
+  return f16 ? half_to_float(f16[i]) : f32[i];
+}
+
+static ozz_result_t validate_skinning_desc(const ozz_skinning_desc_t* d) {
+  if (!d) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null desc");
+  if (!d->matrices_3x4 == !d->dual_quats) return set_err(OZZ_ERR_INVALID_ARGUMENT, "set exactly one of matrices_3x4/dual_quats");
+  if (d->matrix_count <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no matrices");
+  if (d->vertex_count < 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "negative vertex count");
+  if (d->influences < 1 || d->influences > OZZ_MAX_SKINNING_INFLUENCES) return set_err(OZZ_ERR_INVALID_ARGUMENT, "influences out of range");
+  if (!d->joints_u16 == !d->joints_u8) return set_err(OZZ_ERR_INVALID_ARGUMENT, "set exactly one of joints_u16/joints_u8");
+  if (d->influences > 1 && !d->weights_f32 == !d->weights_unorm8) return set_err(OZZ_ERR_INVALID_ARGUMENT, "set exactly one of weights_f32/weights_unorm8");
+  if (!d->positions_f32 == !d->positions_f16) return set_err(OZZ_ERR_INVALID_ARGUMENT, "set exactly one of positions_f32/positions_f16");
+  if (d->normals_f32 && d->normals_f16) return set_err(OZZ_ERR_INVALID_ARGUMENT, "set at most one of normals_f32/normals_f16");
+  if (!d->out_positions) return set_err(OZZ_ERR_INVALID_ARGUMENT, "out_positions null");
+  if ((d->normals_f32 || d->normals_f16) && !d->out_normals) return set_err(OZZ_ERR_INVALID_ARGUMENT, "out_normals null");
+  return OZZ_OK;
+}
+
+// Dual quaternion variant of skin_scalar, same vertex walk.
+static void skin_dual_quat_scalar(const ozz_skinning_desc_t* d, int32_t first_vertex) {
+  const int32_t inf = d->influences;
+  const bool normals = d->normals_f32 || d->normals_f16;
+  for (int32_t v = first_vertex; v < d->vertex_count; ++v) {
+    float q[8] = {};
+    const float* pivot = nullptr;
+    float weight_sum = 0.f;
+    for (int32_t i = 0; i < inf; ++i) {
+      const int32_t e = v * inf + i;
+      int32_t joint = d->joints_u8 ? d->joints_u8[e] : d->joints_u16[e];
+      if (joint >= d->matrix_count) joint = d->matrix_count - 1;
+
+      float w;
+      if (i + 1 < inf) {
+        const int32_t we = v * (inf - 1) + i;
+        w = d->weights_unorm8 ? (float)d->weights_unorm8[we] * (1.f / 255.f) : d->weights_f32[we];
+        weight_sum += w;
+      } else {
+        w = 1.f - weight_sum;
+      }
+
+      // Shortest path: blend in the hemisphere of the first influence.
+      const float* src = d->dual_quats + (size_t)joint * 8u;
+      if (!pivot) pivot = src;
+      const float dot = src[0] * pivot[0] + src[1] * pivot[1] + src[2] * pivot[2] + src[3] * pivot[3];
+      if (dot < 0.f) w = -w;
+      for (int c = 0; c < 8; ++c) q[c] += src[c] * w;
+    }
+
+    const float inv_norm = 1.f / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int c = 0; c < 8; ++c) q[c] *= inv_norm;
+
+    // v + 2 * r x (r x v + rw * v)
+    auto rotate = [&q](float* vec) {
+      const float cx = q[1] * vec[2] - q[2] * vec[1] + q[3] * vec[0];
+      const float cy = q[2] * vec[0] - q[0] * vec[2] + q[3] * vec[1];
+      const float cz = q[0] * vec[1] - q[1] * vec[0] + q[3] * vec[2];
+      vec[0] += 2.f * (q[1] * cz - q[2] * cy);
+      vec[1] += 2.f * (q[2] * cx - q[0] * cz);
+      vec[2] += 2.f * (q[0] * cy - q[1] * cx);
+    };
+
+    float* op = d->out_positions + (size_t)v * 3u;
+    float p[3] = {skin_input(d->positions_f32, d->positions_f16, v * 3 + 0),
+                  skin_input(d->positions_f32, d->positions_f16, v * 3 + 1),
+                  skin_input(d->positions_f32, d->positions_f16, v * 3 + 2)};
+    rotate(p);
+    // Translation 2 * (rw * d - dw * r + r x d).
+    op[0] = p[0] + 2.f * (q[3] * q[4] - q[7] * q[0] + q[1] * q[6] - q[2] * q[5]);
+    op[1] = p[1] + 2.f * (q[3] * q[5] - q[7] * q[1] + q[2] * q[4] - q[0] * q[6]);
+    op[2] = p[2] + 2.f * (q[3] * q[6] - q[7] * q[2] + q[0] * q[5] - q[1] * q[4]);
+
+    if (normals) {
+      float* on = d->out_normals + (size_t)v * 3u;
+      on[0] = skin_input(d->normals_f32, d->normals_f16, v * 3 + 0);
+      on[1] = skin_input(d->normals_f32, d->normals_f16, v * 3 + 1);
+      on[2] = skin_input(d->normals_f32, d->normals_f16, v * 3 + 2);
+      rotate(on);
+    }
+  }
+}
+
+// Portable path, also used for the tail of the AVX2 kernel.
+static void skin_scalar(const ozz_skinning_desc_t* d, int32_t first_vertex) {
+  const int32_t inf = d->influences;
+  const bool normals = d->normals_f32 || d->normals_f16;
+  for (int32_t v = first_vertex; v < d->vertex_count; ++v) {
+    float m[12] = {};
+    float weight_sum = 0.f;
+    for (int32_t i = 0; i < inf; ++i) {
+      const int32_t e = v * inf + i;
+      int32_t joint = d->joints_u8 ? d->joints_u8[e] : d->joints_u16[e];
+      if (joint >= d->matrix_count) joint = d->matrix_count - 1;
+
+      float w;
+      if (i + 1 < inf) {
+        const int32_t we = v * (inf - 1) + i;
+        w = d->weights_unorm8 ? (float)d->weights_unorm8[we] * (1.f / 255.f) : d->weights_f32[we];
+        weight_sum += w;
+      } else {
+        w = 1.f - weight_sum;
+      }
+
+      const float* src = d->matrices_3x4 + (size_t)joint * 12u;
+      for (int c = 0; c < 12; ++c) m[c] += src[c] * w;
+    }
+
+    const float px = skin_input(d->positions_f32, d->positions_f16, v * 3 + 0);
+    const float py = skin_input(d->positions_f32, d->positions_f16, v * 3 + 1);
+    const float pz = skin_input(d->positions_f32, d->positions_f16, v * 3 + 2);
+    float* op = d->out_positions + (size_t)v * 3u;
+    op[0] = m[0] * px + m[3] * py + m[6] * pz + m[9];
+    op[1] = m[1] * px + m[4] * py + m[7] * pz + m[10];
+    op[2] = m[2] * px + m[5] * py + m[8] * pz + m[11];
+
+    if (normals) {
+      const float nx = skin_input(d->normals_f32, d->normals_f16, v * 3 + 0);
+      const float ny = skin_input(d->normals_f32, d->normals_f16, v * 3 + 1);
+      const float nz = skin_input(d->normals_f32, d->normals_f16, v * 3 + 2);
+      float* on = d->out_normals + (size_t)v * 3u;
+      on[0] = m[0] * nx + m[3] * ny + m[6] * nz;
+      on[1] = m[1] * nx + m[4] * ny + m[7] * nz;
+      on[2] = m[2] * nx + m[5] * ny + m[8] * nz;
+    }
+  }
+}
+
+ozz_result_t ozz_skin(const ozz_skinning_desc_t* desc) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  ozz_result_t r = validate_skinning_desc(desc);
+  if (r != OZZ_OK) return r;
+
+  const cozz_kernels_t* k = kernels();
+  const int32_t done = k->skin ? k->skin(desc) : 0;
+  if (desc->dual_quats) {
+    skin_dual_quat_scalar(desc, done);
+  } else {
+    skin_scalar(desc, done);
+  }
+  return OZZ_OK;
+}
+
+static inline ozz::math::Float4x4 load_3x4_col_major(const float* in12) {
+  ozz::math::Float4x4 m;
+  m.cols[0] = load3(in12[0], in12[1], in12[2], 0.f);
+  m.cols[1] = load3(in12[3], in12[4], in12[5], 0.f);
+  m.cols[2] = load3(in12[6], in12[7], in12[8], 0.f);
+  m.cols[3] = load3(in12[9], in12[10], in12[11], 1.f);
+  return m;
+}
+
+// Unit dual quaternion (real xyzw, dual xyzw) of an affine matrix, scale dropped.
+static inline void store_dual_quat(const ozz::math::Float4x4& m, float* out8) {
+  using namespace ozz::math;
+  SimdFloat4 translation, rotation, scale;
+  if (!ToAffine(m, &translation, &rotation, &scale)) {
+    translation = m.cols[3];
+    rotation = simd_float4::w_axis();
+  }
+
+  // dual = 0.5 * (t, 0) * real
+  const SimdFloat4 half_t = translation * simd_float4::Load1(.5f);
+  SimdFloat4 dual = SplatW(rotation) * half_t + Cross3(half_t, rotation);
+  dual = SetW(dual, -Dot3(half_t, rotation));
+
+  StorePtrU(rotation, out8);
+  StorePtrU(dual, out8 + 4);
+}
+
+ozz_result_t ozz_workspace_dual_quats(const ozz_workspace_t* ws, const float* inverse_binds_3x4,
+                                      float* out_dual_quats, int32_t out_floats) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!ws || !out_dual_quats) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (out_floats < 8 * ws->num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "dual quaternion buffer too small");
+
+  for (int32_t i = 0; i < ws->num_joints; ++i) {
+    const ozz::math::Float4x4& m = ws->model[i];
+    store_dual_quat(inverse_binds_3x4 ? m * load_3x4_col_major(inverse_binds_3x4 + (size_t)i * 12u) : m,
+                    out_dual_quats + (size_t)i * 8u);
+  }
+  return OZZ_OK;
+}
+
+// ---- mesh palettes ----
+struct ozz_mesh_remap_t {
+  const ozz::animation::Skeleton* skel;
+  ozz::vector<int32_t> joints;                    // [count], skeleton joints
+  ozz::vector<ozz::math::Float4x4> inverse_binds; // [count]
+
+  // Bind-space boxes as center/half extents, valid boxes only.
+  ozz::vector<int32_t> box_joints;                // mesh joint index
+  ozz::vector<ozz::math::SimdFloat4> box_centers;
+  ozz::vector<ozz::math::SimdFloat4> box_extents;
+};
+
+static const ozz::animation::Skeleton* mesh_remap_skeleton(const ozz_mesh_remap_t* mesh) { return mesh->skel; }
+
+// Returns false when the mesh has no boxes, leaving min/max untouched.
+// ozz::math::TransformBox only transforms the min and max corners, which
+// misses rotated boxes, so boxes are moved as center + |M| * extents instead.
+static bool mesh_bounds(const ozz_mesh_remap_t* mesh, const ozz::math::Float4x4* model,
+                        ozz::math::SimdFloat4* min, ozz::math::SimdFloat4* max) {
+  using namespace ozz::math;
+  if (mesh->box_joints.empty()) return false;
+  SimdFloat4 lo = simd_float4::Load1(std::numeric_limits<float>::max());
+  SimdFloat4 hi = -lo;
+  for (size_t b = 0; b < mesh->box_joints.size(); ++b) {
+    const size_t k = (size_t)mesh->box_joints[b];
+    const Float4x4 m = model[mesh->joints[k]] * mesh->inverse_binds[k];
+    const SimdFloat4 center = TransformPoint(m, mesh->box_centers[b]);
+    const SimdFloat4 e = mesh->box_extents[b];
+    const SimdFloat4 extent = Abs(m.cols[0]) * SplatX(e) + Abs(m.cols[1]) * SplatY(e) + Abs(m.cols[2]) * SplatZ(e);
+    lo = Min(lo, center - extent);
+    hi = Max(hi, center + extent);
+  }
+  *min = lo;
+  *max = hi;
+  return true;
+}
+
+ozz_result_t ozz_mesh_remap_set_joint_bounds(ozz_mesh_remap_t* mesh, const float* boxes, int32_t count) {
+  ozz_clear_error();
+  if (!mesh || !boxes) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (count != (int32_t)mesh->joints.size()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "one box per mesh joint expected");
+
+  mesh->box_joints.clear();
+  mesh->box_centers.clear();
+  mesh->box_extents.clear();
+  const ozz::math::SimdFloat4 half = ozz::math::simd_float4::Load1(.5f);
+  for (int32_t k = 0; k < count; ++k) {
+    const float* b = boxes + (size_t)k * 6u;
+    const ozz::math::Box box(ozz::math::Float3(b[0], b[1], b[2]), ozz::math::Float3(b[3], b[4], b[5]));
+    if (!box.is_valid()) continue; // joint without vertices
+    const ozz::math::SimdFloat4 min = load3(box.min.x, box.min.y, box.min.z, 1.f);
+    const ozz::math::SimdFloat4 max = load3(box.max.x, box.max.y, box.max.z, 1.f);
+    mesh->box_joints.push_back(k);
+    mesh->box_centers.push_back((min + max) * half);
+    mesh->box_extents.push_back((max - min) * half);
+  }
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_mesh_remap_create(const ozz_skeleton_t* skel_h, const int32_t* joints,
+                                   const float* inverse_binds_3x4, int32_t count,
+                                   ozz_mesh_remap_t** out_mesh) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_CONTEXT);
+  if (!skel_h || !joints || !inverse_binds_3x4 || !out_mesh) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (count <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no joints");
+  const int32_t num_joints = (int32_t)skel_h->skel.num_joints();
+  for (int32_t k = 0; k < count; ++k) {
+    if (joints[k] < 0 || joints[k] >= num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mesh joint out of range");
+  }
+
+  auto* mesh = alloc_with_ozz_allocator<ozz_mesh_remap_t>();
+  if (!mesh) return set_err(OZZ_ERR, "oom");
+  mesh->skel = &skel_h->skel;
+  mesh->joints.assign(joints, joints + count);
+  mesh->inverse_binds.resize((size_t)count);
+  for (int32_t k = 0; k < count; ++k) {
+    mesh->inverse_binds[(size_t)k] = load_3x4_col_major(inverse_binds_3x4 + (size_t)k * 12u);
+  }
+
+  *out_mesh = mesh;
+  return OZZ_OK;
+}
+
+void ozz_mesh_remap_destroy(ozz_mesh_remap_t* mesh) { free_with_ozz_allocator(mesh); }
+
+int32_t ozz_mesh_remap_joint_count(const ozz_mesh_remap_t* mesh) {
+  return mesh ? (int32_t)mesh->joints.size() : 0;
+}
+
+static ozz_result_t check_mesh_output(const ozz_workspace_t* ws, const ozz_mesh_remap_t* mesh,
+                                      const float* out, int32_t out_floats, int32_t floats_per_joint) {
+  if (!ws || !mesh || !out) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (ws->skel != mesh->skel) return set_err(OZZ_ERR_INVALID_ARGUMENT, "skeleton mismatch");
+  if (out_floats < floats_per_joint * (int32_t)mesh->joints.size()) return set_err(OZZ_ERR_INVALID_ARGUMENT, "mesh palette buffer too small");
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_workspace_mesh_palette_3x4(const ozz_workspace_t* ws, const ozz_mesh_remap_t* mesh,
+                                            float* out_palette, int32_t out_floats) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  ozz_result_t r = check_mesh_output(ws, mesh, out_palette, out_floats, 12);
+  if (r != OZZ_OK) return r;
+
+  for (size_t k = 0; k < mesh->joints.size(); ++k) {
+    store_3x4_col_major(ws->model[mesh->joints[k]] * mesh->inverse_binds[k], out_palette + k * 12u);
+  }
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_workspace_mesh_dual_quats(const ozz_workspace_t* ws, const ozz_mesh_remap_t* mesh,
+                                           float* out_dual_quats, int32_t out_floats) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  ozz_result_t r = check_mesh_output(ws, mesh, out_dual_quats, out_floats, 8);
+  if (r != OZZ_OK) return r;
+
+  for (size_t k = 0; k < mesh->joints.size(); ++k) {
+    store_dual_quat(ws->model[mesh->joints[k]] * mesh->inverse_binds[k], out_dual_quats + k * 8u);
+  }
+  return OZZ_OK;
+}
+
+// Test hook: decodes the desc to full precision and runs ozz's SkinningJob.
+extern "C" ozz_result_t ozz_skin_reference(const ozz_skinning_desc_t* d) {
+  ozz_clear_error();
+  ozz_result_t r = validate_skinning_desc(d);
+  if (r != OZZ_OK) return r;
+  if (!d->matrices_3x4) return set_err(OZZ_ERR_INVALID_ARGUMENT, "reference skinning takes matrices");
+
+  const int32_t n = d->vertex_count;
+  const int32_t inf = d->influences;
+  std::vector<ozz::math::Float4x4> matrices((size_t)d->matrix_count);
+  for (int32_t j = 0; j < d->matrix_count; ++j) {
+    matrices[(size_t)j] = load_3x4_col_major(d->matrices_3x4 + (size_t)j * 12u);
+  }
+
+  std::vector<uint16_t> joints((size_t)n * (size_t)inf);
+  for (size_t i = 0; i < joints.size(); ++i) {
+    const int32_t joint = d->joints_u8 ? d->joints_u8[i] : d->joints_u16[i];
+    joints[i] = (uint16_t)(joint < d->matrix_count ? joint : d->matrix_count - 1);
+  }
+  std::vector<float> weights((size_t)n * (size_t)(inf - 1));
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = d->weights_unorm8 ? (float)d->weights_unorm8[i] * (1.f / 255.f) : d->weights_f32[i];
+  }
+  std::vector<float> positions((size_t)n * 3u);
+  for (size_t i = 0; i < positions.size(); ++i) positions[i] = skin_input(d->positions_f32, d->positions_f16, (int32_t)i);
+  const bool has_normals = d->normals_f32 || d->normals_f16;
+  std::vector<float> normals(has_normals ? (size_t)n * 3u : 0u);
+  for (size_t i = 0; i < normals.size(); ++i) normals[i] = skin_input(d->normals_f32, d->normals_f16, (int32_t)i);
+
+  ozz::geometry::SkinningJob job;
+  job.vertex_count = n;
+  job.influences_count = inf;
+  job.joint_matrices = ozz::make_span(matrices);
+  job.joint_indices = ozz::make_span(joints);
+  job.joint_indices_stride = sizeof(uint16_t) * (size_t)inf;
+  if (inf > 1) {
+    job.joint_weights = ozz::make_span(weights);
+    job.joint_weights_stride = sizeof(float) * (size_t)(inf - 1);
+  }
+  job.in_positions = ozz::make_span(positions);
+  job.in_positions_stride = sizeof(float) * 3u;
+  job.out_positions = ozz::span<float>(d->out_positions, (size_t)n * 3u);
+  job.out_positions_stride = sizeof(float) * 3u;
+  if (has_normals) {
+    job.in_normals = ozz::make_span(normals);
+    job.in_normals_stride = sizeof(float) * 3u;
+    job.out_normals = ozz::span<float>(d->out_normals, (size_t)n * 3u);
+    job.out_normals_stride = sizeof(float) * 3u;
+  }
+  return job.Run() ? OZZ_OK : set_err(OZZ_ERR_OZZ, "reference skinning failed");
+}
+
+// ---- motion matching ----
+struct ozz_motion_db_t {
+  int32_t num_frames = 0;
+  int32_t num_clips = 0;
+  int32_t dims = 0;
+  int32_t padded_dims = 0;
+  ozz::vector<float> mean;            // [dims]
+  ozz::vector<float> scale;           // [dims]
+  ozz::vector<int32_t> frame_clip;    // [num_frames]
+  ozz::vector<float> frame_ratio;     // [num_frames]
+  ozz::vector<float> features;        // normalized, see cozz_motion_db_view_t
+  ozz::vector<float> small_bounds;
+  ozz::vector<float> large_bounds;
+};
+
+static const char kMotionDbTag[8] = {'c', 'o', 'z', 'z', 'm', 'm', 'd', 'b'};
+static constexpr int32_t kMotionDbVersion = 1;
+static constexpr double kMotionMinDeviation = 1e-2;
+static constexpr int32_t kMotionMaxDims = OZZ_MOTION_MAX_FEATURE_JOINTS * 6 + OZZ_MOTION_MAX_TRAJECTORY * 4;
+
+// Root position and facing, and feature joint positions, of one sampled pose.
+struct MotionPose {
+  ozz::math::Float3 root;
+  float facing_x, facing_z;
+  ozz::math::Float3 joints[OZZ_MOTION_MAX_FEATURE_JOINTS];
+
+  // v (a model-space vector) in the root's character space.
+  ozz::math::Float3 to_character(const ozz::math::Float3& v) const {
+    return {v.x * facing_z - v.z * facing_x, v.y, v.x * facing_x + v.z * facing_z};
+  }
+};
+
+struct MotionSampler {
+  const ozz::animation::Skeleton& skel;
+  const ozz_motion_db_desc_t& desc;
+  ozz::animation::SamplingJob::Context ctx;
+  ozz::vector<ozz::math::SoaTransform> locals;
+  ozz::vector<ozz::math::Float4x4> models;
+
+  MotionSampler(const ozz::animation::Skeleton& _skel, const ozz_motion_db_desc_t& _desc)
+      : skel(_skel), desc(_desc), ctx(_skel.num_joints()), locals((size_t)_skel.num_soa_joints()),
+        models((size_t)_skel.num_joints()) {}
+
+  bool sample(const ozz::animation::Animation& anim, float time, MotionPose* out) {
+    const float duration = anim.duration();
+    ozz::animation::SamplingJob sampling;
+    sampling.animation = &anim;
+    sampling.context = &ctx;
+    sampling.ratio = duration > 0.f ? std::clamp(time / duration, 0.f, 1.f) : 0.f;
+    sampling.output = ozz::make_span(locals);
+    ozz::animation::LocalToModelJob ltm;
+    ltm.skeleton = &skel;
+    ltm.input = ozz::make_span(locals);
+    ltm.output = ozz::make_span(models);
+    if (!sampling.Run() || !ltm.Run()) return false;
+
+    const ozz::math::Float4x4& root = models[(size_t)desc.root_joint];
+    ozz::math::Store3PtrU(root.cols[3], &out->root.x);
+    ozz::math::Float3 facing;
+    ozz::math::Store3PtrU(root.cols[desc.facing_axis], &facing.x);
+    const float length = std::sqrt(facing.x * facing.x + facing.z * facing.z);
+    out->facing_x = length > 1e-6f ? facing.x / length : 0.f;
+    out->facing_z = length > 1e-6f ? facing.z / length : 1.f;
+    for (int32_t i = 0; i < desc.feature_joint_count; ++i) {
+      ozz::math::Store3PtrU(models[(size_t)desc.feature_joints[i]].cols[3], &out->joints[i].x);
+    }
+    return true;
+  }
+};
+
+// Raw features of the frame at time, laid out as documented in the header.
+static bool motion_frame_features(MotionSampler& sampler, const ozz::animation::Animation& anim, float time,
+                                  float* out) {
+  const ozz_motion_db_desc_t& desc = sampler.desc;
+  const float duration = anim.duration();
+  const float step = 1.f / desc.sample_rate;
+  MotionPose pose, before, after;
+  if (!sampler.sample(anim, time, &pose)) return false;
+
+  // Velocities from the step before the frame, or after it on the first one.
+  const float t0 = std::max(time - step, 0.f);
+  const float t1 = std::min(t0 + step, duration);
+  if (!sampler.sample(anim, t0, &before) || !sampler.sample(anim, t1, &after)) return false;
+  const float rate = t1 > t0 ? 1.f / (t1 - t0) : 0.f;
+  for (int32_t i = 0; i < desc.feature_joint_count; ++i) {
+    const ozz::math::Float3 p = pose.to_character(pose.joints[i] - pose.root);
+    const ozz::math::Float3 v = pose.to_character((after.joints[i] - before.joints[i]) * rate);
+    float* f = out + i * 6;
+    f[0] = p.x, f[1] = p.y, f[2] = p.z;
+    f[3] = v.x, f[4] = v.y, f[5] = v.z;
+  }
+  for (int32_t k = 0; k < desc.trajectory_count; ++k) {
+    MotionPose future;
+    if (!sampler.sample(anim, std::min(time + desc.trajectory_times[k], duration), &future)) return false;
+    const ozz::math::Float3 p = pose.to_character(future.root - pose.root);
+    const ozz::math::Float3 d = pose.to_character(ozz::math::Float3(future.facing_x, 0.f, future.facing_z));
+    float* f = out + desc.feature_joint_count * 6 + k * 4;
+    f[0] = p.x, f[1] = p.z;
+    f[2] = d.x, f[3] = d.z;
+  }
+  return true;
+}
+
+// Per feature group of the layout: 0 joint positions, 1 joint velocities,
+// 2 trajectory positions, 3 trajectory facings.
+static int32_t motion_feature_group(int32_t feature_joints, int32_t dim) {
+  if (dim < feature_joints * 6) return (dim % 6) / 3;
+  return 2 + ((dim - feature_joints * 6) % 4) / 2;
+}
+
+// Box bounds of every block of the normalized features.
+static void build_motion_bounds(ozz_motion_db_t* db) {
+  const size_t dims = (size_t)db->padded_dims;
+  auto build = [&](int32_t block, ozz::vector<float>* bounds) {
+    const int32_t boxes = (db->num_frames + block - 1) / block;
+    bounds->assign((size_t)boxes * dims * 2u, 0.f);
+    for (int32_t b = 0; b < boxes; ++b) {
+      float* lo = bounds->data() + (size_t)b * dims * 2u;
+      float* hi = lo + dims;
+      for (size_t k = 0; k < dims; ++k) {
+        lo[k] = std::numeric_limits<float>::max();
+        hi[k] = -lo[k];
+      }
+      const int32_t end = std::min(db->num_frames, (b + 1) * block);
+      for (int32_t f = b * block; f < end; ++f) {
+        const float* lanes = db->features.data() + (size_t)(f & ~3) * dims + (size_t)(f & 3);
+        for (size_t k = 0; k < dims; ++k) {
+          lo[k] = std::min(lo[k], lanes[k * 4u]);
+          hi[k] = std::max(hi[k], lanes[k * 4u]);
+        }
+      }
+    }
+  };
+  build(kMotionSmallBlock, &db->small_bounds);
+  build(kMotionLargeBlock, &db->large_bounds);
+}
+
+ozz_result_t ozz_motion_db_create(const ozz_skeleton_t* skel_h, const ozz_motion_db_desc_t* desc_in,
+                                  ozz_motion_db_t** out_db) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!skel_h || !desc_in || !out_db) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz_motion_db_desc_t desc = *desc_in;
+  if (desc.sample_rate == 0.f) desc.sample_rate = 30.f;
+  const ozz::animation::Skeleton& skel = skel_h->skel;
+  const int32_t num_joints = skel.num_joints();
+  if (!desc.clips || desc.clip_count <= 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no clips");
+  if (desc.feature_joint_count < 0 || desc.feature_joint_count > OZZ_MOTION_MAX_FEATURE_JOINTS ||
+      (desc.feature_joint_count > 0 && !desc.feature_joints)) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad feature joints");
+  }
+  if (desc.trajectory_count < 0 || desc.trajectory_count > OZZ_MOTION_MAX_TRAJECTORY ||
+      (desc.trajectory_count > 0 && !desc.trajectory_times)) {
+    return set_err(OZZ_ERR_INVALID_ARGUMENT, "bad trajectory times");
+  }
+  if (desc.feature_joint_count + desc.trajectory_count == 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "no features");
+  for (int32_t i = 0; i < desc.feature_joint_count; ++i) {
+    if (desc.feature_joints[i] < 0 || desc.feature_joints[i] >= num_joints) {
+      return set_err(OZZ_ERR_INVALID_ARGUMENT, "feature joint out of range");
+    }
+  }
+  for (int32_t k = 0; k < desc.trajectory_count; ++k) {
+    if (!std::isfinite(desc.trajectory_times[k]) || desc.trajectory_times[k] < 0.f) {
+      return set_err(OZZ_ERR_INVALID_ARGUMENT, "trajectory times must be finite and >= 0");
+    }
+  }
+  if (desc.root_joint < 0 || desc.root_joint >= num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "root joint out of range");
+  if (desc.facing_axis < 0 || desc.facing_axis > 2) return set_err(OZZ_ERR_INVALID_ARGUMENT, "facing axis must be 0, 1 or 2");
+  if (!std::isfinite(desc.sample_rate) || desc.sample_rate < 0.f) return set_err(OZZ_ERR_INVALID_ARGUMENT, "sample_rate must be positive");
+  const float weights[4] = {desc.position_weight, desc.velocity_weight, desc.trajectory_position_weight,
+                            desc.trajectory_facing_weight};
+  for (float w : weights) {
+    if (!std::isfinite(w) || w <= 0.f) return set_err(OZZ_ERR_INVALID_ARGUMENT, "weights must be positive");
+  }
+  size_t total_frames = 0;
+  for (int32_t c = 0; c < desc.clip_count; ++c) {
+    if (!desc.clips[c]) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null clip");
+    if (desc.clips[c]->anim.num_tracks() != num_joints) return set_err(OZZ_ERR_INVALID_ARGUMENT, "clip tracks do not match skeleton");
+    total_frames += (size_t)std::floor(desc.clips[c]->anim.duration() * desc.sample_rate + 1e-3f) + 1u;
+  }
+  if (total_frames > (size_t)std::numeric_limits<int32_t>::max() / 4) return set_err(OZZ_ERR_INVALID_ARGUMENT, "too many frames");
+
+  const int32_t dims = desc.feature_joint_count * 6 + desc.trajectory_count * 4;
+  ozz::vector<float> raw(total_frames * (size_t)dims);
+  ozz::vector<int32_t> frame_clip(total_frames);
+  ozz::vector<float> frame_ratio(total_frames);
+  MotionSampler sampler(skel, desc);
+  size_t frame = 0;
+  for (int32_t c = 0; c < desc.clip_count; ++c) {
+    const ozz::animation::Animation& anim = desc.clips[c]->anim;
+    const float duration = anim.duration();
+    const size_t frames = (size_t)std::floor(duration * desc.sample_rate + 1e-3f) + 1u;
+    for (size_t k = 0; k < frames; ++k, ++frame) {
+      const float time = std::min((float)k / desc.sample_rate, duration);
+      if (!motion_frame_features(sampler, anim, time, &raw[frame * (size_t)dims])) {
+        return set_err(OZZ_ERR_OZZ, "sampling failed");
+      }
+      frame_clip[frame] = c;
+      frame_ratio[frame] = duration > 0.f ? time / duration : 0.f;
+    }
+  }
+
+  auto* db = alloc_with_ozz_allocator<ozz_motion_db_t>();
+  if (!db) return set_err(OZZ_ERR, "oom");
+  db->num_frames = (int32_t)total_frames;
+  db->num_clips = desc.clip_count;
+  db->dims = dims;
+  db->padded_dims = (dims + 3) & ~3;
+  db->frame_clip = std::move(frame_clip);
+  db->frame_ratio = std::move(frame_ratio);
+
+  // Mean per feature, deviation pooled over each group's features.
+  db->mean.assign((size_t)dims, 0.f);
+  db->scale.assign((size_t)dims, 0.f);
+  double variance[4] = {};
+  int32_t group_dims[4] = {};
+  for (int32_t k = 0; k < dims; ++k) {
+    double sum = 0.0, sum_sq = 0.0;
+    for (size_t f = 0; f < total_frames; ++f) {
+      const double v = raw[f * (size_t)dims + (size_t)k];
+      sum += v;
+      sum_sq += v * v;
+    }
+    const double mean = sum / (double)total_frames;
+    db->mean[(size_t)k] = (float)mean;
+    const int32_t group = motion_feature_group(desc.feature_joint_count, k);
+    variance[group] += std::max(sum_sq / (double)total_frames - mean * mean, 0.0);
+    ++group_dims[group];
+  }
+  for (int32_t k = 0; k < dims; ++k) {
+    const int32_t group = motion_feature_group(desc.feature_joint_count, k);
+    // Floored so a group that barely moves over the database (a clip set
+    // without root motion has a constant trajectory) doesn't blow up noise.
+    const double deviation = std::max(std::sqrt(variance[group] / (double)group_dims[group]), kMotionMinDeviation);
+    db->scale[(size_t)k] = weights[group] / (float)deviation;
+  }
+
+  // Normalized, transposed 4 frames at a time, in whole small boxes; padding
+  // frames repeat the last one and padding features are 0, like padded queries.
+  const size_t groups = (total_frames + kMotionSmallBlock - 1u) / kMotionSmallBlock * (kMotionSmallBlock / 4u);
+  const size_t padded = (size_t)db->padded_dims;
+  db->features.assign(groups * padded * 4u, 0.f);
+  for (size_t f = 0; f < groups * 4u; ++f) {
+    const float* src = &raw[std::min(f, total_frames - 1u) * (size_t)dims];
+    float* lanes = db->features.data() + (f & ~size_t{3}) * padded + (f & 3u);
+    for (int32_t k = 0; k < dims; ++k) {
+      lanes[(size_t)k * 4u] = (src[k] - db->mean[(size_t)k]) * db->scale[(size_t)k];
+    }
+  }
+  build_motion_bounds(db);
+  *out_db = db;
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_motion_db_save_to_file(const ozz_motion_db_t* db, const char* path) {
+  ozz_clear_error();
+  if (!db || !path) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "wb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::OArchive ar(&file);
+  ar << ozz::io::MakeArray(kMotionDbTag);
+  ar << kMotionDbVersion;
+  ar << db->num_frames;
+  ar << db->num_clips;
+  ar << db->dims;
+  ar << ozz::io::MakeArray(db->mean.data(), db->mean.size());
+  ar << ozz::io::MakeArray(db->scale.data(), db->scale.size());
+  ar << ozz::io::MakeArray(db->frame_clip.data(), db->frame_clip.size());
+  ar << ozz::io::MakeArray(db->frame_ratio.data(), db->frame_ratio.size());
+  ar << ozz::io::MakeArray(db->features.data(), db->features.size());
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_motion_db_load_from_file(const char* path, ozz_motion_db_t** out_db) {
+  ozz_clear_error();
+  CozzAllocScope scope(OZZ_ALLOC_ANIMATION);
+  if (!path || !out_db) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  ozz::io::File file(path, "rb");
+  if (!file.opened()) return set_err(OZZ_ERR_IO, "open failed");
+  ozz::io::IArchive ar(&file);
+
+  char tag[sizeof(kMotionDbTag)] = {};
+  int32_t version = 0;
+  if (file.Size() < sizeof(tag) + sizeof(version)) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> ozz::io::MakeArray(tag);
+  if (std::memcmp(tag, kMotionDbTag, sizeof(tag)) != 0) return set_err(OZZ_ERR_OZZ, "tag mismatch");
+  ar >> version;
+  if (version != kMotionDbVersion) return set_err(OZZ_ERR_OZZ, "unsupported motion database version");
+
+  auto* db = alloc_with_ozz_allocator<ozz_motion_db_t>();
+  if (!db) return set_err(OZZ_ERR, "oom");
+  ar >> db->num_frames;
+  ar >> db->num_clips;
+  ar >> db->dims;
+  const bool counts_ok = db->num_frames > 0 && db->num_frames <= std::numeric_limits<int32_t>::max() / 4 &&
+                         db->num_clips > 0 && db->dims > 0 && db->dims <= kMotionMaxDims;
+  const size_t frames = counts_ok ? (size_t)db->num_frames : 0u;
+  const size_t dims = counts_ok ? (size_t)db->dims : 0u;
+  const size_t padded = (dims + 3u) & ~size_t{3};
+  const size_t feature_floats = (frames + kMotionSmallBlock - 1u) / kMotionSmallBlock * kMotionSmallBlock * padded;
+  const size_t payload = (dims * 2u + frames * 2u + feature_floats) * sizeof(float);
+  if (!counts_ok || file.Size() - file.Tell() < payload) {
+    free_with_ozz_allocator(db);
+    return set_err(OZZ_ERR_OZZ, "corrupt motion database");
+  }
+  db->padded_dims = (int32_t)padded;
+  db->mean.resize(dims);
+  db->scale.resize(dims);
+  db->frame_clip.resize(frames);
+  db->frame_ratio.resize(frames);
+  db->features.resize(feature_floats);
+  ar >> ozz::io::MakeArray(db->mean.data(), dims);
+  ar >> ozz::io::MakeArray(db->scale.data(), dims);
+  ar >> ozz::io::MakeArray(db->frame_clip.data(), frames);
+  ar >> ozz::io::MakeArray(db->frame_ratio.data(), frames);
+  ar >> ozz::io::MakeArray(db->features.data(), feature_floats);
+  build_motion_bounds(db);
+  *out_db = db;
+  return OZZ_OK;
+}
+
+void ozz_motion_db_destroy(ozz_motion_db_t* db) { free_with_ozz_allocator(db); }
+
+int32_t ozz_motion_db_frame_count(const ozz_motion_db_t* db) { return db ? db->num_frames : 0; }
+int32_t ozz_motion_db_feature_count(const ozz_motion_db_t* db) { return db ? db->dims : 0; }
+
+ozz_result_t ozz_motion_db_frame_features(const ozz_motion_db_t* db, int32_t frame, float* out_features,
+                                          int32_t out_count) {
+  ozz_clear_error();
+  if (!db || !out_features) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (frame < 0 || frame >= db->num_frames) return set_err(OZZ_ERR_INVALID_ARGUMENT, "frame out of range");
+  if (out_count < db->dims) return set_err(OZZ_ERR_INVALID_ARGUMENT, "output too small");
+  const float* lanes = db->features.data() + (size_t)(frame & ~3) * (size_t)db->padded_dims + (size_t)(frame & 3);
+  for (int32_t k = 0; k < db->dims; ++k) {
+    out_features[k] = lanes[(size_t)k * 4u] / db->scale[(size_t)k] + db->mean[(size_t)k];
+  }
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_motion_db_normalization(const ozz_motion_db_t* db, float* out_mean, float* out_scale,
+                                         int32_t out_count) {
+  ozz_clear_error();
+  if (!db) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (out_count < db->dims) return set_err(OZZ_ERR_INVALID_ARGUMENT, "output too small");
+  if (out_mean) std::memcpy(out_mean, db->mean.data(), db->mean.size() * sizeof(float));
+  if (out_scale) std::memcpy(out_scale, db->scale.data(), db->scale.size() * sizeof(float));
+  return OZZ_OK;
+}
+
+ozz_result_t ozz_motion_db_search(const ozz_motion_db_t* db, const float* queries, int32_t count,
+                                  size_t query_stride, ozz_motion_match_t* out_matches) {
+  ozz_clear_error();
+  HotPathScope hot_path;
+  if (!db || (count > 0 && (!queries || !out_matches))) return set_err(OZZ_ERR_INVALID_ARGUMENT, "null arg");
+  if (count < 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "negative count");
+  if (count > 1 && query_stride < (size_t)db->dims) return set_err(OZZ_ERR_INVALID_ARGUMENT, "query_stride too small");
+
+  const cozz_motion_db_view_t view = {db->num_frames, db->padded_dims, db->features.data(), db->small_bounds.data(),
+                                      db->large_bounds.data()};
+  const cozz_kernels_t* k = kernels();
+  alignas(16) float normalized[kMotionMaxDims] = {};
+  for (int32_t i = 0; i < count; ++i) {
+    const float* query = queries + (size_t)i * query_stride;
+    for (int32_t d = 0; d < db->dims; ++d) {
+      normalized[d] = (query[d] - db->mean[(size_t)d]) * db->scale[(size_t)d];
+    }
+    ozz_motion_match_t& match = out_matches[i];
+    k->motion_search(&view, normalized, &match.frame, &match.cost);
+    if (match.frame < 0) return set_err(OZZ_ERR_INVALID_ARGUMENT, "query features must be finite");
+    match.clip = db->frame_clip[(size_t)match.frame];
+    match.ratio = db->frame_ratio[(size_t)match.frame];
+  }
+  return OZZ_OK;
+}
+
+// ---- track index test hook ----
+// Sends a clip's sampling back to scanning the cache for each key's track, to
+// check both layouts against each other.
+extern "C" void ozz_animation_drop_track_index(ozz_animation_t* anim) {
+  if (anim) anim->anim.DropTrackIndex();
+}
+
+// ---- group varint test hooks ----
+// Expose ozz's GV4 stream codec (iframe cache entries) so the SIMD stream
+// decoder can be checked against decoding one group at a time.
+extern "C" size_t ozz_gv4_encode_stream(const uint32_t* values, size_t count, uint8_t* out, size_t out_capacity) {
+  if (!values || !out || count % 4 != 0) return 0;
+  const ozz::span<const uint32_t> stream(values, count);
+  if (out_capacity < ozz::ComputeGV4WorstBufferSize(stream)) return 0;
+  const ozz::span<ozz::byte> left = ozz::EncodeGV4Stream(stream, ozz::span<ozz::byte>(out, out_capacity));
+  return (size_t)(left.data() - out);
+}
+
+// Input buffers need 3 readable bytes past the encoded data.
+extern "C" size_t ozz_gv4_decode_stream(const uint8_t* in, size_t in_size, uint32_t* values, size_t count) {
+  if (!in || !values || count % 4 != 0 || in_size < count + count / 4) return 0;
+  return kernels()->decode_gv4_stream(in, in_size, values, count);
+}
+
+extern "C" size_t ozz_gv4_decode_stream_reference(const uint8_t* in, size_t in_size, uint32_t* values, size_t count) {
+  if (!in || !values || count % 4 != 0 || in_size < count + count / 4) return 0;
+  ozz::span<const ozz::byte> left(in, in_size);
+  for (size_t i = 0; i < count; i += 4) left = ozz::DecodeGV4(left, ozz::span<uint32_t>(values + i, 4));
+  return (size_t)(left.data() - in);
+}
@@ -14,6 +14,7 @@ typedef enum ozz_result_t {
   OZZ_ERR_INVALID_ARGUMENT = 2,
   OZZ_ERR_IO = 3,
   OZZ_ERR_OZZ = 4,
+  OZZ_ERR_BUSY = 5, // nothing to hand over right now, try again later
 } ozz_result_t;
 
 const char* ozz_last_error(void);
@@ -25,11 +26,75 @@ typedef void (*ozz_dealloc_fn)(void* user_data, void* ptr);
 ozz_result_t ozz_set_external_allocator(void* user_data, ozz_alloc_fn alloc_fn, ozz_dealloc_fn dealloc_fn);
 ozz_result_t ozz_reset_external_allocator(void);
 
+// Built-in allocator: power of two size classes (up to 4 KiB) pooled on one
+// arena per thread, so concurrent loads and offline builds don't contend on
+// malloc. Larger blocks go to malloc. ozz_set_arena_allocator fails while
+// blocks of the previous allocator are still live (objects loaded or created
+// before the switch). Pools keep their memory until
+// ozz_arena_allocator_reset, or until ozz_reset_external_allocator uninstalls
+// the arena; both fail while arena blocks are still live.
+typedef struct ozz_arena_stats_t {
+  size_t live_bytes;         // size class (or large block) bytes not yet freed
+  size_t peak_bytes;         // high-water mark of live_bytes since the last reset
+  size_t reserved_bytes;     // pooled chunks and large blocks held from malloc
+  uint64_t allocations;      // blocks served since the last reset
+  uint64_t large_allocations; // of which above the largest size class
+} ozz_arena_stats_t;
+
+ozz_result_t ozz_set_arena_allocator(void);
+ozz_result_t ozz_arena_allocator_reset(void);
+// One entry per arena (each thread that allocated, exited threads' arenas
+// until the next reset). Fills up to `capacity` entries; `out_count` gets the
+// arena count. `out` may be null to only query the count.
+ozz_result_t ozz_arena_allocator_stats(ozz_arena_stats_t* out, int32_t capacity, int32_t* out_count);
+
+// Every ozz allocation is counted under the category of the cozz entry point
+// that made it, whichever allocator is installed.
+typedef enum ozz_alloc_category_t {
+  OZZ_ALLOC_OTHER = 0,     // outside any tagged entry point
+  OZZ_ALLOC_SKELETON = 1,  // skeleton loads
+  OZZ_ALLOC_ANIMATION = 2, // animation loads
+  OZZ_ALLOC_CONTEXT = 3,   // retargets, LTM partitions, mesh remaps, segment caches (sampling contexts live in
+                           // caller memory)
+  OZZ_ALLOC_OFFLINE = 4,   // cozz_offline builders
+  OZZ_ALLOC_CATEGORY_COUNT = 5,
+} ozz_alloc_category_t;
+
+typedef struct ozz_alloc_counters_t {
+  size_t live_bytes;     // requested bytes not yet freed
+  size_t peak_bytes;     // high-water mark of live_bytes
+  uint64_t live_blocks;
+  uint64_t total_blocks; // blocks allocated since startup
+} ozz_alloc_counters_t;
+
+ozz_result_t ozz_alloc_counters(ozz_alloc_category_t category, ozz_alloc_counters_t* out);
+
+// Debug check for the per-frame paths (eval, skinning, palette and bounds
+// outputs): while enabled, allocations made inside them are counted by
+// ozz_hot_path_allocations. Costs one relaxed load per call when disabled.
+void ozz_set_hot_path_guard(int32_t enabled);
+uint64_t ozz_hot_path_allocations(void);
+
+// Sampling, blending, local-to-model, palette stores and skinning run on the
+// best kernel tier the cpu supports: "avx2" (AVX2/FMA/F16C, x86_64 builds) or
+// "baseline" (the target's default instruction set).
+const char* ozz_kernel_tier(void);
+// Forces a tier by name, null goes back to the best one. Fails with
+// OZZ_ERR_INVALID_ARGUMENT when this build or cpu doesn't have it.
+ozz_result_t ozz_set_kernel_tier(const char* name);
+
 typedef struct ozz_skeleton_t ozz_skeleton_t;
 typedef struct ozz_animation_t ozz_animation_t;
 
 typedef struct ozz_instance_t ozz_instance_t;   // per-entity persistent state
 typedef struct ozz_workspace_t ozz_workspace_t; // per-worker scratch/output
+typedef struct ozz_retarget_t ozz_retarget_t;   // source skeleton -> target skeleton remap
+typedef struct ozz_ltm_partition_t ozz_ltm_partition_t; // skeleton split for parallel local-to-model
+typedef struct ozz_mesh_remap_t ozz_mesh_remap_t;       // joint subset + inverse binds of one (sub)mesh
+typedef struct ozz_baked_clip_t ozz_baked_clip_t;       // quantized model-space palettes of one clip
+typedef struct ozz_motion_db_t ozz_motion_db_t;         // motion-matching pose features of a clip set
+typedef struct ozz_library_t ozz_library_t;             // clips sharing a pool of constant tracks
+typedef struct ozz_segment_cache_t ozz_segment_cache_t; // decompressed keyframes shared by sampling jobs
 
 enum { OZZ_MAX_LAYERS = 8 };
 enum { OZZ_MAX_IK_JOBS = 8 };
@@ -46,8 +111,18 @@ typedef struct ozz_layer_desc_t {
   ozz_layer_mode_t mode;
   const float* joint_weights;   // optional scalar weights, one per joint
   int32_t joint_weights_count;  // expected to be >= skeleton joint count
+  const ozz_retarget_t* retarget; // optional: anim is authored on retarget's source skeleton,
+                                  // or is a sparse-track clip (see ozz_retarget_create_sparse)
+  const ozz_baked_clip_t* baked;  // optional: sampled at ratio instead of anim (see ozz_baked_clip_create)
+  int32_t baked_nearest;          // 1 takes the closest baked frame instead of lerping two
 } ozz_layer_desc_t;
 
+// Local-to-model kernel used by ozz_eval_model_3x4.
+typedef enum ozz_ltm_mode_t {
+  OZZ_LTM_DEPTH_FIRST = 0, // ozz LocalToModelJob
+  OZZ_LTM_LEVEL_SOA = 1,   // joints grouped by depth, whole SoA groups per multiply
+} ozz_ltm_mode_t;
+
 typedef struct ozz_vec3_t { float x, y, z; } ozz_vec3_t;
 
 typedef enum ozz_ik_kind_t {
@@ -89,27 +164,368 @@ int32_t ozz_skeleton_find_joint(const ozz_skeleton_t* skel, const char* name);
 const char* ozz_skeleton_joint_name(const ozz_skeleton_t* skel, int32_t joint);
 int32_t ozz_skeleton_joint_parent(const ozz_skeleton_t* skel, int32_t joint);
 float   ozz_animation_duration(const ozz_animation_t* anim);
+size_t  ozz_animation_size_bytes(const ozz_animation_t* anim); // ozz Animation::size()
+
+// Baked model-space clips (far LOD crowds)
+// A clip's model-space palettes sampled on its skeleton at frame_rate frames
+// per second, first and last frame included, and quantized to 16 bits per
+// matrix float: 32 bytes per joint and frame. A layer with `baked` set turns the
+// instance's eval into a frame lookup, with no sampling, blending or
+// local-to-model. It must be the instance's only layer, without IK jobs, and
+// only full evals (ozz_eval_model_3x4 and its _into, _at, _ring and batch
+// forms) take it.
+ozz_result_t ozz_baked_clip_create(const ozz_skeleton_t* skel, const ozz_animation_t* anim, float frame_rate,
+                                   ozz_baked_clip_t** out_clip);
+ozz_result_t ozz_baked_clip_load_from_file(const char* path, ozz_baked_clip_t** out_clip);
+ozz_result_t ozz_baked_clip_save_to_file(const ozz_baked_clip_t* clip, const char* path);
+void ozz_baked_clip_destroy(ozz_baked_clip_t* clip);
+int32_t ozz_baked_clip_num_joints(const ozz_baked_clip_t* clip);
+int32_t ozz_baked_clip_num_frames(const ozz_baked_clip_t* clip);
+float ozz_baked_clip_duration(const ozz_baked_clip_t* clip);
+
+// Animation libraries
+// Clips packed together so that their constant SoA tracks (4 joints whose
+// translation, rotation or scale never changes in the clip, see ozz
+// AnimationBuilder) are stored once per distinct value, in a pool that every
+// clip of the library reads. Static props, rest-pose fingers and unscaled
+// joints then cost one pool entry for the whole library. Library clips are
+// owned by the library: they go in layers like any clip, until the library is
+// destroyed, and never to ozz_animation_destroy.
+ozz_result_t ozz_library_create(const ozz_animation_t* const* clips, int32_t count, ozz_library_t** out_lib);
+ozz_result_t ozz_library_load_from_file(const char* path, ozz_library_t** out_lib);
+ozz_result_t ozz_library_save_to_file(const ozz_library_t* lib, const char* path);
+void ozz_library_destroy(ozz_library_t* lib);
+int32_t ozz_library_num_clips(const ozz_library_t* lib);
+const ozz_animation_t* ozz_library_clip(const ozz_library_t* lib, int32_t index); // in create order
+int32_t ozz_library_pool_entries(const ozz_library_t* lib); // distinct constant values, all components
+// The pool plus every clip's ozz_animation_size_bytes, which leaves pooled
+// values out.
+size_t ozz_library_size_bytes(const ozz_library_t* lib);
+
+// Shared keyframe segments
+// Sampling a clip first decompresses the keyframes around the ratio, for every
+// animated track, then interpolates them. Those keyframes only change when the
+// ratio crosses one of the clip's timepoints, so crowds playing the same clips
+// at nearby ratios decompress the same data over and over in their own
+// contexts. While a segment cache is installed, every sampling job of the
+// process first looks for its (clip, timepoint interval) there and
+// interpolates straight from it, and otherwise publishes what it decompressed.
+// Results are the same as without a cache.
+// - Memory is fixed at create: budget_bytes is split in slots for clips of up
+//   to max_tracks tracks (joints, as in the _ex sizes), grouped in sets of 4
+//   evicted least recently used first. Bigger clips bypass the cache.
+// - Lookups take no lock and never allocate. A job that raced a publisher
+//   over the same slot samples again on its own; a job that finds another
+//   thread publishing doesn't publish.
+// - Clips are told apart by a per-load id, not by address.
+typedef struct ozz_segment_cache_desc_t {
+  int32_t max_tracks;  // tracks (joints) of the biggest clip to cache
+  size_t budget_bytes; // slot memory, at least 4 slots
+} ozz_segment_cache_desc_t;
+
+typedef struct ozz_segment_cache_stats_t {
+  uint64_t hits;      // jobs sampled from a shared segment
+  uint64_t misses;    // jobs that decompressed their own
+  uint64_t conflicts; // lookups whose slot was rewritten while sampling, then sampled again
+  uint64_t bypasses;  // jobs on clips too big for a slot
+  uint64_t inserts;
+  uint64_t evictions;
+  size_t bytes;       // slot memory
+  int32_t slots;
+} ozz_segment_cache_stats_t;
+
+ozz_result_t ozz_segment_cache_create(const ozz_segment_cache_desc_t* desc, ozz_segment_cache_t** out_cache);
+void ozz_segment_cache_destroy(ozz_segment_cache_t* cache);
+// Installs cache for every sampling job, null uninstalls it. A cache must stay
+// alive while installed and until evals that started before uninstalling are
+// done.
+void ozz_set_segment_cache(ozz_segment_cache_t* cache);
+ozz_segment_cache_t* ozz_segment_cache(void); // installed cache or null
+// Counters are relaxed: exact once the evals they count are done.
+void ozz_segment_cache_stats(const ozz_segment_cache_t* cache, ozz_segment_cache_stats_t* out);
+
+// Motion matching
+// A pose database samples a set of clips at a fixed rate. Every frame gets a
+// feature vector, in the root's character space (origin at the root joint,
+// rotated about +y so its facing axis points along +z):
+//   per feature joint: position xyz, then velocity xyz
+//   per trajectory time: root position xz, then facing xz, that many seconds
+//   ahead (clamped to the clip's end)
+// Features are normalized per group (joint positions, joint velocities,
+// trajectory positions, trajectory facings) by their mean and deviation over
+// the database, then scaled by the group's weight. A search returns the frame
+// closest to a query, by squared distance between normalized features, using
+// per-block bounding boxes to skip most of the database. Databases are
+// immutable once built and may be searched from any number of threads.
+enum { OZZ_MOTION_MAX_FEATURE_JOINTS = 16 };
+enum { OZZ_MOTION_MAX_TRAJECTORY = 8 };
+
+typedef struct ozz_motion_db_desc_t {
+  const ozz_animation_t* const* clips; // tracks match the skeleton's joints
+  int32_t clip_count;
+  const int32_t* feature_joints;       // up to OZZ_MOTION_MAX_FEATURE_JOINTS
+  int32_t feature_joint_count;
+  const float* trajectory_times;       // seconds ahead, up to OZZ_MOTION_MAX_TRAJECTORY
+  int32_t trajectory_count;
+  int32_t root_joint;
+  int32_t facing_axis;                 // root model matrix column pointing forward: 0 x, 1 y, 2 z
+  float sample_rate;                   // frames per second; 0 means 30
+  float position_weight;               // group weights, all positive
+  float velocity_weight;
+  float trajectory_position_weight;
+  float trajectory_facing_weight;
+} ozz_motion_db_desc_t;
+
+typedef struct ozz_motion_match_t {
+  int32_t clip;  // index into the desc's clips
+  float ratio;   // of the matched frame in its clip
+  int32_t frame; // database frame, for ozz_motion_db_frame_features
+  float cost;    // squared distance between normalized features
+} ozz_motion_match_t;
+
+ozz_result_t ozz_motion_db_create(const ozz_skeleton_t* skel, const ozz_motion_db_desc_t* desc,
+                                  ozz_motion_db_t** out_db);
+ozz_result_t ozz_motion_db_load_from_file(const char* path, ozz_motion_db_t** out_db);
+ozz_result_t ozz_motion_db_save_to_file(const ozz_motion_db_t* db, const char* path);
+void ozz_motion_db_destroy(ozz_motion_db_t* db);
+int32_t ozz_motion_db_frame_count(const ozz_motion_db_t* db);
+int32_t ozz_motion_db_feature_count(const ozz_motion_db_t* db);
+// A frame's features as built, in query layout: a character's current pose
+// features usually come from its last match, with the trajectory replaced.
+ozz_result_t ozz_motion_db_frame_features(const ozz_motion_db_t* db, int32_t frame, float* out_features,
+                                          int32_t out_count);
+// Per feature: normalized = (feature - mean) * scale.
+ozz_result_t ozz_motion_db_normalization(const ozz_motion_db_t* db, float* out_mean, float* out_scale,
+                                         int32_t out_count);
+// Best match of each query, query i's features at queries + i * query_stride.
+ozz_result_t ozz_motion_db_search(const ozz_motion_db_t* db, const float* queries, int32_t count,
+                                  size_t query_stride, ozz_motion_match_t* out_matches);
+
+// Retargeting (built once per source/target skeleton pair, shared by every instance)
+// Target joints are mapped to source joints by name. Rotations get the rest-pose
+// delta conj(source_rest) * target_rest applied, translations are scaled by the
+// ratio of rest bone lengths. Unmapped target joints keep their rest pose.
+ozz_result_t ozz_retarget_create(const ozz_skeleton_t* source, const ozz_skeleton_t* target, ozz_retarget_t** out_rt);
+// Same as above with an explicit map: target_to_source[target_joint] = source joint or -1.
+ozz_result_t ozz_retarget_create_with_map(const ozz_skeleton_t* source, const ozz_skeleton_t* target,
+                                          const int32_t* target_to_source, int32_t count,
+                                          ozz_retarget_t** out_rt);
+// Sparse-track clips: the clip only carries the tracks it animates and
+// track_to_joint[track] names the target joint each track drives (-1 ignores
+// the track). Joints without a track are masked out of normal layers, so they
+// stay driven by the other layers, or fall back to the rest pose.
+ozz_result_t ozz_retarget_create_sparse(const ozz_skeleton_t* target,
+                                        const int32_t* track_to_joint, int32_t num_tracks,
+                                        ozz_retarget_t** out_rt);
+void ozz_retarget_destroy(ozz_retarget_t* rt);
+int32_t ozz_retarget_source_joint(const ozz_retarget_t* rt, int32_t target_joint);
+int32_t ozz_retarget_source_tracks(const ozz_retarget_t* rt);
 
 // Instance (persistent, per entity)
 size_t ozz_instance_required_bytes(const ozz_skeleton_t* skel);
 ozz_result_t ozz_instance_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel, ozz_instance_t** out_inst);
+// _ex variants size the sampling context for clips with up to max_tracks tracks
+// (e.g. clips authored on a bigger source skeleton and played through a retarget).
+size_t ozz_instance_required_bytes_ex(const ozz_skeleton_t* skel, int32_t max_tracks);
+ozz_result_t ozz_instance_init_ex(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel, int32_t max_tracks, ozz_instance_t** out_inst);
 void ozz_instance_deinit(ozz_instance_t* inst);
 
 void ozz_instance_set_layers(ozz_instance_t* inst, const ozz_layer_desc_t* layers, int32_t count);
 void ozz_instance_set_ik_jobs(ozz_instance_t* inst, const ozz_ik_job_t* jobs, int32_t count);
+void ozz_instance_set_ltm_mode(ozz_instance_t* inst, ozz_ltm_mode_t mode);
+// Bounds of the instance's skinned mesh instead of its joint positions (see
+// ozz_mesh_remap_set_joint_bounds). Null goes back to joint positions.
+ozz_result_t ozz_instance_set_bounds_mesh(ozz_instance_t* inst, const ozz_mesh_remap_t* mesh);
 
 // Workspace (scratch/output, per worker thread or per batch)
 size_t ozz_workspace_required_bytes(const ozz_skeleton_t* skel);
 ozz_result_t ozz_workspace_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel, ozz_workspace_t** out_ws);
+size_t ozz_workspace_required_bytes_ex(const ozz_skeleton_t* skel, int32_t max_tracks);
+ozz_result_t ozz_workspace_init_ex(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel, int32_t max_tracks, ozz_workspace_t** out_ws);
 void ozz_workspace_deinit(ozz_workspace_t* ws);
 
 // Evaluate: writes palette into workspace
 // Palette format: float[12*num_joints], column-major 3x4 per joint.
 ozz_result_t ozz_eval_model_3x4(ozz_instance_t* inst, ozz_workspace_t* ws);
 
+// Same as ozz_eval_model_3x4, but the palette goes to caller memory (a mapped
+// GPU buffer, a slot in a larger array...): joint j's 12 floats start at
+// out_palette + j * joint_stride, joint_stride >= 12. The workspace palette is
+// not written; bounds still land in the workspace.
+ozz_result_t ozz_eval_model_3x4_into(ozz_instance_t* inst, ozz_workspace_t* ws, float* out_palette, size_t joint_stride);
+
+// One instance of a batch eval. `layers` replaces the instance's layers
+// (as ozz_instance_set_layers) when set; null keeps the current ones.
+typedef struct ozz_batch_item_t {
+  ozz_instance_t* instance;
+  const ozz_layer_desc_t* layers;
+  int32_t layer_count;  // at most OZZ_MAX_LAYERS
+} ozz_batch_item_t;
+
+// Evaluates items in order with one workspace; all instances share its
+// skeleton and none appears twice. Item i's palette goes straight to
+// out_palettes + i * palette_stride floats and, when out_bounds is set, its
+// bounds to out_bounds[2 * i] (min) and [2 * i + 1] (max). The workspace's
+// own palette and bounds are not written. Instances with an update rate only
+// run their full eval when due at `frame` (see ozz_instance_set_update_rate).
+// Stops at the first failing item; out_evaluated (optional) gets how many
+// items were done.
+ozz_result_t ozz_eval_batch_3x4(const ozz_batch_item_t* items, int32_t count, ozz_workspace_t* ws, uint64_t frame,
+                                float* out_palettes, size_t palette_stride, ozz_vec3_t* out_bounds,
+                                int32_t* out_evaluated);
+
+// Update-rate LOD: an instance with an update interval runs its full eval on
+// frames where frame % interval == phase only. Frame-aware evals
+// (ozz_eval_model_3x4_at, ozz_eval_batch_3x4) fill the frames in between from
+// the last two full evals, kept in caller history memory. Going back to a
+// frame before the last full eval drops the history.
+typedef enum ozz_update_mode_t {
+  // Lerp between the last two full evals: smooth, but trails by one interval.
+  // Matrices are lerped as is, so large rotations between evals shrink a bit.
+  OZZ_UPDATE_INTERPOLATE = 0,
+  // Latest full eval moved along by the velocity of joint 0 between the last
+  // two: no lag, but the pose holds until the next full eval.
+  OZZ_UPDATE_EXTRAPOLATE_ROOT = 1,
+} ozz_update_mode_t;
+
+size_t ozz_update_history_required_bytes(const ozz_skeleton_t* skel);
+// interval 1 (the default) evaluates every frame and takes no history. A
+// negative phase takes the next one of a process-wide round robin, which
+// spreads a crowd's full evals evenly over the interval. Clears the history.
+ozz_result_t ozz_instance_set_update_rate(ozz_instance_t* inst, int32_t interval, int32_t phase,
+                                          ozz_update_mode_t mode, void* history_mem, size_t history_bytes);
+// 1 when a frame-aware eval at `frame` runs the full eval, else 0.
+int32_t ozz_instance_update_due(const ozz_instance_t* inst, uint64_t frame);
+// ozz_eval_model_3x4 at `frame`: palette and bounds go to the workspace. Its
+// model matrices (dual quaternions, mesh palettes) are the palette's, on
+// filled in frames too.
+ozz_result_t ozz_eval_model_3x4_at(ozz_instance_t* inst, ozz_workspace_t* ws, uint64_t frame);
+
+// Palette ring: depth published evals of one instance, handed from the eval
+// thread to readers (typically the render thread) without copies. The writer
+// fills an idle slot and publishes it atomically; readers pin the latest
+// published slot until they release it. With readers pinning at most k slots
+// at once, depth k + 2 never blocks the writer. One writer at a time.
+typedef struct ozz_palette_ring_t ozz_palette_ring_t;
+
+typedef struct ozz_palette_ring_desc_t {
+  int32_t depth;        // slots, at least 2
+  size_t joint_stride;  // floats between joints, >= 12; 0 means 12
+  float* slots;         // optional caller storage (e.g. mapped GPU memory), else placed in mem
+  size_t slot_stride;   // floats between caller slots; 0 packs them
+} ozz_palette_ring_desc_t;
+
+typedef struct ozz_palette_frame_t {
+  const float* palette;  // joint j at palette + j * joint_stride
+  size_t joint_stride;
+  ozz_vec3_t bounds_min;
+  ozz_vec3_t bounds_max;
+  uint64_t sequence;     // 1 for the first published eval, then increasing
+  int32_t slot;          // for ozz_palette_ring_release
+} ozz_palette_frame_t;
+
+size_t ozz_palette_ring_required_bytes(const ozz_skeleton_t* skel, const ozz_palette_ring_desc_t* desc);
+ozz_result_t ozz_palette_ring_init(void* mem, size_t mem_bytes, const ozz_skeleton_t* skel,
+                                   const ozz_palette_ring_desc_t* desc, ozz_palette_ring_t** out_ring);
+// Evaluates into an idle slot and publishes it. OZZ_ERR_BUSY when readers pin
+// every other slot; a failed eval publishes nothing.
+ozz_result_t ozz_eval_model_3x4_ring(ozz_instance_t* inst, ozz_workspace_t* ws, ozz_palette_ring_t* ring);
+// Pins the latest published eval; OZZ_ERR_BUSY until the first one.
+ozz_result_t ozz_palette_ring_acquire(ozz_palette_ring_t* ring, ozz_palette_frame_t* out_frame);
+void ozz_palette_ring_release(ozz_palette_ring_t* ring, int32_t slot);
+
+// Parallel local-to-model for large skeletons (built once per skeleton).
+// Joints above split_depth form the trunk, every joint at split_depth roots an
+// independent subtree. Subtrees are balanced by joint count into at most
+// max_tasks tasks.
+ozz_result_t ozz_ltm_partition_create(const ozz_skeleton_t* skel, int32_t split_depth, int32_t max_tasks,
+                                      ozz_ltm_partition_t** out_partition);
+void ozz_ltm_partition_destroy(ozz_ltm_partition_t* partition);
+int32_t ozz_ltm_partition_task_count(const ozz_ltm_partition_t* partition);
+int32_t ozz_ltm_partition_task_joints(const ozz_ltm_partition_t* partition, int32_t task);
+int32_t ozz_ltm_partition_trunk_joints(const ozz_ltm_partition_t* partition);
+
+// Staged evaluation, same palette as ozz_eval_model_3x4:
+//   ozz_eval_locals -> ozz_eval_ltm_trunk -> ozz_eval_ltm_task for every task.
+// Tasks of one eval may run concurrently on any threads, in any order.
+ozz_result_t ozz_eval_locals(ozz_instance_t* inst, ozz_workspace_t* ws);
+ozz_result_t ozz_eval_ltm_trunk(ozz_instance_t* inst, ozz_workspace_t* ws, const ozz_ltm_partition_t* partition);
+ozz_result_t ozz_eval_ltm_task(ozz_instance_t* inst, ozz_workspace_t* ws, const ozz_ltm_partition_t* partition, int32_t task);
+// Bounds are reduced while ozz_eval_model_3x4 stores the palette. Staged
+// evaluation computes them once every task is done, with this.
+ozz_result_t ozz_eval_bounds(const ozz_instance_t* inst, ozz_workspace_t* ws);
+
 // Access palette from workspace (valid until next eval on that workspace)
 const float* ozz_workspace_palette_3x4(const ozz_workspace_t* ws);
 int32_t      ozz_workspace_palette_floats(const ozz_workspace_t* ws); // = 12*num_joints
+// Model-space AABB of the last eval, for culling.
+ozz_result_t ozz_workspace_bounds(const ozz_workspace_t* ws, ozz_vec3_t* out_min, ozz_vec3_t* out_max);
+
+// Converts the last eval's model matrices to unit dual quaternions for dual
+// quaternion skinning, 8 floats per joint (real xyzw, dual xyzw).
+// inverse_binds_3x4 (optional, palette layout, one per joint) is applied
+// first. Scale is dropped; degenerate matrices keep their translation only.
+ozz_result_t ozz_workspace_dual_quats(const ozz_workspace_t* ws, const float* inverse_binds_3x4,
+                                      float* out_dual_quats, int32_t out_floats); // >= 8*num_joints
+
+// Mesh palettes (registered once per mesh, shared by every instance)
+// joints[k] is the skeleton joint behind the mesh's k-th skinning index, and
+// inverse_binds_3x4 (palette layout, count entries) its inverse bind matrix.
+// Mesh palettes hold count skinning matrices (model * inverse bind), so a
+// draw uploads, and skinning gathers, only the joints the mesh references.
+ozz_result_t ozz_mesh_remap_create(const ozz_skeleton_t* skel, const int32_t* joints,
+                                   const float* inverse_binds_3x4, int32_t count,
+                                   ozz_mesh_remap_t** out_mesh);
+void ozz_mesh_remap_destroy(ozz_mesh_remap_t* mesh);
+int32_t ozz_mesh_remap_joint_count(const ozz_mesh_remap_t* mesh);
+// Per mesh joint box (min xyz, max xyz, 6 floats, bind pose) enclosing every
+// vertex the joint influences; min > max marks joints without vertices. Blended
+// vertices stay in the union of their joints' boxes, so instance bounds follow
+// from the boxes alone. Set before the mesh is used by any instance.
+ozz_result_t ozz_mesh_remap_set_joint_bounds(ozz_mesh_remap_t* mesh, const float* boxes, int32_t count);
+
+// From the last eval on ws, in the palette 3x4 / dual quaternion layouts.
+ozz_result_t ozz_workspace_mesh_palette_3x4(const ozz_workspace_t* ws, const ozz_mesh_remap_t* mesh,
+                                            float* out_palette, int32_t out_floats); // >= 12*count
+ozz_result_t ozz_workspace_mesh_dual_quats(const ozz_workspace_t* ws, const ozz_mesh_remap_t* mesh,
+                                           float* out_dual_quats, int32_t out_floats); // >= 8*count
+
+// CPU linear blend skinning, following ozz SkinningJob conventions: each
+// vertex has `influences` joint indices and influences - 1 weights, the last
+// weight being 1 - sum(others). Matrices are skinning matrices (model * inverse
+// bind) in the palette 3x4 layout; normals use the same matrices (no
+// non-uniform scale). Per-vertex data is tightly packed, and every input comes
+// in full or compact precision: set exactly one pointer of each pair.
+// Out-of-range joint indices are clamped to the last matrix.
+//
+// With dual_quats set, vertices are skinned by blending unit dual quaternions
+// instead (see ozz_workspace_dual_quats): twists keep their volume, at the
+// cost of ignoring scale. matrices_3x4 is then unused and matrix_count counts
+// dual quaternions.
+enum { OZZ_MAX_SKINNING_INFLUENCES = 8 };
+
+typedef struct ozz_skinning_desc_t {
+  const float* matrices_3x4;
+  const float* dual_quats;      // 8 floats per joint: real xyzw, dual xyzw
+  int32_t matrix_count;
+  int32_t vertex_count;
+  int32_t influences; // 1..OZZ_MAX_SKINNING_INFLUENCES
+
+  const uint16_t* joints_u16;   // [influences] per vertex
+  const uint8_t* joints_u8;
+  const float* weights_f32;     // [influences - 1] per vertex, unused with 1 influence
+  const uint8_t* weights_unorm8;
+  const float* positions_f32;   // xyz per vertex
+  const uint16_t* positions_f16;
+  const float* normals_f32;     // optional, xyz per vertex
+  const uint16_t* normals_f16;
+
+  float* out_positions;         // xyz per vertex
+  float* out_normals;           // required when normals are given
+} ozz_skinning_desc_t;
+
+// Uses an 8-vertex kernel on the avx2 tier.
+ozz_result_t ozz_skin(const ozz_skinning_desc_t* desc);
 
 #ifdef __cplusplus
 } // extern "C"
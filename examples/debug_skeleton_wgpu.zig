@@ -414,7 +414,7 @@ fn updateSkeletonVertices(demo: *DemoState, time_seconds: f32) !usize {
     const curl_weight = if (demo.controls.enable_additive) @max(0.0, @sin(time_seconds) - 0.5) * 2.0 else 0.0;
     const splay_weight = if (demo.controls.enable_additive) @min(0.0, @sin(-time_seconds) - 0.5) * 2.0 else 0.0;
 
-    demo.inst.setLayers(&[_]zozz.Layer{
+    try demo.inst.setLayers(&[_]zozz.Layer{
         zozz.Layer.atRatio(demo.walk, locomotion_phase, 1.0 - blend, .normal),
         zozz.Layer.atRatio(demo.run, locomotion_phase, blend, .normal),
         zozz.Layer.atRatio(demo.curl, 0.0, curl_weight, .additive),
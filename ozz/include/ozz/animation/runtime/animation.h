@@ -50,6 +50,12 @@ namespace internal {
 struct Float3Key;
 struct QuaternionKey;
 }  // namespace internal
+}  // namespace animation
+namespace math {
+struct SoaFloat3;
+struct SoaQuaternion;
+}  // namespace math
+namespace animation {
 
 // Defines a runtime skeletal animation clip.
 // The runtime animation data structure stores animation keyframes, for all the
@@ -61,6 +67,8 @@ struct QuaternionKey;
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
 // time, then by track number.
+// SoA tracks whose 4 tracks never change are not keyed: their value is stored
+// once as a constant, and sampling copies it rather than interpolating keys.
 class OZZ_ANIMATION_DLL Animation {
  public:
   // Builds a default animation.
@@ -97,12 +105,18 @@ class OZZ_ANIMATION_DLL Animation {
   struct TKeyframesCtrl {
     size_t size_bytes() const {
       return ratios.size_bytes() + previouses.size_bytes() +
-             iframe_entries.size_bytes() + iframe_desc.size_bytes();
+             tracks.size_bytes() + iframe_entries.size_bytes() +
+             iframe_desc.size_bytes() + end_entries.size_bytes() +
+             keyed_soa_tracks.size_bytes() + constant_soa_tracks.size_bytes() +
+             constant_entries.size_bytes();
     }
 
     // Implicit conversion to const.
     operator TKeyframesCtrl<true>() const {
-      return {ratios, previouses, iframe_entries, iframe_desc, iframe_interval};
+      return {ratios,           previouses,          tracks,
+              iframe_entries,   iframe_desc,         end_entries,
+              keyed_soa_tracks, constant_soa_tracks, constant_entries,
+              iframe_interval};
     }
 
     template <typename _Ty, bool>
@@ -121,6 +135,11 @@ class OZZ_ANIMATION_DLL Animation {
     // Offsets from the previous keyframe of the same track.
     span<typename ConstQualifier<uint16_t, _Const>::type> previouses;
 
+    // Track of every keyframe, so sampling finds the cache entry a key updates
+    // without scanning. Not serialized: loading derives it from previouses.
+    // Empty when dropped (see DropTrackIndex).
+    span<typename ConstQualifier<uint16_t, _Const>::type> tracks;
+
     // Cached iframe entries packed with GV4 encoding.
     span<typename ConstQualifier<byte, _Const>::type> iframe_entries;
 
@@ -129,6 +148,26 @@ class OZZ_ANIMATION_DLL Animation {
     // 2. Maximum key index (latest updated key).
     span<typename ConstQualifier<uint32_t, _Const>::type> iframe_desc;
 
+    // Cache entries once every keyframe is read, aka the last keyframe of each
+    // track. Lets seeking toward the end start from there and rewind, as
+    // seeking toward the beginning starts from the first keyframes. Not
+    // serialized, derived with tracks. Empty if tracks couldn't be derived.
+    span<typename ConstQualifier<uint32_t, _Const>::type> end_entries;
+
+    // SoA tracks that are keyed, in ascending order. Keyframes, cache entries
+    // and iframes only cover those, so track numbers above index keyed SoA
+    // tracks rather than animation ones. Not serialized: it's the complement
+    // of constant_soa_tracks.
+    span<typename ConstQualifier<uint16_t, _Const>::type> keyed_soa_tracks;
+
+    // SoA tracks stored once as a constant, in ascending order.
+    span<typename ConstQualifier<uint16_t, _Const>::type> constant_soa_tracks;
+
+    // Index of each constant SoA track's value in the constants, when those
+    // are a pool shared with other animations (see LoadShared). Empty when
+    // the animation owns its constants, stored in constant_soa_tracks order.
+    span<typename ConstQualifier<uint32_t, _Const>::type> constant_entries;
+
     // Interval, used at runtime to index iframe_desc.
     float iframe_interval = 0.f;
   };
@@ -141,31 +180,79 @@ class OZZ_ANIMATION_DLL Animation {
   span<const internal::Float3Key> translations_values() const {
     return translations_values_;
   }
+  // Gets the values of constant_soa_tracks, in the same order unless the
+  // animation reads them from a pool (see constant_entries).
+  span<const math::SoaFloat3> translations_constants() const {
+    return translations_constants_;
+  }
 
   // Gets the buffer of rotation keys.
   KeyframesCtrlConst rotations_ctrl() const { return rotations_ctrl_; }
   span<const internal::QuaternionKey> rotations_values() const {
     return rotations_values_;
   }
+  span<const math::SoaQuaternion> rotations_constants() const {
+    return rotations_constants_;
+  }
 
   // Gets the buffer of scale keys.
   KeyframesCtrlConst scales_ctrl() const { return scales_ctrl_; }
   span<const internal::Float3Key> scales_values() const {
     return scales_values_;
   }
+  span<const math::SoaFloat3> scales_constants() const {
+    return scales_constants_;
+  }
 
-  // Get the estimated animation's size in bytes.
+  // Get the estimated animation's size in bytes. Pooled constant values aren't
+  // counted, they belong to the pool.
   size_t size() const;
 
+  // Drops the keyframe to track index, so sampling goes back to scanning the
+  // cache for each key's track. Only meant to benchmark both layouts.
+  void DropTrackIndex();
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Constant SoA track values pooled across the animations of a library.
+  struct ConstantPool {
+    span<math::SoaFloat3> translations;
+    span<math::SoaQuaternion> rotations;
+    span<math::SoaFloat3> scales;
+  };
+
+  // Pool index of every constant SoA track, in constant_soa_tracks order.
+  struct ConstantEntries {
+    span<const uint32_t> translations;
+    span<const uint32_t> rotations;
+    span<const uint32_t> scales;
+  };
+
+  // Saves like Save, at the current version, but writes constant SoA tracks as
+  // pool entries rather than values. The version isn't written: the library
+  // that stores the pool is versioned instead.
+  void SaveShared(ozz::io::OArchive& _archive,
+                  const ConstantEntries& _entries) const;
+
+  // Loads an animation written by SaveShared. Its constant SoA tracks read
+  // their values from _pool, which must outlive the animation. Returns false,
+  // leaving an empty animation, if data or entries are invalid.
+  bool LoadShared(ozz::io::IArchive& _archive, const ConstantPool& _pool);
+
  private:
   // AnimationBuilder class is allowed to instantiate an Animation.
   friend class offline::AnimationBuilder;
 
+  // Saves constants as _entries when set, as values otherwise.
+  void Save(ozz::io::OArchive& _archive,
+            const ConstantEntries* _entries) const;
+  // Reads constants as entries into _pool when set, as values otherwise.
+  bool Load(ozz::io::IArchive& _archive, uint32_t _version,
+            const ConstantPool* _pool);
+
   // Internal memory management functions.
   struct AllocateParams {
     size_t name_len;
@@ -183,6 +270,14 @@ class OZZ_ANIMATION_DLL Animation {
     IFrames translation_iframes;
     IFrames rotation_iframes;
     IFrames scale_iframes;
+
+    // Constant SoA tracks.
+    size_t translation_constants;
+    size_t rotation_constants;
+    size_t scale_constants;
+
+    // Allocates constant entries instead of values, which live in a pool.
+    bool pooled_constants = false;
   };
   void Allocate(const AllocateParams& _params);
   void Deallocate();
@@ -212,11 +307,16 @@ class OZZ_ANIMATION_DLL Animation {
   span<internal::Float3Key> translations_values_;
   span<internal::QuaternionKey> rotations_values_;
   span<internal::Float3Key> scales_values_;
+
+  // Constant SoA tracks values.
+  span<math::SoaFloat3> translations_constants_;
+  span<math::SoaQuaternion> rotations_constants_;
+  span<math::SoaFloat3> scales_constants_;
 };
 }  // namespace animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(7, animation::Animation)
+OZZ_IO_TYPE_VERSION(8, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // namespace io
 }  // namespace ozz
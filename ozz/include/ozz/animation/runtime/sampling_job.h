@@ -44,6 +44,12 @@ namespace animation {
 // Forward declares the animation type to sample.
 class Animation;
 
+namespace internal {
+// Soa hot data to interpolate.
+struct InterpSoaFloat3;
+struct InterpSoaQuaternion;
+}  // namespace internal
+
 // Samples an animation at a given time ratio in the unit interval [0,1] (where
 // 0 is the beginning of the animation, 1 is the end), to output the
 // corresponding posture in local-space.
@@ -55,8 +61,9 @@ class Animation;
 // and will thus not delete them during job's destruction.
 struct OZZ_ANIMATION_DLL SamplingJob {
   // Validates job parameters. Returns true for a valid job, or false otherwise:
-  // -if any input pointer is nullptr
-  // -if output range is invalid.
+  // -if any input pointer is nullptr (context can be if segment is set)
+  // -if output range is invalid
+  // -if segment doesn't match animation keyed SoA tracks.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -81,6 +88,35 @@ struct OZZ_ANIMATION_DLL SamplingJob {
   // A context object that must be big enough to sample *this animation.
   Context* context = nullptr;
 
+  // Decompressed keyframes of an animation, as a context holds them once it
+  // sampled a ratio: one interpolation pair per keyed SoA track of each
+  // component. They only change when a ratio crosses one of the animation's
+  // timepoints, so every ratio from timepoints()[i] up to timepoints()[i + 1]
+  // samples with the same segment.
+  struct OZZ_ANIMATION_DLL Segment {
+    span<const internal::InterpSoaFloat3> translations;
+    span<const internal::InterpSoaQuaternion> rotations;
+    span<const internal::InterpSoaFloat3> scales;
+
+    // Size of the buffer holding a segment of _animation, see Store.
+    static size_t RequiredBytes(const Animation& _animation);
+
+    // Same, for any animation of up to _max_tracks tracks.
+    static size_t RequiredBytes(int _max_tracks);
+
+    // Copies _segment to _buffer, at least RequiredBytes big and aligned to
+    // Context::kBufferAlignment.
+    static void Store(const Segment& _segment, span<byte> _buffer);
+
+    // The segment of _animation that Store copied to _buffer.
+    static Segment View(const Animation& _animation, span<const byte> _buffer);
+  };
+
+  // Optional segment of *this animation, for ratio. When set, the job
+  // interpolates it instead of updating and decompressing context, which
+  // isn't used and can be nullptr.
+  const Segment* segment = nullptr;
+
   // Job output.
   // The output range to be filled with sampled joints during job execution.
   // If there are less joints in the animation compared to the output range,
@@ -90,12 +126,6 @@ struct OZZ_ANIMATION_DLL SamplingJob {
   span<ozz::math::SoaTransform> output;
 };
 
-namespace internal {
-// Soa hot data to interpolate.
-struct InterpSoaFloat3;
-struct InterpSoaQuaternion;
-}  // namespace internal
-
 // Declares the context object used by the workload to take advantage of the
 // frame coherency of animation sampling.
 class OZZ_ANIMATION_DLL SamplingJob::Context {
@@ -110,6 +140,10 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   // value than _max_tracks.
   explicit Context(int _max_tracks);
 
+  // Constructs a context over a caller provided _buffer, see Resize(int,
+  // span<byte>).
+  Context(int _max_tracks, span<byte> _buffer);
+
   // Disables copy and assignation.
   Context(const Context&) = delete;
   Context& operator=(const Context&) = delete;
@@ -123,6 +157,20 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   // This also implicitly invalidate the context.
   void Resize(int _max_tracks);
 
+  // Same as above, but the context is placed in _buffer instead of being
+  // allocated: no allocator is involved, neither now nor at destruction.
+  // _buffer must be at least RequiredBytes(_max_tracks) big and aligned to
+  // kBufferAlignment, and must outlive the context (or the next Resize).
+  // Returns false, leaving the context empty, if _buffer is too small or
+  // misaligned.
+  bool Resize(int _max_tracks, span<byte> _buffer);
+
+  // Size of the buffer needed to place a context for _max_tracks tracks.
+  static size_t RequiredBytes(int _max_tracks);
+
+  // Alignment of the placement buffer (SoA interpolation data).
+  static constexpr size_t kBufferAlignment = 16;
+
   // Invalidate the context.
   // The SamplingJob automatically invalidates a context when required
   // during sampling. This automatic mechanism is based on the animation
@@ -137,6 +185,12 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   int max_tracks() const { return max_soa_tracks_ * 4; }
   int max_soa_tracks() const { return max_soa_tracks_; }
 
+  // Decompressed keyframes of the ratio last sampled, to share with jobs
+  // sampling the same animation (see SamplingJob::segment). Points into *this
+  // context, so it's valid until the next job runs on it. Empty if the context
+  // is invalid.
+  Segment segment() const;
+
   struct Cache {
     // Points to the keys in the animation that are valid for the current time
     // ratio.
@@ -160,6 +214,9 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
 
   void Deallocate();
 
+  // Dispatches _buffer (sized by RequiredBytes) to the context members.
+  void Distribute(span<byte> _buffer);
+
   // The animation this context refers to. nullptr means that the context is
   // invalid.
   const Animation* animation_;
@@ -170,7 +227,8 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   // The number of soa tracks that can store this context.
   int max_soa_tracks_;
 
-  // Single allocation for the whole context.
+  // Single allocation for the whole context, nullptr when placed in a caller
+  // buffer.
   void* allocation_ = nullptr;
 
   // Context cache instances per component.
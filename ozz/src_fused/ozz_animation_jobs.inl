@@ -0,0 +1,1195 @@
+
+// Sampling, blending and local-to-model jobs: the per-frame code of
+// ozz_animation.cc, included by it and by every cozz kernel tier
+// (cozz/cozz_kernels_avx2.cpp) under the tier's renamed ozz namespace. The
+// tiers link nothing else of the runtime, and nothing in here logs, allocates
+// or serializes: code added here that does fails the tiers' link instead of
+// reaching a stub at runtime.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/encode/group_varint.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#endif
+
+// Includes internal include file animation/runtime/animation_keyframe.h
+
+#ifndef OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+#define OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Offset to previous keyframes are stored on uint16_t.
+enum Constants { kMaxPreviousOffset = (1 << 16) - 1 };
+
+// Define animation key frame types (translation, rotation, scale). Every type
+// as the same base made of the key time ratio and it's track index. This is
+// required as key frames are not sorted per track, but sorted by ratio to favor
+// cache coherency. Key frame values are compressed, according on their type.
+// Decompression is efficient because it's done on SoA data and cached during
+// sampling.
+
+// Defines the float3 key frame type, used for translations and scales.
+// Translation values are stored as half precision floats with 16 bits per
+// component.
+struct OZZ_ANIMATION_DLL Float3Key {
+  uint16_t values[3];
+};
+
+// Defines the rotation key frame type.
+// Rotation value is a quaternion. Quaternion are normalized, which means each
+// component is in range [-1:1]. This property allows to quantize the 3
+// components to 3 signed integer 16 bits values. The 4th component is restored
+// at runtime, using the knowledge that |w| = sqrt(1 - (a^2 + b^2 + c^2)).
+// The sign of this 4th component is stored using 1 bit taken from the track
+// member.
+//
+// In more details, compression algorithm stores the 3 smallest components of
+// the quaternion and restores the largest. The 3 smallest can be pre-multiplied
+// by sqrt(2) to gain some precision indeed.
+struct QuaternionKey {
+  // 2b for the largest component index of the quaternion.
+  // 1b for the sign of the largest component. 1 for negative.
+  // 15b for each component
+  uint16_t values[3];
+
+  // Quantization scale, depends on number of bits.
+  static constexpr int kBits = 15;
+  static constexpr int kiScale = (1 << kBits) - 1;
+  static constexpr float kfScale = 1.f * kiScale;
+};
+
+// Endianness independent load and store
+inline void pack(int _largest, int _sign, const int _cpnt[3],
+                 QuaternionKey* _key) {
+  const uint64_t packed =
+      (_largest & 0x3) | ((_sign & 0x1) << 2) | (_cpnt[0] & 0x7fff) << 3 |
+      uint64_t(_cpnt[1] & 0x7fff) << 18 | (uint64_t(_cpnt[2]) & 0x7fff) << 33;
+  _key->values[0] = packed & 0xffff;
+  _key->values[1] = (packed >> 16) & 0xffff;
+  _key->values[2] = (packed >> 32) & 0xffff;
+}
+
+inline void unpack(const QuaternionKey& _key, int& _biggest, int& _sign,
+                   int _cpnt[3]) {
+  const uint32_t packed = uint32_t(_key.values[0]) >> 3 |
+                          uint32_t(_key.values[1]) << 13 |
+                          uint32_t(_key.values[2]) << 29;
+  _biggest = _key.values[0] & 0x3;
+  _sign = (_key.values[0] >> 2) & 0x1;
+  _cpnt[0] = packed & 0x7fff;
+  _cpnt[1] = (packed >> 15) & 0x7fff;
+  _cpnt[2] = _key.values[2] >> 1;
+}
+
+}  // namespace internal
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
+
+// blending_job.cc
+
+namespace ozz {
+namespace animation {
+
+namespace {
+bool ValidateLayer(const BlendingJob::Layer& _layer, size_t _min_range) {
+  bool valid = true;
+
+  // Tests transforms validity.
+  valid &= _layer.transform.size() >= _min_range;
+
+  // Joint weights are optional.
+  if (!_layer.joint_weights.empty()) {
+    valid &= _layer.joint_weights.size() >= _min_range;
+  } else {
+    valid &= _layer.joint_weights.empty();
+  }
+  return valid;
+}
+}  // namespace
+
+bool BlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for nullptr begin pointers.
+  // Blending layers are mandatory, additive aren't.
+  valid &= !rest_pose.empty();
+  valid &= !output.empty();
+
+  // The rest pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const size_t min_range = rest_pose.size();
+  valid &= output.size() >= min_range;
+
+  // Validates layers.
+  for (const Layer& layer : layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+
+  // Validates additive layers.
+  for (const Layer& layer : additive_layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Macro that defines the process of blending the 1st pass.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out)    \
+  do {                                                 \
+    _out.translation = _in.translation * _simd_weight; \
+    _out.rotation = _in.rotation * _simd_weight;       \
+    _out.scale = _in.scale * _simd_weight;             \
+  } while (void(0), 0)
+
+// Macro that defines the process of blending any pass but the first.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out)                             \
+  do {                                                                        \
+    /* Blends translation. */                                                 \
+    _out.translation = _out.translation + _in.translation * _simd_weight;     \
+    /* Blends rotations, negates opposed quaternions to be sure to choose*/   \
+    /* the shortest path between the two.*/                                   \
+    const math::SimdInt4 sign = math::Sign(Dot(_out.rotation, _in.rotation)); \
+    const math::SoaQuaternion rotation = {                                    \
+        math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),     \
+        math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};    \
+    _out.rotation = _out.rotation + rotation * _simd_weight;                  \
+    /* Blends scales.*/                                                       \
+    _out.scale = _out.scale + _in.scale * _simd_weight;                       \
+  } while (void(0), 0)
+
+// Macro that defines the process of adding a pass.
+#define OZZ_ADD_PASS(_in, _simd_weight, _out)                               \
+  do {                                                                      \
+    _out.translation = _out.translation + _in.translation * _simd_weight;   \
+    /* Interpolate quaternion between identity and src.rotation.*/          \
+    /* Quaternion sign is fixed up, so that lerp takes the shortest path.*/ \
+    const math::SimdInt4 sign = math::Sign(_in.rotation.w);                 \
+    const math::SoaQuaternion interp_quat = {                               \
+        math::Xor(_in.rotation.x, sign) * _simd_weight,                     \
+        math::Xor(_in.rotation.y, sign) * _simd_weight,                     \
+        math::Xor(_in.rotation.z, sign) * _simd_weight,                     \
+        (math::Xor(_in.rotation.w, sign) - one) * _simd_weight + one};      \
+    _out.rotation = _out.rotation * NormalizeEst(interp_quat);              \
+    _out.scale.x = _out.scale.x *                                           \
+                   math::MAdd(_in.scale.x, _simd_weight, one_minus_weight); \
+    _out.scale.y = _out.scale.y *                                           \
+                   math::MAdd(_in.scale.y, _simd_weight, one_minus_weight); \
+    _out.scale.z = _out.scale.z *                                           \
+                   math::MAdd(_in.scale.z, _simd_weight, one_minus_weight); \
+  } while (void(0), 0)
+
+// Macro that defines the process of subtracting a pass.
+#define OZZ_SUB_PASS(_in, _simd_weight, _out)                                  \
+  do {                                                                         \
+    _out.translation = _out.translation - _in.translation * _simd_weight;      \
+    /* Interpolate quaternion between identity and src.rotation.*/             \
+    /* Quaternion sign is fixed up, so that lerp takes the shortest path.*/    \
+    const math::SimdInt4 sign = math::Sign(_in.rotation.w);                    \
+    const math::SoaQuaternion interp_quat = {                                  \
+        math::Xor(_in.rotation.x, sign) * _simd_weight,                        \
+        math::Xor(_in.rotation.y, sign) * _simd_weight,                        \
+        math::Xor(_in.rotation.z, sign) * _simd_weight,                        \
+        (math::Xor(_in.rotation.w, sign) - one) * _simd_weight + one};         \
+    _out.rotation = _out.rotation * Conjugate(NormalizeEst(interp_quat));      \
+    _out.scale.x =                                                             \
+        _out.scale.x *                                                         \
+        math::RcpEst(math::MAdd(_in.scale.x, _simd_weight, one_minus_weight)); \
+    _out.scale.y =                                                             \
+        _out.scale.y *                                                         \
+        math::RcpEst(math::MAdd(_in.scale.y, _simd_weight, one_minus_weight)); \
+    _out.scale.z =                                                             \
+        _out.scale.z *                                                         \
+        math::RcpEst(math::MAdd(_in.scale.z, _simd_weight, one_minus_weight)); \
+  } while (void(0), 0)
+
+// Defines parameters that are passed through blending stages.
+struct ProcessArgs {
+  ProcessArgs(const BlendingJob& _job)
+      : job(_job),
+        num_soa_joints(_job.rest_pose.size()),
+        num_passes(0),
+        num_partial_passes(0),
+        accumulated_weight(0.f) {
+    // The range of all buffers has already been validated.
+    assert(job.output.size() >= num_soa_joints);
+    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
+  }
+
+  // Allocates enough space to store a accumulated weights per-joint.
+  // It will be initialized by the first pass processed, if any.
+  // This is quite big for a stack allocation (4 byte * maximum number of
+  // joints). This is one of the reasons why the number of joints is limited
+  // by the API.
+  // Note that this array is used with SoA data.
+  // This is the first argument in order to avoid wasting too much space with
+  // alignment padding.
+  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+
+  // The job to process.
+  const BlendingJob& job;
+
+  // The number of transforms to process as defined by the size of the rest
+  // pose.
+  size_t num_soa_joints;
+
+  // Number of processed blended passes (excluding passes with a weight <= 0.f),
+  // including partial passes.
+  int num_passes;
+
+  // Number of processed partial blending passes (aka with a weight per-joint).
+  int num_partial_passes;
+
+  // The accumulated weight of all layers.
+  float accumulated_weight;
+
+ private:
+  // Disables assignment operators.
+  ProcessArgs(const ProcessArgs&);
+  void operator=(const ProcessArgs&);
+};
+
+// Blends all layers of the job to its output.
+void BlendLayers(ProcessArgs* _args) {
+  assert(_args);
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer& layer : _args->job.layers) {
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer.transform.size() >= _args->num_soa_joints);
+    assert(layer.joint_weights.empty() ||
+           (layer.joint_weights.size() >= _args->num_soa_joints));
+
+    // Skip irrelevant layers.
+    if (layer.weight <= 0.f) {
+      continue;
+    }
+
+    // Accumulates global weights.
+    _args->accumulated_weight += layer.weight;
+    const math::SimdFloat4 layer_weight =
+        math::simd_float4::Load1(layer.weight);
+
+    if (!layer.joint_weights.empty()) {
+      // This layer has per-joint weights.
+      ++_args->num_partial_passes;
+
+      if (_args->num_passes == 0) {
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          const math::SimdFloat4 weight =
+              layer_weight * math::Max0(layer.joint_weights[i]);
+          _args->accumulated_weights[i] = weight;
+          OZZ_BLEND_1ST_PASS(src, weight, dest);
+        }
+      } else {
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          const math::SimdFloat4 weight =
+              layer_weight * math::Max0(layer.joint_weights[i]);
+          _args->accumulated_weights[i] =
+              _args->accumulated_weights[i] + weight;
+          OZZ_BLEND_N_PASS(src, weight, dest);
+        }
+      }
+    } else {
+      // This is a full layer.
+      if (_args->num_passes == 0) {
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          _args->accumulated_weights[i] = layer_weight;
+          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+        }
+      } else {
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          _args->accumulated_weights[i] =
+              _args->accumulated_weights[i] + layer_weight;
+          OZZ_BLEND_N_PASS(src, layer_weight, dest);
+        }
+      }
+    }
+    // One more pass blended.
+    ++_args->num_passes;
+  }
+}
+
+// Blends rest pose to the output if accumulated weight is less than the
+// threshold value.
+void BlendRestPose(ProcessArgs* _args) {
+  assert(_args);
+
+  // Asserts buffer sizes, which must never fail as it has been validated.
+  assert(_args->job.rest_pose.size() >= _args->num_soa_joints);
+
+  if (_args->num_partial_passes == 0) {
+    // No partial blending pass detected, threshold can be tested globally.
+    const float bp_weight = _args->job.threshold - _args->accumulated_weight;
+
+    if (bp_weight > 0.f) {  // The rest-pose is needed if it has a weight.
+      if (_args->num_passes == 0) {
+        // Strictly copying rest-pose.
+        _args->accumulated_weight = 1.f;
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          _args->job.output[i] = _args->job.rest_pose[i];
+        }
+      } else {
+        // Updates global accumulated weight, but not per-joint weight any more
+        // because normalization stage will be global also.
+        _args->accumulated_weight = _args->job.threshold;
+
+        const math::SimdFloat4 simd_bp_weight =
+            math::simd_float4::Load1(bp_weight);
+
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = _args->job.rest_pose[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+        }
+      }
+    }
+  } else {
+    // Blending passes contain partial blending, threshold must be tested for
+    // each joint.
+    const math::SimdFloat4 threshold =
+        math::simd_float4::Load1(_args->job.threshold);
+
+    // There's been at least 1 pass as num_partial_passes != 0.
+    assert(_args->num_passes != 0);
+
+    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+      const math::SoaTransform& src = _args->job.rest_pose[i];
+      math::SoaTransform& dest = _args->job.output[i];
+      const math::SimdFloat4 bp_weight =
+          math::Max0(threshold - _args->accumulated_weights[i]);
+      _args->accumulated_weights[i] =
+          math::Max(threshold, _args->accumulated_weights[i]);
+      OZZ_BLEND_N_PASS(src, bp_weight, dest);
+    }
+  }
+}
+
+// Normalizes output rotations. Quaternion length cannot be zero as opposed
+// quaternions have been fixed up during blending passes.
+// Translations and scales are already normalized because weights were
+// pre-multiplied by the normalization ratio.
+void Normalize(ProcessArgs* _args) {
+  assert(_args);
+
+  if (_args->num_partial_passes == 0) {
+    // Normalization of a non-partial blending requires to apply the same
+    // division to all joints.
+    const math::SimdFloat4 ratio =
+        math::simd_float4::Load1(1.f / _args->accumulated_weight);
+    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+      math::SoaTransform& dest = _args->job.output[i];
+      dest.rotation = NormalizeEst(dest.rotation);
+      dest.translation = dest.translation * ratio;
+      dest.scale = dest.scale * ratio;
+    }
+  } else {
+    // Partial blending normalization requires to compute the divider per-joint.
+    const math::SimdFloat4 one = math::simd_float4::one();
+    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
+      math::SoaTransform& dest = _args->job.output[i];
+      dest.rotation = NormalizeEst(dest.rotation);
+      dest.translation = dest.translation * ratio;
+      dest.scale = dest.scale * ratio;
+    }
+  }
+}
+
+// Process additive blending pass.
+void AddLayers(ProcessArgs* _args) {
+  assert(_args);
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer& layer : _args->job.additive_layers) {
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer.transform.size() >= _args->num_soa_joints);
+    assert(layer.joint_weights.empty() ||
+           (layer.joint_weights.size() >= _args->num_soa_joints));
+
+    // Prepares constants.
+    const math::SimdFloat4 one = math::simd_float4::one();
+
+    if (layer.weight > 0.f) {
+      // Weight is positive, need to perform additive blending.
+      const math::SimdFloat4 layer_weight =
+          math::simd_float4::Load1(layer.weight);
+
+      if (!layer.joint_weights.empty()) {
+        // This layer has per-joint weights.
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          const math::SimdFloat4 weight =
+              layer_weight * math::Max0(layer.joint_weights[i]);
+          const math::SimdFloat4 one_minus_weight = one - weight;
+          OZZ_ADD_PASS(src, weight, dest);
+        }
+      } else {
+        // This is a full layer.
+        const math::SimdFloat4 one_minus_weight = one - layer_weight;
+
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          OZZ_ADD_PASS(src, layer_weight, dest);
+        }
+      }
+    } else if (layer.weight < 0.f) {
+      // Weight is negative, need to perform subtractive blending.
+      const math::SimdFloat4 layer_weight =
+          math::simd_float4::Load1(-layer.weight);
+
+      if (!layer.joint_weights.empty()) {
+        // This layer has per-joint weights.
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          const math::SimdFloat4 weight =
+              layer_weight * math::Max0(layer.joint_weights[i]);
+          const math::SimdFloat4 one_minus_weight = one - weight;
+          OZZ_SUB_PASS(src, weight, dest);
+        }
+      } else {
+        // This is a full layer.
+        const math::SimdFloat4 one_minus_weight = one - layer_weight;
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          const math::SoaTransform& src = layer.transform[i];
+          math::SoaTransform& dest = _args->job.output[i];
+          OZZ_SUB_PASS(src, layer_weight, dest);
+        }
+      }
+    } else {
+      // Skip layer as its weight is 0.
+    }
+  }
+}
+}  // namespace
+
+bool BlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Initializes blended parameters that are exchanged across blend stages.
+  ProcessArgs process_args(*this);
+
+  // Blends all layers to the job output buffers.
+  BlendLayers(&process_args);
+
+  // Applies rest pose.
+  BlendRestPose(&process_args);
+
+  // Normalizes output.
+  Normalize(&process_args);
+
+  // Process additive blending.
+  AddLayers(&process_args);
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
+
+// local_to_model_job.cc
+
+namespace ozz {
+namespace animation {
+
+bool LocalToModelJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for nullptr begin pointers.
+  if (!skeleton) {
+    return false;
+  }
+
+  const size_t num_joints = static_cast<size_t>(skeleton->num_joints());
+  const size_t num_soa_joints = (num_joints + 3) / 4;
+
+  // Test input and output ranges, implicitly tests for nullptr end pointers.
+  valid &= input.size() >= num_soa_joints;
+  valid &= output.size() >= num_joints;
+
+  return valid;
+}
+
+bool LocalToModelJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const span<const int16_t>& parents = skeleton->joint_parents();
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::Float4x4* root_matrix = (root == nullptr) ? &identity : root;
+
+  // Applies hierarchical transformation.
+  // Loop ends after "to".
+  const int end = math::Min(to + 1, skeleton->num_joints());
+  // Begins iteration from "from", or the next joint if "from" is excluded.
+  // Process next joint if end is not reach. parents[begin] >= from is true as
+  // long as "begin" is a child of "from".
+  for (int i = math::Max(from + from_excluded, 0),
+           process = i < end && (!from_excluded || parents[i] >= from);
+       process;) {
+    // Builds soa matrices from soa transforms.
+    const math::SoaTransform& transform = input[i / 4];
+    const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+
+    // Converts to aos matrices.
+    math::Float4x4 local_aos_matrices[4];
+    math::Transpose16x16(&local_soa_matrices.cols[0].x,
+                         local_aos_matrices->cols);
+
+    // parents[i] >= from is true as long as "i" is a child of "from".
+    for (const int soa_end = (i + 4) & ~3; i < soa_end && process;
+         ++i, process = i < end && parents[i] >= from) {
+      const int parent = parents[i];
+      const math::Float4x4* parent_matrix =
+          parent == Skeleton::kNoParent ? root_matrix : &output[parent];
+      output[i] = *parent_matrix * local_aos_matrices[i & 3];
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
+
+// sampling_job.cc
+
+namespace ozz {
+namespace animation {
+
+namespace internal {
+struct InterpSoaFloat3 {
+  math::SimdFloat4 ratio[2];
+  math::SoaFloat3 value[2];
+};
+struct InterpSoaQuaternion {
+  math::SimdFloat4 ratio[2];
+  math::SoaQuaternion value[2];
+};
+}  // namespace internal
+
+bool SamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for nullptr pointers.
+  if (!animation || (!context && !segment)) {
+    return false;
+  }
+  valid &= !output.empty();
+
+  if (segment) {
+    // Tests segment size.
+    valid &= segment->translations.size() ==
+             animation->translations_ctrl().keyed_soa_tracks.size();
+    valid &= segment->rotations.size() ==
+             animation->rotations_ctrl().keyed_soa_tracks.size();
+    valid &= segment->scales.size() ==
+             animation->scales_ctrl().keyed_soa_tracks.size();
+    return valid;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+
+  // Tests context size.
+  valid &= context->max_soa_tracks() >= num_soa_tracks;
+
+  return valid;
+}
+
+namespace {
+inline uint32_t TrackForward(const ozz::span<const uint32_t> _cache,
+                             const ozz::span<const uint16_t>& _previouses,
+                             uint32_t _key, uint32_t _last_track,
+                             uint32_t _num_tracks) {
+  assert(_key < _previouses.size());
+  assert(_last_track >= 0 && _last_track < _num_tracks);
+
+  const uint32_t target = _key - _previouses[_key];
+  for (uint32_t entry = _last_track; entry < _num_tracks; ++entry) {
+    if (_cache[entry] == target) {
+      return entry;
+    }
+  }
+  for (uint32_t entry = 0;; ++entry) {
+    if (_cache[entry] == target) {
+      return entry;
+    }
+    assert(entry < _last_track && "Previous track should be in cache");
+  }
+}
+
+inline uint32_t TrackBackward(const ozz::span<const uint32_t> _cache,
+                              uint32_t _target, uint32_t _last_track,
+                              uint32_t _num_tracks) {
+  assert(_last_track >= 0 && _last_track < _num_tracks);
+
+  for (uint32_t entry = _last_track;; --entry) {
+    if (_cache[entry] == _target) {
+      return entry;
+    }
+    if (entry == 0) {
+      break;
+    }
+  }
+  for (uint32_t entry = _num_tracks - 1;; --entry) {
+    if (_cache[entry] == _target) {
+      return entry;
+    }
+    assert(entry > _last_track && "Previous track should be in cache");
+  }
+}
+
+inline float KeyRatio(const ozz::span<const float>& _timepoints,
+                      const ozz::span<const byte>& _ratios, size_t _at) {
+  if (_timepoints.size() <= std::numeric_limits<uint8_t>::max()) {
+    return _timepoints[reinterpret_span<const uint8_t>(_ratios)[_at]];
+  } else {
+    return _timepoints[reinterpret_span<const uint16_t>(_ratios)[_at]];
+  }
+}
+
+inline ozz::math::SimdFloat4 KeysRatio(
+    const ozz::span<const float>& _timepoints,
+    const ozz::span<const byte>& _ratios,
+    const ozz::span<const uint32_t>& _ats) {
+  if (_timepoints.size() <= std::numeric_limits<uint8_t>::max()) {
+    const auto& ratios = reinterpret_span<const uint8_t>(_ratios);
+    return ozz::math::simd_float4::Load(
+        _timepoints[ratios[_ats[0]]], _timepoints[ratios[_ats[1]]],
+        _timepoints[ratios[_ats[2]]], _timepoints[ratios[_ats[3]]]);
+  } else {
+    const auto& ratios = reinterpret_span<const uint16_t>(_ratios);
+    return ozz::math::simd_float4::Load(
+        _timepoints[ratios[_ats[0]]], _timepoints[ratios[_ats[1]]],
+        _timepoints[ratios[_ats[2]]], _timepoints[ratios[_ats[3]]]);
+  }
+}
+
+inline uint32_t InitializeCache(const Animation::KeyframesCtrlConst& _ctrl,
+                                size_t _iframe,
+                                const ozz::span<uint32_t>& _entries) {
+  if (_iframe > _ctrl.iframe_desc.size() / 2) {
+    // Past the last iframe, initializes cache entries with the last key frame
+    // of every track. Everything is read.
+    assert(_ctrl.end_entries.size() == _entries.size());
+    std::copy(_ctrl.end_entries.begin(), _ctrl.end_entries.end(),
+              _entries.begin());
+    return static_cast<uint32_t>(_ctrl.previouses.size());
+  } else if (_iframe > 0) {
+    // Initializes cache entries from a compressed cache iframe.
+    size_t iframe = (_iframe - 1) * 2;
+    const size_t offset = _ctrl.iframe_desc[iframe];
+    ozz::DecodeGV4Stream(_ctrl.iframe_entries.subspan(
+                             offset, _ctrl.iframe_entries.size() - offset),
+                         _entries);
+
+    // Find "next" keyframe, aka the one after the last cached one.
+    return _ctrl.iframe_desc[iframe + 1] + 1;
+  } else {
+    // Initializes cache entries with the first 2nd sets of key frames. The
+    // sorting algorithm ensures that the first 2 key frames of a track are
+    // consecutive.
+    const uint32_t num_tracks = static_cast<uint32_t>(_entries.size());
+    for (uint32_t i = 0; i < num_tracks; ++i) {
+      _entries[i] = i + num_tracks;
+    }
+
+    // Next is set to the next unprocessed keyframe
+    return num_tracks * 2;
+  }
+}
+
+// Outdates all entries. It's important to only flag valid soa entries as this
+// is the exit condition of other algorithms.
+inline void OutdateCache(const ozz::span<byte>& _outdated,
+                         size_t _num_soa_tracks) {
+  const size_t num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  size_t i = 0;
+  for (; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[i] = 0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Loops through the sorted key frames and update cache structure.
+void UpdateCache(float _ratio, float _previous_ratio, size_t _num_soa_tracks,
+                 const ozz::span<const float>& _timepoints,
+                 const Animation::KeyframesCtrlConst& _ctrl,
+                 SamplingJob::Context::Cache& _cache) {
+  assert(_num_soa_tracks > 0);
+  const uint32_t num_tracks = static_cast<uint32_t>(_num_soa_tracks * 4);
+  assert(_ctrl.previouses.begin() + num_tracks * 2 <= _ctrl.previouses.end());
+  const uint32_t num_keys = static_cast<uint32_t>(_ctrl.previouses.size());
+
+  uint32_t next = _cache.next;
+  assert(next == 0 || (next >= num_tracks * 2 && next <= num_keys));
+
+  // Initialize cache if needed.
+  const float delta = _ratio - _previous_ratio;
+  if (next == 0 || std::abs(delta) > _ctrl.iframe_interval / 2.f) {
+    int iframe = -1;
+    if (!_ctrl.iframe_desc.empty() || !_ctrl.end_entries.empty()) {
+      // First time, or fast seeking into animation.
+      // Finds the closest iframe to the expected _ratio. The end of the
+      // animation stands for the iframe after the last one, so without iframes
+      // (interval is 1) this picks the closest end, and seeking backward costs
+      // the same as seeking forward.
+      iframe = static_cast<int>(.5f + _ratio / _ctrl.iframe_interval);
+    } else if (next == 0 || delta < 0.f) {
+      // This handles the cases:
+      // - First time, and no iframe
+      // - Time is going backward, seeking toward 0, and no iframe is defined.
+      // In this case it can still be valuable to reset cache to animation
+      // begining.
+      iframe = 0;
+    }
+
+    // Seek to defined keyframe
+    if (iframe >= 0) {
+      next = InitializeCache(_ctrl, iframe, _cache.entries.first(num_tracks));
+      assert(next >= num_tracks * 2 && next <= num_keys);
+
+      // Cache was overwritten, all entries must be flagged as outdated.
+      OutdateCache(_cache.outdated, _num_soa_tracks);
+    }
+  }
+
+  // Reading forward.
+  // Iterates while the cache is not updated with previous key required for
+  // interpolation at _ratio. Thanks to the keyframe sorting, the loop can end
+  // as soon as it finds a key greater that _ratio. It will mean that all the
+  // keys lower than _ratio have been processed, meaning all cache entries are
+  // up to date.
+  uint32_t track = 0;
+  for (; next < num_keys && KeyRatio(_timepoints, _ctrl.ratios,
+                                     next - _ctrl.previouses[next]) <= _ratio;
+       ++next) {
+    // Finds track index.
+    track = _ctrl.tracks.empty()
+                ? TrackForward(_cache.entries, _ctrl.previouses, next, track,
+                               num_tracks)
+                : _ctrl.tracks[next];
+    assert(_cache.entries[track] == next - _ctrl.previouses[next] &&
+           "Wrong cache entry.");
+
+    // Flag this soa entry as outdated.
+    _cache.outdated[track / 32] |= 1 << ((track & 0x1f) / 4);
+
+    // Updates cache.
+    _cache.entries[track] = next;
+  }
+
+  // Rewinds.
+  // Checks if the time of the penultimate key is greater than _ratio, in which
+  // case we need to rewind.
+  for (; KeyRatio(_timepoints, _ctrl.ratios,
+                  (next - 1) - _ctrl.previouses[next - 1]) > _ratio;
+       --next) {
+    assert(next - 1 >= num_tracks * 2);
+
+    // Finds track index.
+    track = _ctrl.tracks.empty()
+                ? TrackBackward(_cache.entries, next - 1, track, num_tracks)
+                : _ctrl.tracks[next - 1];
+
+    // Flag this soa entry as outdated.
+    _cache.outdated[track / 32] |= 1 << ((track & 0x1f) / 4);
+
+    // Updates cache.
+    assert(_cache.entries[track] == next - 1);
+    const uint32_t previous = _ctrl.previouses[_cache.entries[track]];
+    assert(_cache.entries[track] >= previous + num_tracks);
+    _cache.entries[track] -= previous;
+  }
+
+  // Updates next output.
+  assert(next >= num_tracks * 2 && next <= num_keys);
+  _cache.next = next;
+}
+
+template <typename _CompressedKey, typename _DecompressedKey,
+          typename _Decompress>
+inline void Decompress(size_t _num_soa_tracks,
+                       const ozz::span<const float>& _timepoints,
+                       const Animation::KeyframesCtrlConst& _ctrl,
+                       const ozz::span<const _CompressedKey>& _compressed,
+                       const SamplingJob::Context::Cache& _cache,
+                       const ozz::span<_DecompressedKey>& _decompressed,
+                       const _Decompress& _decompress) {
+  const size_t num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (size_t j = 0; j < num_outdated_flags; ++j) {
+    byte outdated = _cache.outdated[j];  // Copy outdated flag
+    _cache.outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    for (size_t i = j * 8; outdated != 0; ++i, outdated >>= 1) {
+      if (!(outdated & 1)) {
+        continue;
+      }
+
+      // Get cache sub part matching this outdated soa entry.
+      const auto& rights = _cache.entries.subspan(i * 4, 4);
+
+      // Left side keys can be found from right ones as we know the offset from
+      // right to left (_previouses).
+      const uint32_t lefts[4] = {rights[0] - _ctrl.previouses[rights[0]],
+                                 rights[1] - _ctrl.previouses[rights[1]],
+                                 rights[2] - _ctrl.previouses[rights[2]],
+                                 rights[3] - _ctrl.previouses[rights[3]]};
+
+      // Decompress left side keyframes and store them in soa structures.
+      const _CompressedKey& k00 = _compressed[lefts[0]];
+      const _CompressedKey& k10 = _compressed[lefts[1]];
+      const _CompressedKey& k20 = _compressed[lefts[2]];
+      const _CompressedKey& k30 = _compressed[lefts[3]];
+      _decompressed[i].ratio[0] = KeysRatio(_timepoints, _ctrl.ratios, lefts);
+      _decompress(k00, k10, k20, k30, &_decompressed[i].value[0]);
+
+      // Decompress right side keyframes and store them in soa structures.
+      const _CompressedKey& k01 = _compressed[rights[0]];
+      const _CompressedKey& k11 = _compressed[rights[1]];
+      const _CompressedKey& k21 = _compressed[rights[2]];
+      const _CompressedKey& k31 = _compressed[rights[3]];
+      _decompressed[i].ratio[1] = KeysRatio(_timepoints, _ctrl.ratios, rights);
+      _decompress(k01, k11, k21, k31, &_decompressed[i].value[1]);
+    }
+  }
+}
+
+inline void DecompressFloat3(const internal::Float3Key& _k0,
+                             const internal::Float3Key& _k1,
+                             const internal::Float3Key& _k2,
+                             const internal::Float3Key& _k3,
+                             math::SoaFloat3* _soa_float3) {
+  _soa_float3->x = math::HalfToFloat(math::simd_int4::Load(
+      _k0.values[0], _k1.values[0], _k2.values[0], _k3.values[0]));
+  _soa_float3->y = math::HalfToFloat(math::simd_int4::Load(
+      _k0.values[1], _k1.values[1], _k2.values[1], _k3.values[1]));
+  _soa_float3->z = math::HalfToFloat(math::simd_int4::Load(
+      _k0.values[2], _k1.values[2], _k2.values[2], _k3.values[2]));
+}
+
+// Defines a mapping table that defines components assignation in the output
+// quaternion.
+static constexpr uint8_t kCpntMapping[4][4] = {
+    {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
+
+inline void DecompressQuaternion(const internal::QuaternionKey& _k0,
+                                 const internal::QuaternionKey& _k1,
+                                 const internal::QuaternionKey& _k2,
+                                 const internal::QuaternionKey& _k3,
+                                 math::SoaQuaternion* _quaternion) {
+  int largests[4], signs[4], values[4][3];
+  internal::unpack(_k0, largests[0], signs[0], values[0]);
+  internal::unpack(_k1, largests[1], signs[1], values[1]);
+  internal::unpack(_k2, largests[2], signs[2], values[2]);
+  internal::unpack(_k3, largests[3], signs[3], values[3]);
+
+  // Selects proper mapping for each key.
+  const uint8_t* m0 = kCpntMapping[largests[0]];
+  const uint8_t* m1 = kCpntMapping[largests[1]];
+  const uint8_t* m2 = kCpntMapping[largests[2]];
+  const uint8_t* m3 = kCpntMapping[largests[3]];
+
+  // Prepares an array of input values, according to the mapping required to
+  // restore quaternion largest component.
+  alignas(16) int cmp_keys[4][4] = {
+      {values[0][m0[0]], values[1][m1[0]], values[2][m2[0]], values[3][m3[0]]},
+      {values[0][m0[1]], values[1][m1[1]], values[2][m2[1]], values[3][m3[1]]},
+      {values[0][m0[2]], values[1][m1[2]], values[2][m2[2]], values[3][m3[2]]},
+      {values[0][m0[3]], values[1][m1[3]], values[2][m2[3]], values[3][m3[3]]},
+  };
+
+  // Rebuilds quaternion from quantized values.
+  const math::SimdFloat4 kScale =
+      math::simd_float4::Load1(math::kSqrt2 / internal::QuaternionKey::kfScale);
+  const math::SimdFloat4 kOffset = math::simd_float4::Load1(-math::kSqrt2_2);
+  math::SimdFloat4 cpnt[4] = {
+      kScale * math::simd_float4::FromInt(
+                   math::simd_int4::LoadPtr(cmp_keys[0])) +
+          kOffset,
+      kScale * math::simd_float4::FromInt(
+                   math::simd_int4::LoadPtr(cmp_keys[1])) +
+          kOffset,
+      kScale * math::simd_float4::FromInt(
+                   math::simd_int4::LoadPtr(cmp_keys[2])) +
+          kOffset,
+      kScale * math::simd_float4::FromInt(
+                   math::simd_int4::LoadPtr(cmp_keys[3])) +
+          kOffset};
+
+  // Zeroed largest components so they're not part of the dot.
+  const math::SimdInt4 mask_f000 = math::simd_int4::mask_f000();
+  const math::SimdInt4 mask_0f00 = math::simd_int4::mask_0f00();
+  const math::SimdInt4 mask_00f0 = math::simd_int4::mask_00f0();
+  const math::SimdInt4 mask_000f = math::simd_int4::mask_000f();
+  cpnt[largests[0]] = math::AndNot(cpnt[largests[0]], mask_f000);
+  cpnt[largests[1]] = math::AndNot(cpnt[largests[1]], mask_0f00);
+  cpnt[largests[2]] = math::AndNot(cpnt[largests[2]], mask_00f0);
+  cpnt[largests[3]] = math::AndNot(cpnt[largests[3]], mask_000f);
+
+  // Get back length of 4th component. Favors performance over accuracy by using
+  // x * RSqrtEst(x) instead of Sqrt(x).
+  // ww0 cannot be 0 because we 're recomputing the largest component.
+  const math::SimdFloat4 dot = cpnt[0] * cpnt[0] + cpnt[1] * cpnt[1] +
+                               cpnt[2] * cpnt[2] + cpnt[3] * cpnt[3];
+  // dot cannot be >= 1, because it does not include the largest component.
+  const math::SimdFloat4 ww0 = math::simd_float4::one() - dot;
+  const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
+
+  // Re-applies 4th component's sign.
+  const math::SimdInt4 sign = math::ShiftL(
+      math::simd_int4::Load(signs[0], signs[1], signs[2], signs[3]), 31);
+  const math::SimdFloat4 restored = math::Or(w0, sign);
+
+  // Re-injects the largest component inside the SoA structure.
+  // Note that largest component is already 0.
+  cpnt[largests[0]] =
+      math::Or(cpnt[largests[0]], math::And(restored, mask_f000));
+  cpnt[largests[1]] =
+      math::Or(cpnt[largests[1]], math::And(restored, mask_0f00));
+  cpnt[largests[2]] =
+      math::Or(cpnt[largests[2]], math::And(restored, mask_00f0));
+  cpnt[largests[3]] =
+      math::Or(cpnt[largests[3]], math::And(restored, mask_000f));
+
+  // Stores result.
+  _quaternion->x = cpnt[0];
+  _quaternion->y = cpnt[1];
+  _quaternion->z = cpnt[2];
+  _quaternion->w = cpnt[3];
+}
+
+// Interpolates keyed soa hot data of a component, and copies its constant
+// soa tracks, up to _output size.
+template <typename _Interp, typename _Value, typename _Lerp>
+void Interpolates(float _anim_ratio, const Animation::KeyframesCtrlConst& _ctrl,
+                  const span<_Interp>& _interps,
+                  const span<const _Value>& _constants,
+                  _Value math::SoaTransform::*_member,
+                  const span<math::SoaTransform>& _output,
+                  const _Lerp& _lerp) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  for (size_t i = 0; i < _ctrl.keyed_soa_tracks.size(); ++i) {
+    const size_t soa = _ctrl.keyed_soa_tracks[i];
+    if (soa >= _output.size()) {
+      break;  // Keyed soa tracks are ascending.
+    }
+    const _Interp& interp = _interps[i];
+    const math::SimdFloat4 ratio = (anim_ratio - interp.ratio[0]) *
+                                   math::RcpEst(interp.ratio[1] - interp.ratio[0]);
+    _output[soa].*_member = _lerp(interp.value[0], interp.value[1], ratio);
+  }
+  for (size_t i = 0; i < _ctrl.constant_soa_tracks.size(); ++i) {
+    const size_t soa = _ctrl.constant_soa_tracks[i];
+    if (soa >= _output.size()) {
+      break;
+    }
+    _output[soa].*_member = _ctrl.constant_entries.empty()
+                                ? _constants[i]
+                                : _constants[_ctrl.constant_entries[i]];
+  }
+}
+
+// Updates the cache and decompresses outdated soa hot values of a component's
+// keyed soa tracks.
+template <typename _CompressedKey, typename _DecompressedKey,
+          typename _Decompress>
+void UpdateKeyed(float _ratio, float _previous_ratio,
+                 const ozz::span<const float>& _timepoints,
+                 const Animation::KeyframesCtrlConst& _ctrl,
+                 const ozz::span<const _CompressedKey>& _compressed,
+                 SamplingJob::Context::Cache& _cache,
+                 const ozz::span<_DecompressedKey>& _decompressed,
+                 const _Decompress& _decompress) {
+  const size_t num_keyed = _ctrl.keyed_soa_tracks.size();
+  if (num_keyed == 0) {
+    return;
+  }
+  UpdateCache(_ratio, _previous_ratio, num_keyed, _timepoints, _ctrl, _cache);
+  Decompress(num_keyed, _timepoints, _ctrl, _compressed, _cache, _decompressed,
+             _decompress);
+}
+}  // namespace
+
+bool SamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Checked during validation
+  assert(segment || context->max_soa_tracks() >= animation->num_soa_tracks());
+
+  // Early out if animation contains no joint.
+  const size_t num_soa_tracks =
+      static_cast<size_t>(animation->num_soa_tracks());
+  if (num_soa_tracks <= 0) {
+    return true;
+  }
+
+  // Clamps ratio in range [0,duration].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // A segment already holds the keyframes to interpolate.
+  Segment decompressed;
+  if (segment) {
+    decompressed = *segment;
+  } else {
+    // Step the context to this potentially new animation and ratio.
+    const float previous_ratio = context->Step(*animation, clamped_ratio);
+
+    // Update cache with animation keyframe indexes for t = ratio.
+    // Decompresses outdated soa hot values.
+    UpdateKeyed(clamped_ratio, previous_ratio, animation->timepoints(),
+                animation->translations_ctrl(),
+                animation->translations_values(), context->translations_cache_,
+                context->translations_, &DecompressFloat3);
+    UpdateKeyed(clamped_ratio, previous_ratio, animation->timepoints(),
+                animation->rotations_ctrl(), animation->rotations_values(),
+                context->rotations_cache_, context->rotations_,
+                &DecompressQuaternion);
+    UpdateKeyed(clamped_ratio, previous_ratio, animation->timepoints(),
+                animation->scales_ctrl(), animation->scales_values(),
+                context->scales_cache_, context->scales_, &DecompressFloat3);
+    decompressed = context->segment();
+  }
+
+  // Only interp as much as we have output for.
+  const span<math::SoaTransform> interp_output =
+      output.first(math::Min(output.size(), num_soa_tracks));
+
+  // Interpolates soa hot data, copies constants.
+  // The lerp of the rotation uses the shortest path, because opposed
+  // quaternions were negated during animation build stage (see
+  // AnimationBuilder).
+  const auto lerp = [](const math::SoaFloat3& _a, const math::SoaFloat3& _b,
+                       const math::SimdFloat4& _alpha) {
+    return Lerp(_a, _b, _alpha);
+  };
+  const auto nlerp = [](const math::SoaQuaternion& _a,
+                        const math::SoaQuaternion& _b,
+                        const math::SimdFloat4& _alpha) {
+    return NLerpEst(_a, _b, _alpha);
+  };
+  Interpolates(clamped_ratio, animation->translations_ctrl(),
+               decompressed.translations, animation->translations_constants(),
+               &math::SoaTransform::translation, interp_output, lerp);
+  Interpolates(clamped_ratio, animation->rotations_ctrl(),
+               decompressed.rotations, animation->rotations_constants(),
+               &math::SoaTransform::rotation, interp_output, nlerp);
+  Interpolates(clamped_ratio, animation->scales_ctrl(), decompressed.scales,
+               animation->scales_constants(), &math::SoaTransform::scale,
+               interp_output, lerp);
+
+  return true;
+}
+
+SamplingJob::Segment SamplingJob::Context::segment() const {
+  if (!animation_) {
+    return {};
+  }
+  return {translations_.first(
+              animation_->translations_ctrl().keyed_soa_tracks.size()),
+          rotations_.first(animation_->rotations_ctrl().keyed_soa_tracks.size()),
+          scales_.first(animation_->scales_ctrl().keyed_soa_tracks.size())};
+}
+
+float SamplingJob::Context::Step(const Animation& _animation, float _ratio) {
+  // The cache is invalidated if animation has changed...
+  if (animation_ != &_animation) {
+    Invalidate();
+    animation_ = &_animation;
+  }
+  const float previous_ratio = ratio_;
+  ratio_ = _ratio;
+  return previous_ratio;
+}
+
+void SamplingJob::Context::Invalidate() {
+  animation_ = nullptr;
+  ratio_ = 0.f;
+  translations_cache_.next = 0;
+  rotations_cache_.next = 0;
+  scales_cache_.next = 0;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -512,6 +512,8 @@ FixedRateSamplingTime::FixedRateSamplingTime(float _duration, float _frequency)
 #include "ozz/base/encode/group_varint.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
 #include "ozz/base/memory/allocator.h"
 
 // Internal include file
@@ -811,6 +813,8 @@ void Compress(const span<const float>& _timepoints,
         previouses[src.track] ? &dest_key - previouses[src.track] : 0;
     assert(diff < ozz::animation::internal::kMaxPreviousOffset);
     _base.previouses[i] = static_cast<uint16_t>(diff);
+    _base.tracks[i] = static_cast<uint16_t>(src.track);
+    _base.end_entries[src.track] = static_cast<uint32_t>(i);
 
     // Value
     _compressor(src.key.value, &dest_key);
@@ -1001,6 +1005,92 @@ BuilderIFrames BuildIFrames(const ozz::span<_SortingKey>& _src,
   return iframes;
 }
 
+// SoA tracks whose 4 tracks keep a single value, stored once as constants.
+template <typename _Soa>
+struct BuilderConstants {
+  ozz::vector<uint16_t> keyed;
+  ozz::vector<uint16_t> soa_tracks;
+  ozz::vector<_Soa> values;
+};
+
+math::SoaFloat3 ToSoa(const math::Float3* _values) {
+  return {math::simd_float4::Load(_values[0].x, _values[1].x, _values[2].x,
+                                  _values[3].x),
+          math::simd_float4::Load(_values[0].y, _values[1].y, _values[2].y,
+                                  _values[3].y),
+          math::simd_float4::Load(_values[0].z, _values[1].z, _values[2].z,
+                                  _values[3].z)};
+}
+
+math::SoaQuaternion ToSoa(const math::Quaternion* _values) {
+  return {math::simd_float4::Load(_values[0].x, _values[1].x, _values[2].x,
+                                  _values[3].x),
+          math::simd_float4::Load(_values[0].y, _values[1].y, _values[2].y,
+                                  _values[3].y),
+          math::simd_float4::Load(_values[0].z, _values[1].z, _values[2].z,
+                                  _values[3].z),
+          math::simd_float4::Load(_values[0].w, _values[1].w, _values[2].w,
+                                  _values[3].w)};
+}
+
+// Moves SoA tracks whose keys all have the same value to constants, and
+// renumbers remaining keys' tracks to keyed SoA tracks. Must run before
+// sorting, as keys are still grouped per track.
+template <typename _SortingKey, typename _Soa>
+void ExtractConstants(ozz::vector<_SortingKey>* _src, size_t _num_soa_tracks,
+                      BuilderConstants<_Soa>* _constants) {
+  typedef decltype(_src->front().key.value) Value;
+  const size_t num_tracks = _num_soa_tracks * 4;
+  ozz::vector<Value> values(num_tracks);
+  ozz::vector<bool> animated(num_tracks, false);
+  for (size_t i = 0; i < _src->size(); ++i) {
+    const _SortingKey& key = _src->at(i);
+    if (i == 0 || _src->at(i - 1).track != key.track) {
+      values[key.track] = key.key.value;
+    } else if (!(key.key.value == values[key.track])) {
+      animated[key.track] = true;
+    }
+  }
+
+  // Keyed SoA track of each SoA track, -1 for constants.
+  ozz::vector<int> renumbered(_num_soa_tracks, -1);
+  for (size_t i = 0; i < _num_soa_tracks; ++i) {
+    if (animated[i * 4] || animated[i * 4 + 1] || animated[i * 4 + 2] ||
+        animated[i * 4 + 3]) {
+      renumbered[i] = static_cast<int>(_constants->keyed.size());
+      _constants->keyed.push_back(static_cast<uint16_t>(i));
+    } else {
+      _constants->soa_tracks.push_back(static_cast<uint16_t>(i));
+      _constants->values.push_back(ToSoa(&values[i * 4]));
+    }
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < _src->size(); ++i) {
+    _SortingKey key = _src->at(i);
+    const int soa = renumbered[key.track / 4];
+    if (soa >= 0) {
+      key.track = static_cast<uint16_t>(soa * 4 + key.track % 4);
+      _src->at(kept++) = key;
+    }
+  }
+  _src->resize(kept);
+}
+
+template <typename _Soa>
+void CopyConstants(const BuilderConstants<_Soa>& _src,
+                   const Animation::KeyframesCtrl& _ctrl,
+                   const span<_Soa>& _values) {
+  assert(_ctrl.keyed_soa_tracks.size() == _src.keyed.size());
+  std::copy(_src.keyed.begin(), _src.keyed.end(),
+            _ctrl.keyed_soa_tracks.begin());
+  assert(_ctrl.constant_soa_tracks.size() == _src.soa_tracks.size());
+  std::copy(_src.soa_tracks.begin(), _src.soa_tracks.end(),
+            _ctrl.constant_soa_tracks.begin());
+  assert(_values.size() == _src.values.size());
+  std::copy(_src.values.begin(), _src.values.end(), _values.begin());
+}
+
 void CopyIFrames(const BuilderIFrames& _src, Animation::KeyframesCtrl& _dest) {
   assert(_dest.iframe_entries.size() == _src.entries.size());
   std::copy(_src.entries.begin(), _src.entries.end(),
@@ -1082,12 +1172,26 @@ unique_ptr<Animation> AnimationBuilder::operator()(
 
   FixupQuaternions(&sorting_rotations);
 
+  // Stores SoA tracks that never change as constants, only the others are
+  // keyed. Tracks numbers of the keys are renumbered accordingly.
+  BuilderConstants<math::SoaFloat3> translation_constants;
+  ExtractConstants(&sorting_translations, num_soa_tracks / 4,
+                   &translation_constants);
+  BuilderConstants<math::SoaQuaternion> rotation_constants;
+  ExtractConstants(&sorting_rotations, num_soa_tracks / 4,
+                   &rotation_constants);
+  BuilderConstants<math::SoaFloat3> scale_constants;
+  ExtractConstants(&sorting_scales, num_soa_tracks / 4, &scale_constants);
+  const size_t translation_tracks = translation_constants.keyed.size() * 4;
+  const size_t rotation_tracks = rotation_constants.keyed.size() * 4;
+  const size_t scale_tracks = scale_constants.keyed.size() * 4;
+
   // Sort animation keys to favor cache coherency.
-  Sort(sorting_translations, num_soa_tracks, &LerpTranslation,
+  Sort(sorting_translations, translation_tracks, &LerpTranslation,
        &SortingKeyLess<SortingTranslationKey>);
-  Sort(sorting_rotations, num_soa_tracks, &LerpRotation,
+  Sort(sorting_rotations, rotation_tracks, &LerpRotation,
        &SortingKeyLess<SortingQuaternionKey>);
-  Sort(sorting_scales, num_soa_tracks, &LerpScale,
+  Sort(sorting_scales, scale_tracks, &LerpScale,
        &SortingKeyLess<SortingScaleKey>);
 
   // Get all timepoints. Shall be done on sorting keys as time points might have
@@ -1109,11 +1213,11 @@ unique_ptr<Animation> AnimationBuilder::operator()(
 
   // Build cache snaphots/iframes.
   const auto& translation_ss =
-      BuildIFrames(make_span(sorting_translations), num_soa_tracks,
+      BuildIFrames(make_span(sorting_translations), translation_tracks,
                    iframe_interval, duration);
   const auto& rotation_ss = BuildIFrames(
-      make_span(sorting_rotations), num_soa_tracks, iframe_interval, duration);
-  const auto& scale_ss = BuildIFrames(make_span(sorting_scales), num_soa_tracks,
+      make_span(sorting_rotations), rotation_tracks, iframe_interval, duration);
+  const auto& scale_ss = BuildIFrames(make_span(sorting_scales), scale_tracks,
                                       iframe_interval, duration);
 
   // Allocate animation members.
@@ -1125,21 +1229,31 @@ unique_ptr<Animation> AnimationBuilder::operator()(
       sorting_scales.size(),
       {translation_ss.entries.size(), translation_ss.desc.size()},
       {rotation_ss.entries.size(), rotation_ss.desc.size()},
-      {scale_ss.entries.size(), scale_ss.desc.size()}};
+      {scale_ss.entries.size(), scale_ss.desc.size()},
+      translation_constants.soa_tracks.size(),
+      rotation_constants.soa_tracks.size(),
+      scale_constants.soa_tracks.size()};
   animation->Allocate(params);
 
+  CopyConstants(translation_constants, animation->translations_ctrl_,
+                animation->translations_constants_);
+  CopyConstants(rotation_constants, animation->rotations_ctrl_,
+                animation->rotations_constants_);
+  CopyConstants(scale_constants, animation->scales_ctrl_,
+                animation->scales_constants_);
+
   CopyIFrames(translation_ss, animation->translations_ctrl_);
   CopyIFrames(rotation_ss, animation->rotations_ctrl_);
   CopyIFrames(scale_ss, animation->scales_ctrl_);
 
   // Copy sorted keys to final animation.
   Compress(make_span(time_points), make_span(sorting_translations),
-           num_soa_tracks, make_span(animation->translations_values_),
+           translation_tracks, make_span(animation->translations_values_),
            animation->translations_ctrl_, &CompressFloat3);
-  Compress(make_span(time_points), make_span(sorting_rotations), num_soa_tracks,
-           make_span(animation->rotations_values_), animation->rotations_ctrl_,
-           &CompressQuaternion);
-  Compress(make_span(time_points), make_span(sorting_scales), num_soa_tracks,
+  Compress(make_span(time_points), make_span(sorting_rotations),
+           rotation_tracks, make_span(animation->rotations_values_),
+           animation->rotations_ctrl_, &CompressQuaternion);
+  Compress(make_span(time_points), make_span(sorting_scales), scale_tracks,
            make_span(animation->scales_values_), animation->scales_ctrl_,
            &CompressFloat3);
 
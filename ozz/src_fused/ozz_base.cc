@@ -362,6 +362,12 @@ void Extern<string>::Load(IArchive& _archive, string* _values, size_t _count,
 
 #include "ozz/base/encode/group_varint.h"
 
+#include "ozz/base/maths/internal/simd_math_config.h"
+
+#ifdef OZZ_SIMD_SSSE3
+#include "ozz_group_varint_ssse3.inl"
+#endif  // OZZ_SIMD_SSSE3
+
 namespace ozz {
 
 namespace internal {
@@ -391,10 +397,11 @@ OZZ_INLINE uint32_t load(const ozz::byte* _in) {
          static_cast<uint32_t>(_in[2]) << 16 |
          static_cast<uint32_t>(_in[3]) << 24;
 }
+
 }  // namespace internal
 
-inline ozz::span<ozz::byte> EncodeGV4(const ozz::span<const uint32_t>& _input,
-                                      const ozz::span<ozz::byte>& _buffer) {
+ozz::span<ozz::byte> EncodeGV4(const ozz::span<const uint32_t>& _input,
+                               const ozz::span<ozz::byte>& _buffer) {
   assert(_input.size() == 4 && "Input size must be 4");
   assert(_buffer.size_bytes() >= 4 * sizeof(uint32_t) + 1 &&
          "Output buffer is too small.");
@@ -419,7 +426,7 @@ inline ozz::span<ozz::byte> EncodeGV4(const ozz::span<const uint32_t>& _input,
   return {out, _buffer.end()};
 }
 
-inline ozz::span<const ozz::byte> DecodeGV4(
+ozz::span<const ozz::byte> DecodeGV4(
     const ozz::span<const ozz::byte>& _buffer,
     const ozz::span<uint32_t>& _output) {
   assert(_buffer.size_bytes() >= 5 && "Input buffer is too small.");
@@ -473,7 +480,15 @@ ozz::span<const ozz::byte> DecodeGV4Stream(
          "Output buffer is too small");
 
   ozz::span<const ozz::byte> in = _buffer;
-  for (uint32_t* data = _stream.begin(); data < _stream.end(); data += 4) {
+  uint32_t* data = _stream.begin();
+
+#ifdef OZZ_SIMD_SSSE3
+  in = {internal::DecodeGV4GroupsSSSE3(in.data(), _buffer.end(), &data,
+                                       _stream.end()),
+        _buffer.end()};
+#endif  // OZZ_SIMD_SSSE3
+
+  for (; data < _stream.end(); data += 4) {
     in = DecodeGV4(in, {data, 4});
   }
 
@@ -0,0 +1,73 @@
+
+// Group varint stream decoding with one pshufb per group, shared by
+// ozz_base.cc in SSSE3 builds and by the cozz kernel tiers, which compile it
+// with their own target whatever the build's flags. The includer provides
+// SSSE3 code generation.
+
+#ifndef OZZ_GROUP_VARINT_SSSE3_INL_
+#define OZZ_GROUP_VARINT_SSSE3_INL_
+
+#include <tmmintrin.h>
+
+#include <cstdint>
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace internal {
+
+// Per prefix byte: the pshufb mask spreading the group's packed bytes to 4
+// little endian uint32 (0x80 zeroes the unused high bytes), and the group's
+// total size, prefix included.
+struct GV4ShuffleTable {
+  constexpr GV4ShuffleTable() : masks(), sizes() {
+    for (int prefix = 0; prefix < 256; ++prefix) {
+      int src = 0;
+      for (int i = 0; i < 4; ++i) {
+        const int len = ((prefix >> (i * 2)) & 0x3) + 1;
+        for (int b = 0; b < 4; ++b) {
+          masks[prefix][i * 4 + b] =
+              static_cast<uint8_t>(b < len ? src + b : 0x80);
+        }
+        src += len;
+      }
+      sizes[prefix] = static_cast<uint8_t>(src + 1);
+    }
+  }
+  alignas(16) uint8_t masks[256][16];
+  uint8_t sizes[256];
+};
+constexpr GV4ShuffleTable kGV4ShuffleTable;
+
+// Decodes groups from _cursor to *_data until _data_end, with one unaligned 16
+// bytes load and one shuffle per group. Loads read the 16 bytes following the
+// prefix whatever the group size, so this only runs while a full size group
+// (17 bytes) still fits before _end. Returns the first byte left, *_data
+// being the first value left, for the scalar decoder to finish (it reads at
+// most 3 bytes ahead).
+inline const byte* DecodeGV4GroupsSSSE3(const byte* _cursor, const byte* _end,
+                                        uint32_t** _data,
+                                        const uint32_t* _data_end) {
+  if (_end - _cursor < 17) {
+    return _cursor;
+  }
+  const byte* const last = _end - 17;
+  uint32_t* data = *_data;
+  for (; data < _data_end && _cursor <= last; data += 4) {
+    const uint8_t prefix = *_cursor;
+    const __m128i packed =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(_cursor + 1));
+    const __m128i mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(kGV4ShuffleTable.masks[prefix]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data),
+                     _mm_shuffle_epi8(packed, mask));
+    _cursor += kGV4ShuffleTable.sizes[prefix];
+  }
+  *_data = data;
+  return _cursor;
+}
+
+}  // namespace internal
+}  // namespace ozz
+
+#endif  // OZZ_GROUP_VARINT_SSSE3_INL_
@@ -0,0 +1,432 @@
+const std = @import("std");
+
+pub const c = @cImport({
+    @cInclude("cozz_offline.h");
+});
+
+pub const OzzError = error{
+    InvalidArgument,
+    Io,
+    OzzFailure,
+    Unknown,
+};
+
+fn mapResult(rc: c.ozz_result_t) OzzError!void {
+    switch (rc) {
+        c.OZZ_OK => return,
+        c.OZZ_ERR_INVALID_ARGUMENT => return OzzError.InvalidArgument,
+        c.OZZ_ERR_IO => return OzzError.Io,
+        c.OZZ_ERR_OZZ => {
+            std.debug.print("cozz offline error: {s}\n", .{std.mem.span(c.ozz_offline_last_error())});
+            return OzzError.OzzFailure;
+        },
+        else => {
+            std.debug.print("cozz offline error (unknown): {s}\n", .{std.mem.span(c.ozz_offline_last_error())});
+            return OzzError.Unknown;
+        },
+    }
+}
+
+pub fn lastErrorZ() [:0]const u8 {
+    return std.mem.span(c.ozz_offline_last_error());
+}
+
+pub fn clearError() void {
+    c.ozz_offline_clear_error();
+}
+
+// --------------------
+// Skeleton LOD
+// --------------------
+
+pub const SkeletonLodDesc = struct {
+    /// Joints matching one of these ('*' and '?' wildcards) are dropped with their subtree.
+    drop_patterns: []const [*:0]const u8 = &.{},
+    /// Joints deeper than this are dropped, roots being at depth 0. -1 keeps every depth.
+    max_depth: i32 = -1,
+};
+
+/// Writes a reduced copy of the skeleton at `skeleton_path` to `out_path` and
+/// returns the LOD -> full joint table, a prefix of `lod_to_full`.
+/// `full_to_lod`, when given, maps dropped joints to their closest kept ancestor.
+pub fn buildSkeletonLodZ(
+    skeleton_path: [:0]const u8,
+    desc: SkeletonLodDesc,
+    out_path: [:0]const u8,
+    lod_to_full: []i32,
+    full_to_lod: ?[]i32,
+) ![]i32 {
+    const c_desc = c.ozz_skeleton_lod_desc_t{
+        .drop_patterns = @ptrCast(desc.drop_patterns.ptr),
+        .drop_pattern_count = @intCast(desc.drop_patterns.len),
+        .max_depth = desc.max_depth,
+    };
+    var num_joints: i32 = 0;
+    try mapResult(c.ozz_offline_build_skeleton_lod(
+        skeleton_path.ptr,
+        &c_desc,
+        out_path.ptr,
+        lod_to_full.ptr,
+        @intCast(lod_to_full.len),
+        if (full_to_lod) |table| table.ptr else null,
+        if (full_to_lod) |table| @intCast(table.len) else 0,
+        &num_joints,
+    ));
+    return lod_to_full[0..@intCast(num_joints)];
+}
+
+/// Rewrites a full skeleton clip for the LOD skeleton built alongside `lod_to_full`.
+/// `tolerance` (meters) drives key reduction, 0 keeps every resampled key.
+pub fn buildLodAnimationZ(
+    lod_skeleton_path: [:0]const u8,
+    animation_path: [:0]const u8,
+    lod_to_full: []const i32,
+    tolerance: f32,
+    out_path: [:0]const u8,
+) !void {
+    try mapResult(c.ozz_offline_build_lod_animation(
+        lod_skeleton_path.ptr,
+        animation_path.ptr,
+        lod_to_full.ptr,
+        @intCast(lod_to_full.len),
+        tolerance,
+        out_path.ptr,
+    ));
+}
+
+/// Bakes the clip at `animation_path` into a model-space clip at `frame_rate`
+/// frames per second, for the runtime's `BakedClip.loadFromFileZ`.
+pub fn bakeModelClipZ(
+    skeleton_path: [:0]const u8,
+    animation_path: [:0]const u8,
+    frame_rate: f32,
+    out_path: [:0]const u8,
+) !void {
+    try mapResult(c.ozz_offline_bake_model_clip(skeleton_path.ptr, animation_path.ptr, frame_rate, out_path.ptr));
+}
+
+/// Packs the clips at `animation_paths`, in that order, into an animation
+/// library for the runtime's `AnimationLibrary.loadFromFileZ`.
+pub fn packLibraryZ(animation_paths: []const [*:0]const u8, out_path: [:0]const u8) !void {
+    try mapResult(c.ozz_offline_pack_library(
+        @ptrCast(animation_paths.ptr),
+        @intCast(animation_paths.len),
+        out_path.ptr,
+    ));
+}
+
+// --------------------
+// Compression benchmark
+// --------------------
+
+pub const CompressionSetting = extern struct {
+    /// AnimationOptimizer tolerance (meters); 0 skips the optimizer.
+    tolerance: f32 = 1e-3,
+    /// AnimationOptimizer distance (meters).
+    distance: f32 = 1e-1,
+    /// AnimationBuilder iframe interval (seconds); 0 for none.
+    iframe_interval: f32 = 0,
+
+    comptime {
+        std.debug.assert(@sizeOf(CompressionSetting) == @sizeOf(c.ozz_compression_setting_t));
+    }
+};
+
+pub const CompressionSummary = c.ozz_compression_summary_t;
+
+pub const CompressionBenchDesc = struct {
+    skeleton_path: [*:0]const u8,
+    /// RawAnimation archives, or runtime clips resampled at their keys.
+    animation_paths: []const [*:0]const u8,
+    settings: []const CompressionSetting,
+    /// Error and timing samples per second of clip; 0 means 60.
+    sample_rate: f32 = 0,
+    /// Timed playbacks of each built clip; 0 means 8.
+    timing_passes: i32 = 0,
+};
+
+/// Builds every clip at every setting and writes size, build time, sampling
+/// time and per-joint model-space error to the CSV at `out_csv_path`.
+/// Returns the all-joint rows, clip major, as a prefix of `out_summaries`.
+pub fn compressionBenchmarkZ(
+    desc: CompressionBenchDesc,
+    out_csv_path: [:0]const u8,
+    out_summaries: []CompressionSummary,
+) ![]CompressionSummary {
+    const c_desc = c.ozz_compression_bench_desc_t{
+        .skeleton_path = desc.skeleton_path,
+        .animation_paths = @ptrCast(desc.animation_paths.ptr),
+        .animation_count = @intCast(desc.animation_paths.len),
+        .settings = @ptrCast(desc.settings.ptr),
+        .setting_count = @intCast(desc.settings.len),
+        .sample_rate = desc.sample_rate,
+        .timing_passes = desc.timing_passes,
+    };
+    try mapResult(c.ozz_offline_compression_benchmark(
+        &c_desc,
+        out_csv_path.ptr,
+        out_summaries.ptr,
+        @intCast(out_summaries.len),
+    ));
+    return out_summaries[0 .. desc.animation_paths.len * desc.settings.len];
+}
+
+// --------------------
+// Tests
+// --------------------
+
+test "skeleton LOD drops finger chains and rebuilds clips for the reduced skeleton" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var skel_path_buf: [256]u8 = undefined;
+    const skel_path = try std.fmt.bufPrintZ(&skel_path_buf, ".zig-cache/tmp/{s}/lod_skeleton.ozz", .{tmp.sub_path});
+    var anim_path_buf: [256]u8 = undefined;
+    const anim_path = try std.fmt.bufPrintZ(&anim_path_buf, ".zig-cache/tmp/{s}/lod_walk.ozz", .{tmp.sub_path});
+
+    var full: ?*c.ozz_skeleton_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_skeleton_load_from_file("assets/pab_skeleton.ozz", &full));
+    defer c.ozz_skeleton_destroy(full);
+    const full_joints: usize = @intCast(c.ozz_skeleton_num_joints(full));
+
+    var lod_to_full_buf: [1024]i32 = undefined;
+    var full_to_lod_buf: [1024]i32 = undefined;
+    const lod_to_full = try buildSkeletonLodZ(
+        "assets/pab_skeleton.ozz",
+        .{ .drop_patterns = &.{"*Hand?*"} },
+        skel_path,
+        &lod_to_full_buf,
+        full_to_lod_buf[0..full_joints],
+    );
+    try std.testing.expect(lod_to_full.len < full_joints);
+
+    var lod: ?*c.ozz_skeleton_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_skeleton_load_from_file(skel_path.ptr, &lod));
+    defer c.ozz_skeleton_destroy(lod);
+    try std.testing.expectEqual(@as(i32, @intCast(lod_to_full.len)), c.ozz_skeleton_num_joints(lod));
+
+    for (lod_to_full, 0..) |full_joint, j| {
+        try std.testing.expectEqualStrings(
+            std.mem.span(c.ozz_skeleton_joint_name(full, full_joint)),
+            std.mem.span(c.ozz_skeleton_joint_name(lod, @intCast(j))),
+        );
+    }
+
+    // Dropped fingers skin to the hand they hang from.
+    const thumb = c.ozz_skeleton_find_joint(full, "LeftHandThumb1");
+    const hand = c.ozz_skeleton_find_joint(lod, "LeftHand");
+    try std.testing.expect(thumb >= 0 and hand >= 0);
+    try std.testing.expectEqual(@as(i32, -1), c.ozz_skeleton_find_joint(lod, "LeftHandThumb1"));
+    try std.testing.expectEqual(hand, full_to_lod_buf[@intCast(thumb)]);
+
+    try buildLodAnimationZ(skel_path, "assets/pab_walk_no_motion.ozz", lod_to_full, 1e-3, anim_path);
+
+    var source: ?*c.ozz_animation_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file("assets/pab_walk_no_motion.ozz", &source));
+    defer c.ozz_animation_destroy(source);
+
+    var reduced: ?*c.ozz_animation_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file(anim_path.ptr, &reduced));
+    defer c.ozz_animation_destroy(reduced);
+    try std.testing.expectApproxEqAbs(c.ozz_animation_duration(source), c.ozz_animation_duration(reduced), 1e-6);
+}
+
+fn evalPaletteAt(skel: ?*const c.ozz_skeleton_t, anim: ?*const c.ozz_animation_t, ratio: f32, out: []f32) !void {
+    const A = std.testing.allocator;
+    const inst_mem = try A.alignedAlloc(u8, .fromByteUnits(16), c.ozz_instance_required_bytes(skel));
+    defer A.free(inst_mem);
+    const ws_mem = try A.alignedAlloc(u8, .fromByteUnits(16), c.ozz_workspace_required_bytes(skel));
+    defer A.free(ws_mem);
+
+    var inst: ?*c.ozz_instance_t = null;
+    try mapResult(c.ozz_instance_init(inst_mem.ptr, inst_mem.len, skel, &inst));
+    defer c.ozz_instance_deinit(inst);
+    var ws: ?*c.ozz_workspace_t = null;
+    try mapResult(c.ozz_workspace_init(ws_mem.ptr, ws_mem.len, skel, &ws));
+    defer c.ozz_workspace_deinit(ws);
+
+    var layer = std.mem.zeroes(c.ozz_layer_desc_t);
+    layer.anim = anim;
+    layer.ratio = ratio;
+    layer.weight = 1.0;
+    layer.mode = c.OZZ_LAYER_NORMAL;
+    c.ozz_instance_set_layers(inst, &layer, 1);
+    try mapResult(c.ozz_eval_model_3x4(inst, ws));
+    @memcpy(out, c.ozz_workspace_palette_3x4(ws)[0..out.len]);
+}
+
+test "rebuilt clips store unchanging joints once and sample like their source" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var path_buf: [256]u8 = undefined;
+    const path = try std.fmt.bufPrintZ(&path_buf, ".zig-cache/tmp/{s}/run.ozz", .{tmp.sub_path});
+
+    var skel: ?*c.ozz_skeleton_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_skeleton_load_from_file("assets/pab_skeleton.ozz", &skel));
+    defer c.ozz_skeleton_destroy(skel);
+    const num_joints: usize = @intCast(c.ozz_skeleton_num_joints(skel));
+
+    // Every joint kept: translations and scales of most joints never change,
+    // so the rebuilt clip stores them as constants rather than keys.
+    var identity_buf: [1024]i32 = undefined;
+    const identity = identity_buf[0..num_joints];
+    for (identity, 0..) |*joint, j| joint.* = @intCast(j);
+    try buildLodAnimationZ("assets/pab_skeleton.ozz", "assets/pab_run_no_motion.ozz", identity, 0, path);
+
+    var source: ?*c.ozz_animation_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file("assets/pab_run_no_motion.ozz", &source));
+    defer c.ozz_animation_destroy(source);
+    var rebuilt: ?*c.ozz_animation_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file(path.ptr, &rebuilt));
+    defer c.ozz_animation_destroy(rebuilt);
+
+    var expected: [1024 * 12]f32 = undefined;
+    var actual: [1024 * 12]f32 = undefined;
+    for (0..21) |i| {
+        const ratio = @as(f32, @floatFromInt(i)) / 20.0;
+        try evalPaletteAt(skel, source, ratio, expected[0 .. num_joints * 12]);
+        try evalPaletteAt(skel, rebuilt, ratio, actual[0 .. num_joints * 12]);
+        for (expected[0 .. num_joints * 12], actual[0 .. num_joints * 12]) |e, a| {
+            try std.testing.expectApproxEqAbs(e, a, 1e-3);
+        }
+    }
+}
+
+test "packed libraries pool constant tracks and sample like their clips" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var skel: ?*c.ozz_skeleton_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_skeleton_load_from_file("assets/pab_skeleton.ozz", &skel));
+    defer c.ozz_skeleton_destroy(skel);
+    const num_joints: usize = @intCast(c.ozz_skeleton_num_joints(skel));
+    var identity_buf: [1024]i32 = undefined;
+    const identity = identity_buf[0..num_joints];
+    for (identity, 0..) |*joint, j| joint.* = @intCast(j);
+
+    // Rebuilt clips have constant tracks, most of them shared (unit scales,
+    // rest-pose translations). The source clip has none and packs as is.
+    var walk_buf: [256]u8 = undefined;
+    const walk_path = try std.fmt.bufPrintZ(&walk_buf, ".zig-cache/tmp/{s}/walk.ozz", .{tmp.sub_path});
+    try buildLodAnimationZ("assets/pab_skeleton.ozz", "assets/pab_walk_no_motion.ozz", identity, 0, walk_path);
+    var run_buf: [256]u8 = undefined;
+    const run_path = try std.fmt.bufPrintZ(&run_buf, ".zig-cache/tmp/{s}/run.ozz", .{tmp.sub_path});
+    try buildLodAnimationZ("assets/pab_skeleton.ozz", "assets/pab_run_no_motion.ozz", identity, 0, run_path);
+    var lib_buf: [256]u8 = undefined;
+    const lib_path = try std.fmt.bufPrintZ(&lib_buf, ".zig-cache/tmp/{s}/clips.lib", .{tmp.sub_path});
+    const paths = [_][*:0]const u8{ walk_path.ptr, run_path.ptr, "assets/pab_jog_no_motion.ozz" };
+    try packLibraryZ(&paths, lib_path);
+
+    var lib: ?*c.ozz_library_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_library_load_from_file(lib_path.ptr, &lib));
+    defer c.ozz_library_destroy(lib);
+    try std.testing.expectEqual(@as(i32, paths.len), c.ozz_library_num_clips(lib));
+    try std.testing.expect(c.ozz_library_pool_entries(lib) > 0);
+
+    var alone_bytes: usize = 0;
+    var expected: [1024 * 12]f32 = undefined;
+    var actual: [1024 * 12]f32 = undefined;
+    for (paths, 0..) |path, i| {
+        var anim: ?*c.ozz_animation_t = null;
+        try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file(path, &anim));
+        defer c.ozz_animation_destroy(anim);
+        alone_bytes += c.ozz_animation_size_bytes(anim);
+
+        const pooled = c.ozz_library_clip(lib, @intCast(i));
+        for (0..11) |k| {
+            const ratio = @as(f32, @floatFromInt(k)) / 10.0;
+            try evalPaletteAt(skel, anim, ratio, expected[0 .. num_joints * 12]);
+            try evalPaletteAt(skel, pooled, ratio, actual[0 .. num_joints * 12]);
+            try std.testing.expectEqualSlices(f32, expected[0 .. num_joints * 12], actual[0 .. num_joints * 12]);
+        }
+    }
+    try std.testing.expect(c.ozz_library_size_bytes(lib) < alone_bytes);
+}
+
+test "skeleton LOD rejects an undersized remap table" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var skel_path_buf: [256]u8 = undefined;
+    const skel_path = try std.fmt.bufPrintZ(&skel_path_buf, ".zig-cache/tmp/{s}/lod_skeleton.ozz", .{tmp.sub_path});
+
+    var lod_to_full_buf: [2]i32 = undefined;
+    try std.testing.expectError(OzzError.InvalidArgument, buildSkeletonLodZ(
+        "assets/pab_skeleton.ozz",
+        .{ .max_depth = 4 },
+        skel_path,
+        &lod_to_full_buf,
+        null,
+    ));
+}
+
+test "baked clips round-trip through their archive" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var path_buf: [256]u8 = undefined;
+    const path = try std.fmt.bufPrintZ(&path_buf, ".zig-cache/tmp/{s}/walk.bake", .{tmp.sub_path});
+    try bakeModelClipZ("assets/pab_skeleton.ozz", "assets/pab_walk_no_motion.ozz", 30.0, path);
+
+    var skel: ?*c.ozz_skeleton_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_skeleton_load_from_file("assets/pab_skeleton.ozz", &skel));
+    defer c.ozz_skeleton_destroy(skel);
+    var anim: ?*c.ozz_animation_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_animation_load_from_file("assets/pab_walk_no_motion.ozz", &anim));
+    defer c.ozz_animation_destroy(anim);
+    var baked: ?*c.ozz_baked_clip_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_baked_clip_create(skel, anim, 30.0, &baked));
+    defer c.ozz_baked_clip_destroy(baked);
+
+    var loaded: ?*c.ozz_baked_clip_t = null;
+    try std.testing.expectEqual(c.OZZ_OK, c.ozz_baked_clip_load_from_file(path.ptr, &loaded));
+    defer c.ozz_baked_clip_destroy(loaded);
+    try std.testing.expectEqual(c.ozz_baked_clip_num_joints(baked), c.ozz_baked_clip_num_joints(loaded));
+    try std.testing.expectEqual(c.ozz_baked_clip_num_frames(baked), c.ozz_baked_clip_num_frames(loaded));
+    try std.testing.expectEqual(c.ozz_animation_duration(anim), c.ozz_baked_clip_duration(loaded));
+
+    // Any other archive is turned down.
+    try std.testing.expect(c.ozz_baked_clip_load_from_file("assets/pab_skeleton.ozz", &loaded) == c.OZZ_ERR_OZZ);
+    try std.testing.expectError(OzzError.InvalidArgument, bakeModelClipZ("assets/pab_skeleton.ozz", "assets/pab_walk_no_motion.ozz", -1.0, path));
+}
+
+test "compression benchmark trades size for error across optimizer tolerances" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var csv_path_buf: [256]u8 = undefined;
+    const csv_path = try std.fmt.bufPrintZ(&csv_path_buf, ".zig-cache/tmp/{s}/compression.csv", .{tmp.sub_path});
+
+    const settings = [_]CompressionSetting{
+        .{ .tolerance = 0 },
+        .{ .tolerance = 1e-3 },
+        .{ .tolerance = 1e-2, .iframe_interval = 1 },
+    };
+    var summaries: [6]CompressionSummary = undefined;
+    const desc = CompressionBenchDesc{
+        .skeleton_path = "assets/pab_skeleton.ozz",
+        .animation_paths = &.{ "assets/pab_walk_no_motion.ozz", "assets/pab_jog_no_motion.ozz" },
+        .settings = &settings,
+        .timing_passes = 1,
+    };
+    try std.testing.expectError(OzzError.InvalidArgument, compressionBenchmarkZ(desc, csv_path, summaries[0..5]));
+    const rows = try compressionBenchmarkZ(desc, csv_path, &summaries);
+    try std.testing.expectEqual(@as(usize, 6), rows.len);
+
+    for (0..2) |clip| {
+        const clip_rows = rows[clip * 3 ..][0..3];
+        for (clip_rows, 0..) |row, setting| {
+            try std.testing.expectEqual(@as(i32, @intCast(clip)), row.animation);
+            try std.testing.expectEqual(@as(i32, @intCast(setting)), row.setting);
+            try std.testing.expect(row.compressed_bytes > 0);
+            try std.testing.expect(row.sample_ns > 0 and row.sample_reverse_ns > 0 and row.sample_scan_ns > 0);
+            try std.testing.expect(row.error_p95 <= row.error_p99 and row.error_p99 <= row.error_max);
+        }
+        // Without the optimizer only key quantization is left.
+        try std.testing.expect(clip_rows[0].error_max < 1e-3);
+        try std.testing.expect(clip_rows[1].compressed_bytes < clip_rows[0].compressed_bytes);
+        try std.testing.expect(clip_rows[2].compressed_bytes < clip_rows[1].compressed_bytes);
+        try std.testing.expect(clip_rows[2].error_mean > clip_rows[1].error_mean);
+    }
+}
@@ -8,6 +8,8 @@ pub const OzzError = error{
     InvalidArgument,
     Io,
     OzzFailure,
+    /// Nothing to hand over right now (palette rings), try again later.
+    Busy,
     Unknown,
 };
 
@@ -20,6 +22,7 @@ fn mapResult(rc: c.ozz_result_t) OzzError!void {
         c.OZZ_OK => return,
         c.OZZ_ERR_INVALID_ARGUMENT => return OzzError.InvalidArgument,
         c.OZZ_ERR_IO => return OzzError.Io,
+        c.OZZ_ERR_BUSY => return OzzError.Busy,
         c.OZZ_ERR_OZZ => {
             std.debug.print("cozz error: {s}\n", .{std.mem.span(c.ozz_last_error())});
             return OzzError.OzzFailure;
@@ -138,6 +141,70 @@ pub fn resetAllocator() AllocatorError!void {
     g_ozz_allocator = null;
 }
 
+pub const ArenaStats = c.ozz_arena_stats_t;
+
+/// Routes Ozz allocations to the built-in arena allocator: size-class pools on
+/// one arena per thread. Uninstall with `resetAllocator`. Fails with
+/// InvalidArgument while objects from the previous allocator are alive.
+pub fn installArenaAllocator() AllocatorError!void {
+    lockOzzAllocator();
+    defer g_ozz_allocator_lock.unlock();
+
+    if (g_ozz_outstanding_allocations != 0) return AllocatorError.OzzAllocatorBusy;
+    try mapResult(c.ozz_set_arena_allocator());
+    g_ozz_allocator = null;
+}
+
+/// Returns the arenas' pooled memory to the system and restarts their
+/// statistics. Fails with InvalidArgument while arena blocks are live.
+pub fn resetArenaAllocator() OzzError!void {
+    try mapResult(c.ozz_arena_allocator_reset());
+}
+
+/// One entry per arena, written to the front of `out`.
+pub fn arenaStats(out: []ArenaStats) OzzError![]ArenaStats {
+    var count: i32 = 0;
+    try mapResult(c.ozz_arena_allocator_stats(out.ptr, @intCast(out.len), &count));
+    return out[0..@min(out.len, @as(usize, @intCast(count)))];
+}
+
+pub const AllocCategory = enum(u32) {
+    other = c.OZZ_ALLOC_OTHER,
+    skeleton = c.OZZ_ALLOC_SKELETON,
+    animation = c.OZZ_ALLOC_ANIMATION,
+    context = c.OZZ_ALLOC_CONTEXT,
+    offline = c.OZZ_ALLOC_OFFLINE,
+};
+
+pub const AllocCounters = c.ozz_alloc_counters_t;
+
+/// Live and peak Ozz allocations of one category, whichever allocator is installed.
+pub fn allocCounters(category: AllocCategory) AllocCounters {
+    var out: AllocCounters = undefined;
+    mapResult(c.ozz_alloc_counters(@intCast(@intFromEnum(category)), &out)) catch unreachable;
+    return out;
+}
+
+/// Debug check: while enabled, allocations made inside eval, skinning and the
+/// palette outputs are counted by `hotPathAllocations`.
+pub fn setHotPathGuard(enabled: bool) void {
+    c.ozz_set_hot_path_guard(@intFromBool(enabled));
+}
+
+pub fn hotPathAllocations() u64 {
+    return c.ozz_hot_path_allocations();
+}
+
+/// Kernel tier that eval and skinning run on: "avx2" or "baseline".
+pub fn kernelTier() [:0]const u8 {
+    return std.mem.span(c.ozz_kernel_tier());
+}
+
+/// Forces a kernel tier by name, null picks the best one for this cpu.
+pub fn setKernelTier(name: ?[:0]const u8) !void {
+    try mapResult(c.ozz_set_kernel_tier(if (name) |n| n.ptr else null));
+}
+
 // --------------------
 // Loaded runtime assets
 // --------------------
@@ -181,6 +248,16 @@ pub const Skeleton = struct {
     pub fn workspaceBytes(self: Skeleton) usize {
         return c.ozz_workspace_required_bytes(self.handle);
     }
+
+    /// Instance bytes when clips with up to `max_tracks` tracks are sampled,
+    /// e.g. clips authored on a bigger skeleton and played through a Retarget.
+    pub fn instanceBytesForTracks(self: Skeleton, max_tracks: i32) usize {
+        return c.ozz_instance_required_bytes_ex(self.handle, max_tracks);
+    }
+
+    pub fn workspaceBytesForTracks(self: Skeleton, max_tracks: i32) usize {
+        return c.ozz_workspace_required_bytes_ex(self.handle, max_tracks);
+    }
 };
 
 pub const Animation = struct {
@@ -204,6 +281,348 @@ pub const Animation = struct {
     pub fn timeFromRatio(self: Animation, ratio: f32) f32 {
         return ratio * self.duration();
     }
+
+    /// Resident bytes, pooled constants excluded for library clips.
+    pub fn sizeBytes(self: Animation) usize {
+        return c.ozz_animation_size_bytes(self.handle);
+    }
+};
+
+/// Clips sharing one pool of constant SoA track values: a value that several
+/// clips hold for the same 4 joints is stored once for the whole library.
+pub const AnimationLibrary = struct {
+    handle: *c.ozz_library_t,
+
+    /// `Animation.handle` of every clip; the library copies what it needs.
+    pub fn init(clips: []const *const c.ozz_animation_t) !AnimationLibrary {
+        var out: ?*c.ozz_library_t = null;
+        try mapResult(c.ozz_library_create(@ptrCast(clips.ptr), @intCast(clips.len), &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn loadFromFileZ(path_z: [:0]const u8) !AnimationLibrary {
+        var out: ?*c.ozz_library_t = null;
+        try mapResult(c.ozz_library_load_from_file(path_z.ptr, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn saveToFileZ(self: AnimationLibrary, path_z: [:0]const u8) !void {
+        try mapResult(c.ozz_library_save_to_file(self.handle, path_z.ptr));
+    }
+
+    pub fn deinit(self: *AnimationLibrary) void {
+        c.ozz_library_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn numClips(self: AnimationLibrary) usize {
+        return @intCast(c.ozz_library_num_clips(self.handle));
+    }
+
+    /// Owned by the library: valid until `deinit`, never to `Animation.deinit`.
+    pub fn clip(self: AnimationLibrary, index: usize) Animation {
+        return .{ .handle = @constCast(c.ozz_library_clip(self.handle, @intCast(index)).?) };
+    }
+
+    pub fn poolEntries(self: AnimationLibrary) usize {
+        return @intCast(c.ozz_library_pool_entries(self.handle));
+    }
+
+    /// The pool plus every clip's `Animation.sizeBytes`.
+    pub fn sizeBytes(self: AnimationLibrary) usize {
+        return c.ozz_library_size_bytes(self.handle);
+    }
+};
+
+pub const SegmentCacheStats = c.ozz_segment_cache_stats_t;
+
+/// Decompressed keyframes of (clip, timepoint interval) pairs, shared by every
+/// sampling job of the process while installed. Crowds playing the same clips
+/// at nearby ratios then decompress each interval once; poses are unchanged.
+pub const SegmentCache = struct {
+    handle: *c.ozz_segment_cache_t,
+
+    /// Slots for clips of up to `max_tracks` tracks (joints, as in
+    /// `Skeleton.instanceBytesForTracks`) in `budget_bytes`, fixed for the
+    /// cache's lifetime. Bigger clips bypass it.
+    pub fn init(max_tracks: i32, budget_bytes: usize) !SegmentCache {
+        const desc = c.ozz_segment_cache_desc_t{ .max_tracks = max_tracks, .budget_bytes = budget_bytes };
+        var out: ?*c.ozz_segment_cache_t = null;
+        try mapResult(c.ozz_segment_cache_create(&desc, &out));
+        return .{ .handle = out.? };
+    }
+
+    /// Must not be installed, nor used by running evals.
+    pub fn deinit(self: *SegmentCache) void {
+        c.ozz_segment_cache_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn stats(self: SegmentCache) SegmentCacheStats {
+        var out: SegmentCacheStats = undefined;
+        c.ozz_segment_cache_stats(self.handle, &out);
+        return out;
+    }
+};
+
+/// Installs a segment cache for every sampling job, null uninstalls it.
+pub fn setSegmentCache(cache: ?SegmentCache) void {
+    c.ozz_set_segment_cache(if (cache) |sc| sc.handle else null);
+}
+
+/// Model-space palettes of one clip, sampled at a fixed frame rate and
+/// quantized. A layer made with `LayerDesc.atBaked` evaluates as a frame
+/// lookup; it must be the instance's only layer, without IK jobs.
+pub const BakedClip = struct {
+    handle: *c.ozz_baked_clip_t,
+
+    pub fn init(skel: Skeleton, anim: Animation, frame_rate: f32) !BakedClip {
+        var out: ?*c.ozz_baked_clip_t = null;
+        try mapResult(c.ozz_baked_clip_create(skel.handle, anim.handle, frame_rate, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn loadFromFileZ(path_z: [:0]const u8) !BakedClip {
+        var out: ?*c.ozz_baked_clip_t = null;
+        try mapResult(c.ozz_baked_clip_load_from_file(path_z.ptr, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn saveToFileZ(self: BakedClip, path_z: [:0]const u8) !void {
+        try mapResult(c.ozz_baked_clip_save_to_file(self.handle, path_z.ptr));
+    }
+
+    pub fn deinit(self: *BakedClip) void {
+        c.ozz_baked_clip_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn numJoints(self: BakedClip) i32 {
+        return c.ozz_baked_clip_num_joints(self.handle);
+    }
+
+    pub fn numFrames(self: BakedClip) usize {
+        return @intCast(c.ozz_baked_clip_num_frames(self.handle));
+    }
+
+    pub fn duration(self: BakedClip) f32 {
+        return c.ozz_baked_clip_duration(self.handle);
+    }
+};
+
+pub const MotionMatch = c.ozz_motion_match_t;
+
+pub const MotionDbDesc = struct {
+    /// `Animation.handle` of every clip, tracks matching the skeleton's joints.
+    clips: []const *const c.ozz_animation_t,
+    /// Up to `c.OZZ_MOTION_MAX_FEATURE_JOINTS` joints, position and velocity each.
+    feature_joints: []const i32 = &.{},
+    /// Seconds ahead, up to `c.OZZ_MOTION_MAX_TRAJECTORY`.
+    trajectory_times: []const f32 = &.{},
+    root_joint: i32 = 0,
+    /// Root model matrix column pointing forward: 0 x, 1 y, 2 z.
+    facing_axis: i32 = 2,
+    /// Frames per second; 0 means 30.
+    sample_rate: f32 = 0,
+    position_weight: f32 = 1,
+    velocity_weight: f32 = 1,
+    trajectory_position_weight: f32 = 1,
+    trajectory_facing_weight: f32 = 1,
+};
+
+/// Motion-matching pose database: normalized features of every frame of a
+/// clip set, searched for the frame closest to a query. The feature layout is
+/// documented with ozz_motion_db_desc_t. Read-only once built.
+pub const MotionDb = struct {
+    handle: *c.ozz_motion_db_t,
+
+    pub fn init(skel: Skeleton, desc: MotionDbDesc) !MotionDb {
+        const c_desc = c.ozz_motion_db_desc_t{
+            .clips = @ptrCast(desc.clips.ptr),
+            .clip_count = @intCast(desc.clips.len),
+            .feature_joints = desc.feature_joints.ptr,
+            .feature_joint_count = @intCast(desc.feature_joints.len),
+            .trajectory_times = desc.trajectory_times.ptr,
+            .trajectory_count = @intCast(desc.trajectory_times.len),
+            .root_joint = desc.root_joint,
+            .facing_axis = desc.facing_axis,
+            .sample_rate = desc.sample_rate,
+            .position_weight = desc.position_weight,
+            .velocity_weight = desc.velocity_weight,
+            .trajectory_position_weight = desc.trajectory_position_weight,
+            .trajectory_facing_weight = desc.trajectory_facing_weight,
+        };
+        var out: ?*c.ozz_motion_db_t = null;
+        try mapResult(c.ozz_motion_db_create(skel.handle, &c_desc, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn loadFromFileZ(path_z: [:0]const u8) !MotionDb {
+        var out: ?*c.ozz_motion_db_t = null;
+        try mapResult(c.ozz_motion_db_load_from_file(path_z.ptr, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn saveToFileZ(self: MotionDb, path_z: [:0]const u8) !void {
+        try mapResult(c.ozz_motion_db_save_to_file(self.handle, path_z.ptr));
+    }
+
+    pub fn deinit(self: *MotionDb) void {
+        c.ozz_motion_db_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn frameCount(self: MotionDb) usize {
+        return @intCast(c.ozz_motion_db_frame_count(self.handle));
+    }
+
+    pub fn featureCount(self: MotionDb) usize {
+        return @intCast(c.ozz_motion_db_feature_count(self.handle));
+    }
+
+    /// A frame's features in query layout, as a prefix of `out`.
+    pub fn frameFeatures(self: MotionDb, frame: usize, out: []f32) ![]f32 {
+        try mapResult(c.ozz_motion_db_frame_features(self.handle, @intCast(frame), out.ptr, @intCast(out.len)));
+        return out[0..self.featureCount()];
+    }
+
+    /// Per feature: normalized = (feature - mean) * scale.
+    pub fn normalization(self: MotionDb, mean: []f32, scale: []f32) !void {
+        if (mean.len != scale.len) return OzzError.InvalidArgument;
+        try mapResult(c.ozz_motion_db_normalization(self.handle, mean.ptr, scale.ptr, @intCast(mean.len)));
+    }
+
+    /// Best match of each query, query i at `queries[i * stride ..]`, one per
+    /// entry of `out`.
+    pub fn search(self: MotionDb, queries: []const f32, stride: usize, out: []MotionMatch) !void {
+        if (out.len > 0 and queries.len < (out.len - 1) * stride + self.featureCount()) return OzzError.InvalidArgument;
+        try mapResult(c.ozz_motion_db_search(self.handle, queries.ptr, @intCast(out.len), stride, out.ptr));
+    }
+
+    pub fn searchOne(self: MotionDb, query: []const f32) !MotionMatch {
+        var match: MotionMatch = undefined;
+        try self.search(query, query.len, (&match)[0..1]);
+        return match;
+    }
+};
+
+/// Precompiled source skeleton -> target skeleton remap. Build once per pair
+/// and share it between every instance of the target skeleton.
+/// Joint subset of one (sub)mesh: `joints[k]` is the skeleton joint behind
+/// skinning index k and `inverse_binds_3x4[12 * k ..]` its inverse bind.
+pub const MeshRemap = struct {
+    handle: *c.ozz_mesh_remap_t,
+
+    pub fn init(skel: Skeleton, joints: []const i32, inverse_binds_3x4: []const f32) !MeshRemap {
+        if (inverse_binds_3x4.len < joints.len * 12) return OzzError.InvalidArgument;
+        var out: ?*c.ozz_mesh_remap_t = null;
+        try mapResult(c.ozz_mesh_remap_create(
+            skel.handle,
+            joints.ptr,
+            inverse_binds_3x4.ptr,
+            @intCast(joints.len),
+            &out,
+        ));
+        return .{ .handle = out.? };
+    }
+
+    pub fn deinit(self: *MeshRemap) void {
+        c.ozz_mesh_remap_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn jointCount(self: MeshRemap) usize {
+        return @intCast(c.ozz_mesh_remap_joint_count(self.handle));
+    }
+
+    /// One bind-pose box per mesh joint (min xyz, max xyz) enclosing every
+    /// vertex the joint influences. min > max marks joints without vertices.
+    pub fn setJointBounds(self: *MeshRemap, boxes: []const f32) !void {
+        try mapResult(c.ozz_mesh_remap_set_joint_bounds(self.handle, boxes.ptr, @intCast(boxes.len / 6)));
+    }
+};
+
+pub const Retarget = struct {
+    handle: *c.ozz_retarget_t,
+
+    /// Maps target joints to source joints by name.
+    pub fn init(source: Skeleton, target: Skeleton) !Retarget {
+        var out: ?*c.ozz_retarget_t = null;
+        try mapResult(c.ozz_retarget_create(source.handle, target.handle, &out));
+        return .{ .handle = out.? };
+    }
+
+    /// `target_to_source[target_joint]` is a source joint index, or -1 to keep
+    /// the target rest pose.
+    pub fn initWithMap(source: Skeleton, target: Skeleton, target_to_source: []const i32) !Retarget {
+        var out: ?*c.ozz_retarget_t = null;
+        try mapResult(c.ozz_retarget_create_with_map(
+            source.handle,
+            target.handle,
+            target_to_source.ptr,
+            @intCast(target_to_source.len),
+            &out,
+        ));
+        return .{ .handle = out.? };
+    }
+
+    /// For clips that only carry the tracks they animate: `track_to_joint[track]`
+    /// is the `target` joint the track drives, or -1 to ignore it. Normal layers
+    /// leave the other joints to the remaining layers (or the rest pose).
+    pub fn initSparse(target: Skeleton, track_to_joint: []const i32) !Retarget {
+        var out: ?*c.ozz_retarget_t = null;
+        try mapResult(c.ozz_retarget_create_sparse(
+            target.handle,
+            track_to_joint.ptr,
+            @intCast(track_to_joint.len),
+            &out,
+        ));
+        return .{ .handle = out.? };
+    }
+
+    pub fn deinit(self: *Retarget) void {
+        c.ozz_retarget_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn sourceJoint(self: Retarget, target_joint: i32) i32 {
+        return c.ozz_retarget_source_joint(self.handle, target_joint);
+    }
+
+    pub fn sourceTracks(self: Retarget) i32 {
+        return c.ozz_retarget_source_tracks(self.handle);
+    }
+};
+
+/// Trunk/subtree split of a skeleton for parallel local-to-model. Build once
+/// per skeleton; see `evalLocals`, `evalLtmTrunk` and `evalLtmTask`.
+pub const LtmPartition = struct {
+    handle: *c.ozz_ltm_partition_t,
+
+    /// Joints at `split_depth` (roots are at 0) root independent subtrees,
+    /// balanced by joint count into at most `max_tasks` tasks.
+    pub fn init(skel: Skeleton, split_depth: i32, max_tasks: i32) !LtmPartition {
+        var out: ?*c.ozz_ltm_partition_t = null;
+        try mapResult(c.ozz_ltm_partition_create(skel.handle, split_depth, max_tasks, &out));
+        return .{ .handle = out.? };
+    }
+
+    pub fn deinit(self: *LtmPartition) void {
+        c.ozz_ltm_partition_destroy(self.handle);
+        self.* = undefined;
+    }
+
+    pub fn taskCount(self: LtmPartition) i32 {
+        return c.ozz_ltm_partition_task_count(self.handle);
+    }
+
+    pub fn taskJoints(self: LtmPartition, task: i32) i32 {
+        return c.ozz_ltm_partition_task_joints(self.handle, task);
+    }
+
+    pub fn trunkJoints(self: LtmPartition) i32 {
+        return c.ozz_ltm_partition_trunk_joints(self.handle);
+    }
 };
 
 pub const Vec3 = extern struct {
@@ -212,6 +631,12 @@ pub const Vec3 = extern struct {
     z: f32,
 };
 
+/// Laid out as an ozz_vec3_t min, max pair.
+pub const Bounds = extern struct {
+    min: Vec3,
+    max: Vec3,
+};
+
 pub const IkJob = extern struct {
     kind: c.ozz_ik_kind_t,
     weight: f32,
@@ -314,12 +739,38 @@ pub const LayerMode = enum(u32) {
     additive = c.OZZ_LAYER_ADDITIVE,
 };
 
+/// Local-to-model kernel. `.level_soa` multiplies whole SoA groups of
+/// same-depth joints at once; results match `.depth_first` to float rounding.
+pub const LtmMode = enum(u32) {
+    depth_first = c.OZZ_LTM_DEPTH_FIRST,
+    level_soa = c.OZZ_LTM_LEVEL_SOA,
+};
+
+/// How frames between an instance's full evals are filled; see `UpdateRate`.
+pub const UpdateMode = enum(u32) {
+    /// Lerp of the last two full evals: smooth, but one interval behind.
+    interpolate = c.OZZ_UPDATE_INTERPOLATE,
+    /// Latest full eval moved along by joint 0's velocity: no lag, the pose holds.
+    extrapolate_root = c.OZZ_UPDATE_EXTRAPOLATE_ROOT,
+};
+
+/// Update-rate LOD: a full eval every `interval` frames, on frames where
+/// frame % interval == phase, for frame-aware evals (`evalModel3x4At`, batches).
+pub const UpdateRate = struct {
+    interval: i32 = 1,
+    /// null takes the next phase of a process-wide round robin, spreading a
+    /// crowd's full evals evenly over the interval.
+    phase: ?i32 = null,
+    mode: UpdateMode = .interpolate,
+};
+
 pub const Layer = struct {
     anim: Animation,
     ratio: f32,
     weight: f32,
     mode: LayerMode = .normal,
     joint_weights: ?[]const f32 = null,
+    retarget: ?Retarget = null,
 
     pub fn atRatio(anim: Animation, sample_ratio: f32, weight: f32, mode: LayerMode) Layer {
         return .{
@@ -330,6 +781,55 @@ pub const Layer = struct {
             .joint_weights = null,
         };
     }
+
+    pub fn desc(self: Layer) LayerDesc {
+        return .{
+            .anim = self.anim.handle,
+            .ratio = self.ratio,
+            .weight = self.weight,
+            .mode = self.mode,
+            .joint_weights = if (self.joint_weights) |weights| weights.ptr else null,
+            .joint_weights_count = if (self.joint_weights) |weights| @intCast(weights.len) else 0,
+            .retarget = if (self.retarget) |rt| rt.handle else null,
+        };
+    }
+};
+
+/// `Layer` with the layout of ozz_layer_desc_t, so slices of these are handed
+/// to cozz as they are.
+pub const LayerDesc = extern struct {
+    anim: ?*const c.ozz_animation_t,
+    ratio: f32,
+    weight: f32,
+    mode: LayerMode = .normal,
+    joint_weights: ?[*]const f32 = null,
+    joint_weights_count: i32 = 0,
+    retarget: ?*const c.ozz_retarget_t = null,
+    baked: ?*const c.ozz_baked_clip_t = null,
+    baked_nearest: i32 = 0,
+
+    pub fn atRatio(anim: Animation, sample_ratio: f32, weight: f32, mode: LayerMode) LayerDesc {
+        return .{ .anim = anim.handle, .ratio = sample_ratio, .weight = weight, .mode = mode };
+    }
+
+    /// `nearest` takes the closest baked frame instead of lerping two.
+    pub fn atBaked(clip: BakedClip, sample_ratio: f32, nearest: bool) LayerDesc {
+        return .{
+            .anim = null,
+            .ratio = sample_ratio,
+            .weight = 1.0,
+            .baked = clip.handle,
+            .baked_nearest = @intFromBool(nearest),
+        };
+    }
+
+    comptime {
+        std.debug.assert(@sizeOf(LayerDesc) == @sizeOf(c.ozz_layer_desc_t));
+        std.debug.assert(@sizeOf(LayerMode) == @sizeOf(c.ozz_layer_mode_t));
+        for (std.meta.fields(LayerDesc)) |field| {
+            std.debug.assert(@offsetOf(LayerDesc, field.name) == @offsetOf(c.ozz_layer_desc_t, field.name));
+        }
+    }
 };
 
 // --------------------
@@ -339,14 +839,20 @@ pub const Layer = struct {
 pub const Instance = struct {
     storage: []align(16) u8,
     handle: *c.ozz_instance_t,
+    history: ?[]align(16) u8 = null,
 
     pub fn init(allocator: std.mem.Allocator, skel: Skeleton) !Instance {
-        const bytes = skel.instanceBytes();
+        return initForTracks(allocator, skel, 0);
+    }
+
+    /// Sizes the sampling context for clips with up to `max_tracks` tracks.
+    pub fn initForTracks(allocator: std.mem.Allocator, skel: Skeleton, max_tracks: i32) !Instance {
+        const bytes = skel.instanceBytesForTracks(max_tracks);
         const storage = try allocator.alignedAlloc(u8, .fromByteUnits(16), bytes);
         errdefer allocator.free(storage);
 
         var out: ?*c.ozz_instance_t = null;
-        try mapResult(c.ozz_instance_init(storage.ptr, storage.len, skel.handle, &out));
+        try mapResult(c.ozz_instance_init_ex(storage.ptr, storage.len, skel.handle, max_tracks, &out));
 
         return .{ .storage = storage, .handle = out.? };
     }
@@ -354,31 +860,50 @@ pub const Instance = struct {
     pub fn deinit(self: *Instance, allocator: std.mem.Allocator) void {
         c.ozz_instance_deinit(self.handle);
         allocator.free(self.storage);
+        if (self.history) |history| allocator.free(history);
         self.* = undefined;
     }
 
-    pub fn setLayers(self: *Instance, layers: []const Layer) void {
-        // Hard limit in the C wrapper is 8.
-        if (layers.len > c.OZZ_MAX_LAYERS) @panic("too many layers (max 8)");
-
-        var tmp: [c.OZZ_MAX_LAYERS]c.ozz_layer_desc_t = undefined;
-
-        for (layers, 0..) |L, i| {
-            tmp[i] = .{
-                .anim = L.anim.handle,
-                .ratio = L.ratio,
-                .weight = L.weight,
-                .mode = @intCast(@intFromEnum(L.mode)),
-                .joint_weights = if (L.joint_weights) |weights| weights.ptr else null,
-                .joint_weights_count = if (L.joint_weights) |weights| @intCast(weights.len) else 0,
-            };
+    /// Allocates the update history when `rate.interval` > 1 and frees it
+    /// when going back to 1. Clears the history either way.
+    pub fn setUpdateRate(self: *Instance, allocator: std.mem.Allocator, skel: Skeleton, rate: UpdateRate) !void {
+        var history: ?[]align(16) u8 = null;
+        if (rate.interval > 1) {
+            history = self.history orelse
+                try allocator.alignedAlloc(u8, .fromByteUnits(16), c.ozz_update_history_required_bytes(skel.handle));
         }
+        errdefer if (history != null and self.history == null) allocator.free(history.?);
 
-        c.ozz_instance_set_layers(
+        try mapResult(c.ozz_instance_set_update_rate(
             self.handle,
-            &tmp[0],
-            @intCast(layers.len),
-        );
+            rate.interval,
+            rate.phase orelse -1,
+            @intCast(@intFromEnum(rate.mode)),
+            if (history) |h| h.ptr else null,
+            if (history) |h| h.len else 0,
+        ));
+        if (history == null) if (self.history) |old| allocator.free(old);
+        self.history = history;
+    }
+
+    /// Whether a frame-aware eval at `frame` runs the full eval.
+    pub fn updateDue(self: Instance, frame: u64) bool {
+        return c.ozz_instance_update_due(self.handle, frame) != 0;
+    }
+
+    /// At most `c.OZZ_MAX_LAYERS` layers.
+    pub fn setLayers(self: *Instance, layers: []const Layer) OzzError!void {
+        if (layers.len > c.OZZ_MAX_LAYERS) return OzzError.InvalidArgument;
+
+        var tmp: [c.OZZ_MAX_LAYERS]LayerDesc = undefined;
+        for (layers, 0..) |L, i| tmp[i] = L.desc();
+        try self.setLayerDescs(tmp[0..layers.len]);
+    }
+
+    /// `setLayers` without the conversion.
+    pub fn setLayerDescs(self: *Instance, layers: []const LayerDesc) OzzError!void {
+        if (layers.len > c.OZZ_MAX_LAYERS) return OzzError.InvalidArgument;
+        c.ozz_instance_set_layers(self.handle, @ptrCast(layers.ptr), @intCast(layers.len));
     }
 
     pub fn setIkJobs(self: *Instance, jobs: []const IkJob) void {
@@ -408,6 +933,16 @@ pub const Instance = struct {
 
         c.ozz_instance_set_ik_jobs(self.handle, if (jobs.len == 0) null else &tmp[0], @intCast(jobs.len));
     }
+
+    pub fn setLtmMode(self: *Instance, mode: LtmMode) void {
+        c.ozz_instance_set_ltm_mode(self.handle, @intCast(@intFromEnum(mode)));
+    }
+
+    /// Bounds from `mesh`'s joint boxes instead of joint positions; null
+    /// goes back to joint positions.
+    pub fn setBoundsMesh(self: *Instance, mesh: ?MeshRemap) !void {
+        try mapResult(c.ozz_instance_set_bounds_mesh(self.handle, if (mesh) |m| m.handle else null));
+    }
 };
 
 // --------------------
@@ -419,12 +954,18 @@ pub const Workspace = struct {
     handle: *c.ozz_workspace_t,
 
     pub fn init(allocator: std.mem.Allocator, skel: Skeleton) !Workspace {
-        const bytes = skel.workspaceBytes();
+        return initForTracks(allocator, skel, 0);
+    }
+
+    /// Reserves a source-pose scratch for retargeted clips with up to
+    /// `max_tracks` tracks.
+    pub fn initForTracks(allocator: std.mem.Allocator, skel: Skeleton, max_tracks: i32) !Workspace {
+        const bytes = skel.workspaceBytesForTracks(max_tracks);
         const storage = try allocator.alignedAlloc(u8, .fromByteUnits(16), bytes);
         errdefer allocator.free(storage);
 
         var out: ?*c.ozz_workspace_t = null;
-        try mapResult(c.ozz_workspace_init(storage.ptr, storage.len, skel.handle, &out));
+        try mapResult(c.ozz_workspace_init_ex(storage.ptr, storage.len, skel.handle, max_tracks, &out));
 
         return .{ .storage = storage, .handle = out.? };
     }
@@ -440,6 +981,44 @@ pub const Workspace = struct {
         const len = @as(usize, @intCast(c.ozz_workspace_palette_floats(self.handle)));
         return ptr[0..len];
     }
+
+    /// Dual quaternions (real xyzw, dual xyzw) of the last eval's model
+    /// matrices, with the optional 3x4 inverse binds applied. `out` holds
+    /// at least 8 floats per joint.
+    pub fn dualQuats(self: Workspace, inverse_binds_3x4: ?[]const f32, out: []f32) ![]f32 {
+        try mapResult(c.ozz_workspace_dual_quats(
+            self.handle,
+            if (inverse_binds_3x4) |binds| binds.ptr else null,
+            out.ptr,
+            @intCast(out.len),
+        ));
+        const len: usize = @intCast(c.ozz_workspace_palette_floats(self.handle));
+        return out[0 .. len / 12 * 8];
+    }
+
+    /// Model-space AABB of the last eval.
+    pub fn bounds(self: Workspace) !Bounds {
+        var min: c.ozz_vec3_t = undefined;
+        var max: c.ozz_vec3_t = undefined;
+        try mapResult(c.ozz_workspace_bounds(self.handle, &min, &max));
+        return .{
+            .min = .{ .x = min.x, .y = min.y, .z = min.z },
+            .max = .{ .x = max.x, .y = max.y, .z = max.z },
+        };
+    }
+
+    /// Skinning matrices of `mesh`'s joints, inverse binds applied, in the
+    /// palette 3x4 layout. `out` holds at least 12 floats per mesh joint.
+    pub fn meshPalette3x4(self: Workspace, mesh: MeshRemap, out: []f32) ![]f32 {
+        try mapResult(c.ozz_workspace_mesh_palette_3x4(self.handle, mesh.handle, out.ptr, @intCast(out.len)));
+        return out[0 .. 12 * mesh.jointCount()];
+    }
+
+    /// Dual quaternion counterpart of `meshPalette3x4`, 8 floats per mesh joint.
+    pub fn meshDualQuats(self: Workspace, mesh: MeshRemap, out: []f32) ![]f32 {
+        try mapResult(c.ozz_workspace_mesh_dual_quats(self.handle, mesh.handle, out.ptr, @intCast(out.len)));
+        return out[0 .. 8 * mesh.jointCount()];
+    }
 };
 
 // --------------------
@@ -451,59 +1030,386 @@ pub fn evalModel3x4(inst: *Instance, ws: *Workspace) ![]const f32 {
     return ws.palette3x4();
 }
 
-extern fn ozz_eval_model_3x4_reference(inst: *c.ozz_instance_t, ws: *c.ozz_workspace_t) c.ozz_result_t;
-
-fn evalModel3x4Reference(inst: *Instance, ws: *Workspace) ![]const f32 {
-    try mapResult(ozz_eval_model_3x4_reference(inst.handle, ws.handle));
+/// `evalModel3x4` at `frame`, honoring the instance's update rate. The
+/// workspace's dual quaternions and mesh palettes follow the returned palette.
+pub fn evalModel3x4At(inst: *Instance, ws: *Workspace, frame: u64) ![]const f32 {
+    try mapResult(c.ozz_eval_model_3x4_at(inst.handle, ws.handle, frame));
     return ws.palette3x4();
 }
 
-fn expectSlicesApproxEqAbs(expected: []const f32, actual: []const f32, tolerance: f32) !void {
-    try std.testing.expectEqual(expected.len, actual.len);
-    for (expected, actual) |exp, act| {
-        try std.testing.expectApproxEqAbs(exp, act, tolerance);
-    }
+/// Floats spanned by a palette of `num_joints` joints `joint_stride` floats apart.
+pub fn stridedPaletteFloats(num_joints: usize, joint_stride: usize) usize {
+    return if (num_joints == 0) 0 else (num_joints - 1) * joint_stride + 12;
 }
 
-fn copyPalette(allocator: std.mem.Allocator, palette: []const f32) ![]f32 {
-    const out = try allocator.alloc(f32, palette.len);
-    @memcpy(out, palette);
-    return out;
+/// `evalModel3x4` writing the palette to `out` instead of the workspace:
+/// joint j's 12 floats start at `out[j * joint_stride]`. Bounds still land
+/// in the workspace.
+pub fn evalModel3x4Into(inst: *Instance, ws: *Workspace, out: []f32, joint_stride: usize) !void {
+    const joints = ws.palette3x4().len / 12;
+    if (joint_stride < 12 or out.len < stridedPaletteFloats(joints, joint_stride)) return OzzError.InvalidArgument;
+    try mapResult(c.ozz_eval_model_3x4_into(inst.handle, ws.handle, out.ptr, joint_stride));
 }
 
-fn paletteTranslation(palette: []const f32, joint: usize) Vec3 {
-    const base = joint * 12;
-    return .{
-        .x = palette[base + 9],
-        .y = palette[base + 10],
-        .z = palette[base + 11],
-    };
+/// Evaluates into an idle slot of `ring` and publishes it; `error.Busy` when
+/// readers pin every other slot.
+pub fn evalModel3x4Ring(inst: *Instance, ws: *Workspace, ring: *PaletteRing) !void {
+    try mapResult(c.ozz_eval_model_3x4_ring(inst.handle, ws.handle, ring.handle));
 }
 
-fn paletteColumn(palette: []const f32, joint: usize, col: usize) Vec3 {
-    const base = joint * 12 + col * 3;
-    return .{
-        .x = palette[base + 0],
-        .y = palette[base + 1],
-        .z = palette[base + 2],
+/// Hands published evals of one instance to other threads without copies.
+/// One thread evaluates into it at a time; any thread may `acquire` the
+/// latest eval and keeps it until `release`. With readers pinning at most k
+/// frames at once, `depth` k + 2 never blocks the writer.
+pub const PaletteRing = struct {
+    storage: []align(16) u8,
+    handle: *c.ozz_palette_ring_t,
+    num_joints: usize,
+
+    pub const Options = struct {
+        depth: i32 = 3,
+        /// Floats between joints, at least 12.
+        joint_stride: usize = 12,
+        /// Caller storage for the slots (e.g. a mapped GPU buffer), `slot_stride`
+        /// floats apart; null keeps them in the ring's own storage.
+        slots: ?[]f32 = null,
+        slot_stride: usize = 0,
     };
-}
 
-fn vec3Add(a: Vec3, b: Vec3) Vec3 {
-    return .{ .x = a.x + b.x, .y = a.y + b.y, .z = a.z + b.z };
-}
+    pub const Frame = struct {
+        palette: []const f32,
+        joint_stride: usize,
+        bounds: Bounds,
+        /// 1 for the first published eval, then increasing.
+        sequence: u64,
+        slot: i32,
+    };
 
-fn vec3Sub(a: Vec3, b: Vec3) Vec3 {
-    return .{ .x = a.x - b.x, .y = a.y - b.y, .z = a.z - b.z };
-}
+    pub fn init(allocator: std.mem.Allocator, skel: Skeleton, options: Options) !PaletteRing {
+        const num_joints: usize = @intCast(skel.numJoints());
+        if (options.slots) |slots| {
+            const stride = if (options.slot_stride != 0) options.slot_stride else stridedPaletteFloats(num_joints, options.joint_stride);
+            const depth: usize = @intCast(@max(options.depth, 1));
+            if (slots.len < (depth - 1) * stride + stridedPaletteFloats(num_joints, options.joint_stride)) return OzzError.InvalidArgument;
+        }
+        const desc = c.ozz_palette_ring_desc_t{
+            .depth = options.depth,
+            .joint_stride = options.joint_stride,
+            .slots = if (options.slots) |slots| slots.ptr else null,
+            .slot_stride = options.slot_stride,
+        };
+        const bytes = c.ozz_palette_ring_required_bytes(skel.handle, &desc);
+        if (bytes == 0) return OzzError.InvalidArgument;
+        const storage = try allocator.alignedAlloc(u8, .fromByteUnits(16), bytes);
+        errdefer allocator.free(storage);
 
-fn vec3Length(v: Vec3) f32 {
-    return @sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
-}
+        var out: ?*c.ozz_palette_ring_t = null;
+        try mapResult(c.ozz_palette_ring_init(storage.ptr, storage.len, skel.handle, &desc, &out));
+        return .{ .storage = storage, .handle = out.?, .num_joints = num_joints };
+    }
 
-fn paletteDifferenceL1(a: []const f32, b: []const f32) f32 {
-    var sum: f32 = 0;
-    for (a, b) |av, bv| sum += @abs(av - bv);
+    pub fn deinit(self: *PaletteRing, allocator: std.mem.Allocator) void {
+        allocator.free(self.storage);
+        self.* = undefined;
+    }
+
+    /// Pins the latest published eval; `error.Busy` until the first one.
+    pub fn acquire(self: *PaletteRing) !Frame {
+        var frame: c.ozz_palette_frame_t = undefined;
+        try mapResult(c.ozz_palette_ring_acquire(self.handle, &frame));
+        return .{
+            .palette = frame.palette[0..stridedPaletteFloats(self.num_joints, frame.joint_stride)],
+            .joint_stride = frame.joint_stride,
+            .bounds = .{
+                .min = .{ .x = frame.bounds_min.x, .y = frame.bounds_min.y, .z = frame.bounds_min.z },
+                .max = .{ .x = frame.bounds_max.x, .y = frame.bounds_max.y, .z = frame.bounds_max.z },
+            },
+            .sequence = frame.sequence,
+            .slot = frame.slot,
+        };
+    }
+
+    pub fn release(self: *PaletteRing, frame: Frame) void {
+        c.ozz_palette_ring_release(self.handle, frame.slot);
+    }
+};
+
+/// Staged eval, first step: sampling, blending and IK.
+pub fn evalLocals(inst: *Instance, ws: *Workspace) !void {
+    try mapResult(c.ozz_eval_locals(inst.handle, ws.handle));
+}
+
+/// Staged eval, second step: model space and palette of the trunk joints.
+pub fn evalLtmTrunk(inst: *Instance, ws: *Workspace, partition: LtmPartition) !void {
+    try mapResult(c.ozz_eval_ltm_trunk(inst.handle, ws.handle, partition.handle));
+}
+
+/// Staged eval, last step. Every task must run once; tasks may run
+/// concurrently on any thread. The palette is complete once all are done.
+pub fn evalLtmTask(inst: *Instance, ws: *Workspace, partition: LtmPartition, task: i32) !void {
+    try mapResult(c.ozz_eval_ltm_task(inst.handle, ws.handle, partition.handle, task));
+}
+
+// --------------------
+// Batch evaluate
+// --------------------
+
+/// ozz_batch_item_t: an instance and, when not empty, the layers replacing
+/// its current ones.
+pub const BatchItem = extern struct {
+    instance: *c.ozz_instance_t,
+    layers: ?[*]const LayerDesc = null,
+    layer_count: i32 = 0,
+
+    pub fn init(inst: *Instance, layers: []const LayerDesc) BatchItem {
+        return .{
+            .instance = inst.handle,
+            .layers = if (layers.len == 0) null else layers.ptr,
+            .layer_count = @intCast(layers.len),
+        };
+    }
+
+    comptime {
+        std.debug.assert(@sizeOf(BatchItem) == @sizeOf(c.ozz_batch_item_t));
+    }
+};
+
+/// Evaluates `items` in order on one workspace at `frame`. Item i's palette
+/// goes to `out_palettes[i * n ..][0..n]`, n being the workspace's palette
+/// length, and its bounds to `out_bounds[i]`; `ws` own outputs are left
+/// untouched. Instances with an update rate run their full eval when due only.
+pub fn evalBatch3x4(ws: *Workspace, frame: u64, items: []const BatchItem, out_palettes: []f32, out_bounds: ?[]Bounds) !void {
+    const floats = ws.palette3x4().len;
+    if (out_palettes.len < items.len * floats) return OzzError.InvalidArgument;
+    if (out_bounds) |bounds| if (bounds.len < items.len) return OzzError.InvalidArgument;
+    try mapResult(c.ozz_eval_batch_3x4(
+        @ptrCast(items.ptr),
+        @intCast(items.len),
+        ws.handle,
+        frame,
+        out_palettes.ptr,
+        floats,
+        if (out_bounds) |bounds| @ptrCast(bounds.ptr) else null,
+        null,
+    ));
+}
+
+/// Batch evaluation over worker threads for instances of one skeleton, each
+/// worker owning its Workspace. Instances must be distinct within a batch.
+/// Threads are the caller's: a job system runs one `evaluateChunk` per worker
+/// each frame, or schedules its own splits with `evaluateOn`.
+pub const BatchEvaluator = struct {
+    workspaces: []Workspace,
+
+    pub const Chunk = struct { first: usize, last: usize };
+
+    pub fn init(allocator: std.mem.Allocator, skel: Skeleton, workers: usize) !BatchEvaluator {
+        return initForTracks(allocator, skel, workers, 0);
+    }
+
+    /// Sizes worker workspaces for retargeted clips with up to `max_tracks` tracks.
+    pub fn initForTracks(allocator: std.mem.Allocator, skel: Skeleton, workers: usize, max_tracks: i32) !BatchEvaluator {
+        if (workers == 0) return OzzError.InvalidArgument;
+        const workspaces = try allocator.alloc(Workspace, workers);
+        errdefer allocator.free(workspaces);
+
+        var ready: usize = 0;
+        errdefer for (workspaces[0..ready]) |*ws| ws.deinit(allocator);
+        while (ready < workers) : (ready += 1) {
+            workspaces[ready] = try Workspace.initForTracks(allocator, skel, max_tracks);
+        }
+        return .{ .workspaces = workspaces };
+    }
+
+    pub fn deinit(self: *BatchEvaluator, allocator: std.mem.Allocator) void {
+        for (self.workspaces) |*ws| ws.deinit(allocator);
+        allocator.free(self.workspaces);
+        self.* = undefined;
+    }
+
+    pub fn workerCount(self: BatchEvaluator) usize {
+        return self.workspaces.len;
+    }
+
+    pub fn paletteFloats(self: BatchEvaluator) usize {
+        return self.workspaces[0].palette3x4().len;
+    }
+
+    /// `worker`'s contiguous share of a batch of `count` items; empty for
+    /// workers past the end of small batches.
+    pub fn chunk(self: BatchEvaluator, worker: usize, count: usize) Chunk {
+        const size = (count + self.workspaces.len - 1) / self.workspaces.len;
+        const first = @min(count, worker * size);
+        return .{ .first = first, .last = @min(count, first + size) };
+    }
+
+    /// Evaluates `items` on `worker`'s workspace, for callers scheduling work
+    /// on their own threads. Calls running at the same time need distinct workers.
+    pub fn evaluateOn(self: *BatchEvaluator, worker: usize, frame: u64, items: []const BatchItem, out_palettes: []f32, out_bounds: ?[]Bounds) !void {
+        try evalBatch3x4(&self.workspaces[worker], frame, items, out_palettes, out_bounds);
+    }
+
+    /// `evalBatch3x4` of `worker`'s chunk of the whole batch, into the same
+    /// slots of the whole batch's outputs. Running every worker's chunk, on
+    /// any threads, evaluates the batch.
+    pub fn evaluateChunk(self: *BatchEvaluator, worker: usize, frame: u64, items: []const BatchItem, out_palettes: []f32, out_bounds: ?[]Bounds) !void {
+        const floats = self.paletteFloats();
+        if (worker >= self.workspaces.len) return OzzError.InvalidArgument;
+        if (out_palettes.len < items.len * floats) return OzzError.InvalidArgument;
+        if (out_bounds) |bounds| if (bounds.len < items.len) return OzzError.InvalidArgument;
+
+        const range = self.chunk(worker, items.len);
+        if (range.first == range.last) return;
+        try self.evaluateOn(
+            worker,
+            frame,
+            items[range.first..range.last],
+            out_palettes[range.first * floats .. range.last * floats],
+            if (out_bounds) |bounds| bounds[range.first..range.last] else null,
+        );
+    }
+};
+
+// --------------------
+// Skinning
+// --------------------
+
+pub const SkinJoints = union(enum) {
+    u16: []const u16,
+    u8: []const u8,
+};
+
+pub const SkinWeights = union(enum) {
+    /// Single-influence meshes carry no weights.
+    none,
+    f32: []const f32,
+    unorm8: []const u8,
+};
+
+pub const SkinVectors = union(enum) {
+    f32: []const f32,
+    f16: []const f16,
+};
+
+/// Linear blend skinning following ozz SkinningJob conventions: `influences`
+/// joints and `influences - 1` weights per vertex, the last weight being
+/// 1 - sum(others). `matrices` are skinning matrices in the palette 3x4 layout.
+/// Setting `dual_quats` instead (see `Workspace.dualQuats`) switches to dual
+/// quaternion skinning.
+pub const SkinningDesc = struct {
+    matrices: []const f32 = &.{},
+    dual_quats: ?[]const f32 = null,
+    influences: i32,
+    joints: SkinJoints,
+    weights: SkinWeights,
+    positions: SkinVectors,
+    normals: ?SkinVectors = null,
+    out_positions: []f32,
+    out_normals: ?[]f32 = null,
+};
+
+fn skinningDesc(desc: SkinningDesc) c.ozz_skinning_desc_t {
+    var out = std.mem.zeroes(c.ozz_skinning_desc_t);
+    if (desc.dual_quats) |dual_quats| {
+        out.dual_quats = dual_quats.ptr;
+        out.matrix_count = @intCast(dual_quats.len / 8);
+    } else {
+        out.matrices_3x4 = desc.matrices.ptr;
+        out.matrix_count = @intCast(desc.matrices.len / 12);
+    }
+    out.vertex_count = @intCast(desc.out_positions.len / 3);
+    out.influences = desc.influences;
+    switch (desc.joints) {
+        .u16 => |joints| out.joints_u16 = joints.ptr,
+        .u8 => |joints| out.joints_u8 = joints.ptr,
+    }
+    switch (desc.weights) {
+        .none => {},
+        .f32 => |weights| out.weights_f32 = weights.ptr,
+        .unorm8 => |weights| out.weights_unorm8 = weights.ptr,
+    }
+    switch (desc.positions) {
+        .f32 => |positions| out.positions_f32 = positions.ptr,
+        .f16 => |positions| out.positions_f16 = @ptrCast(positions.ptr),
+    }
+    if (desc.normals) |normals| switch (normals) {
+        .f32 => |n| out.normals_f32 = n.ptr,
+        .f16 => |n| out.normals_f16 = @ptrCast(n.ptr),
+    };
+    if (desc.out_normals) |normals| out.out_normals = normals.ptr;
+    return out;
+}
+
+pub fn skin(desc: SkinningDesc) !void {
+    const c_desc = skinningDesc(desc);
+    try mapResult(c.ozz_skin(&c_desc));
+}
+
+extern fn ozz_skin_reference(desc: *const c.ozz_skinning_desc_t) c.ozz_result_t;
+
+fn skinReference(desc: SkinningDesc) !void {
+    const c_desc = skinningDesc(desc);
+    try mapResult(ozz_skin_reference(&c_desc));
+}
+
+/// Staged eval: instance bounds, once every task is done.
+pub fn evalBounds(inst: *Instance, ws: *Workspace) !void {
+    try mapResult(c.ozz_eval_bounds(inst.handle, ws.handle));
+}
+
+extern fn ozz_eval_model_3x4_reference(inst: *c.ozz_instance_t, ws: *c.ozz_workspace_t) c.ozz_result_t;
+
+fn evalModel3x4Reference(inst: *Instance, ws: *Workspace) ![]const f32 {
+    try mapResult(ozz_eval_model_3x4_reference(inst.handle, ws.handle));
+    return ws.palette3x4();
+}
+
+fn expectSlicesApproxEqAbs(expected: []const f32, actual: []const f32, tolerance: f32) !void {
+    try std.testing.expectEqual(expected.len, actual.len);
+    for (expected, actual) |exp, act| {
+        try std.testing.expectApproxEqAbs(exp, act, tolerance);
+    }
+}
+
+fn copyPalette(allocator: std.mem.Allocator, palette: []const f32) ![]f32 {
+    const out = try allocator.alloc(f32, palette.len);
+    @memcpy(out, palette);
+    return out;
+}
+
+fn paletteTranslation(palette: []const f32, joint: usize) Vec3 {
+    const base = joint * 12;
+    return .{
+        .x = palette[base + 9],
+        .y = palette[base + 10],
+        .z = palette[base + 11],
+    };
+}
+
+fn paletteColumn(palette: []const f32, joint: usize, col: usize) Vec3 {
+    const base = joint * 12 + col * 3;
+    return .{
+        .x = palette[base + 0],
+        .y = palette[base + 1],
+        .z = palette[base + 2],
+    };
+}
+
+fn vec3Add(a: Vec3, b: Vec3) Vec3 {
+    return .{ .x = a.x + b.x, .y = a.y + b.y, .z = a.z + b.z };
+}
+
+fn vec3Sub(a: Vec3, b: Vec3) Vec3 {
+    return .{ .x = a.x - b.x, .y = a.y - b.y, .z = a.z - b.z };
+}
+
+fn vec3Length(v: Vec3) f32 {
+    return @sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+fn paletteDifferenceL1(a: []const f32, b: []const f32) f32 {
+    var sum: f32 = 0;
+    for (a, b) |av, bv| sum += @abs(av - bv);
     return sum;
 }
 
@@ -551,6 +1457,11 @@ fn testAllocator() std.mem.Allocator {
 // Tests
 // --------------------
 
+extern fn ozz_gv4_encode_stream(values: [*]const u32, count: usize, out: [*]u8, out_capacity: usize) usize;
+extern fn ozz_gv4_decode_stream(in: [*]const u8, in_size: usize, values: [*]u32, count: usize) usize;
+extern fn ozz_gv4_decode_stream_reference(in: [*]const u8, in_size: usize, values: [*]u32, count: usize) usize;
+extern fn ozz_animation_drop_track_index(anim: *c.ozz_animation_t) void;
+
 test "ozz C ABI wrapper: load + 2-clip blend + 3x4 palette is sane" {
     const A = testAllocator();
     defer resetAllocator() catch unreachable;
@@ -570,7 +1481,7 @@ test "ozz C ABI wrapper: load + 2-clip blend + 3x4 palette is sane" {
     var ws = try Workspace.init(A, skel);
     defer ws.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = jog, .ratio = 0.10, .weight = 0.35, .mode = .normal },
         .{ .anim = walk, .ratio = 0.10, .weight = 0.65, .mode = .normal },
     });
@@ -637,6 +1548,92 @@ test "ratio helper converts normalized phase to animation seconds" {
     try std.testing.expectApproxEqAbs(0.25, layer.ratio, 1e-6);
 }
 
+test "key-to-track index samples exactly like scanning for each key's track" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var indexed = try Animation.loadFromFileZ("assets/pab_run_no_motion.ozz");
+    defer indexed.deinit();
+    var scanned = try Animation.loadFromFileZ("assets/pab_run_no_motion.ozz");
+    defer scanned.deinit();
+    ozz_animation_drop_track_index(scanned.handle);
+
+    var inst_indexed = try Instance.init(A, skel);
+    defer inst_indexed.deinit(A);
+    var inst_scanned = try Instance.init(A, skel);
+    defer inst_scanned.deinit(A);
+
+    var ws_indexed = try Workspace.init(A, skel);
+    defer ws_indexed.deinit(A);
+    var ws_scanned = try Workspace.init(A, skel);
+    defer ws_scanned.deinit(A);
+
+    // Forward, backward, then random seeks, so the cache is updated and rewound.
+    var prng = std.Random.DefaultPrng.init(0x6b6579);
+    const random = prng.random();
+    for (0..300) |i| {
+        const ratio: f32 = if (i < 100)
+            @as(f32, @floatFromInt(i)) / 99.0
+        else if (i < 200)
+            @as(f32, @floatFromInt(199 - i)) / 99.0
+        else
+            random.float(f32);
+        try inst_indexed.setLayers(&[_]Layer{.{ .anim = indexed, .ratio = ratio, .weight = 1.0, .mode = .normal }});
+        try inst_scanned.setLayers(&[_]Layer{.{ .anim = scanned, .ratio = ratio, .weight = 1.0, .mode = .normal }});
+        const expected = try copyPalette(A, try evalModel3x4(&inst_scanned, &ws_scanned));
+        defer A.free(expected);
+        try std.testing.expectEqualSlices(f32, expected, try evalModel3x4(&inst_indexed, &ws_indexed));
+    }
+}
+
+test "reverse playback and seeks sample like stepping forward from the start" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var run = try Animation.loadFromFileZ("assets/pab_run_no_motion.ozz");
+    defer run.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    var ws_forward = try Workspace.init(A, skel);
+    defer ws_forward.deinit(A);
+
+    // Plays backward through the loop point, then jumps both ways far enough
+    // to seek from either end of the clip.
+    var ratio: f32 = 0.0;
+    for (0..300) |i| {
+        if (i < 200) {
+            ratio = if (ratio > 0.013) ratio - 0.013 else 1.0;
+        } else {
+            ratio = if (ratio > 0.6) ratio - 0.6 else ratio + 0.4;
+        }
+        try inst.setLayers(&[_]Layer{.{ .anim = run, .ratio = ratio, .weight = 1.0, .mode = .normal }});
+        const actual = try copyPalette(A, try evalModel3x4(&inst, &ws));
+        defer A.free(actual);
+
+        // A fresh instance reaching the same ratio in small steps never seeks.
+        var forward = try Instance.init(A, skel);
+        defer forward.deinit(A);
+        var step: f32 = 0.0;
+        while (true) : (step += 0.05) {
+            try forward.setLayers(&[_]Layer{.{ .anim = run, .ratio = @min(step, ratio), .weight = 1.0, .mode = .normal }});
+            const expected = try evalModel3x4(&forward, &ws_forward);
+            if (step >= ratio) {
+                try std.testing.expectEqualSlices(f32, expected, actual);
+                break;
+            }
+        }
+    }
+}
+
 test "evalModel3x4 matches upstream reference for a single normal clip" {
     const A = testAllocator();
     defer resetAllocator() catch unreachable;
@@ -656,7 +1653,7 @@ test "evalModel3x4 matches upstream reference for a single normal clip" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
     });
 
@@ -692,7 +1689,7 @@ test "evalModel3x4 matches upstream reference for mixed normal layers" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = jog, .ratio = 0.10, .weight = 0.20, .mode = .normal },
         .{ .anim = walk, .ratio = 0.25, .weight = 0.35, .mode = .normal },
         .{ .anim = run, .ratio = 0.40, .weight = 0.45, .mode = .normal },
@@ -730,7 +1727,7 @@ test "evalModel3x4 matches upstream reference for additive hand poses" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = curl, .ratio = 0.0, .weight = 0.30, .mode = .additive },
         .{ .anim = splay, .ratio = 0.0, .weight = 0.90, .mode = .additive },
@@ -765,7 +1762,7 @@ test "evalModel3x4 matches upstream reference for negative additive weights" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = curl, .ratio = 0.0, .weight = -0.50, .mode = .additive },
     });
@@ -808,27 +1805,27 @@ test "partial normal layer masks obey zero and one semantics" {
     defer A.free(one_mask);
     @memset(one_mask, 1);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
     });
     const base = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
     defer A.free(base);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = jog, .ratio = 0.25, .weight = 0.5, .mode = .normal, .joint_weights = zero_mask },
     });
     const zeroed = try evalModel3x4(&inst, &ws_b);
     try expectSlicesApproxEqAbs(base, zeroed, 1e-4);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = jog, .ratio = 0.25, .weight = 0.5, .mode = .normal },
     });
     const unmasked = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
     defer A.free(unmasked);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = jog, .ratio = 0.25, .weight = 0.5, .mode = .normal, .joint_weights = one_mask },
     });
@@ -867,27 +1864,27 @@ test "partial additive layer masks obey zero and one semantics" {
     defer A.free(one_mask);
     @memset(one_mask, 1);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
     });
     const base = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
     defer A.free(base);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = curl, .ratio = 0.0, .weight = 0.6, .mode = .additive, .joint_weights = zero_mask },
     });
     const zeroed = try evalModel3x4(&inst, &ws_b);
     try expectSlicesApproxEqAbs(base, zeroed, 1e-4);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = curl, .ratio = 0.0, .weight = 0.6, .mode = .additive },
     });
     const unmasked = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
     defer A.free(unmasked);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = curl, .ratio = 0.0, .weight = 0.6, .mode = .additive, .joint_weights = one_mask },
     });
@@ -929,7 +1926,7 @@ test "partial normal blend with sparse mask matches upstream reference" {
         };
     }
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
         .{ .anim = run, .ratio = 0.30, .weight = 0.7, .mode = .normal, .joint_weights = mask },
     });
@@ -957,12 +1954,12 @@ test "sampling rejects out-of-range ratios" {
     var ws_a = try Workspace.init(A, skel);
     defer ws_a.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = -0.1, .weight = 1.0, .mode = .normal },
     });
     try std.testing.expectError(OzzError.InvalidArgument, evalModel3x4(&inst, &ws_a));
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 1.1, .weight = 1.0, .mode = .normal },
     });
     try std.testing.expectError(OzzError.InvalidArgument, evalModel3x4(&inst, &ws_a));
@@ -993,7 +1990,7 @@ test "aim IK matches upstream reference and changes the pose" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
     });
     inst.setIkJobs(&.{});
@@ -1052,7 +2049,7 @@ test "two-bone IK matches upstream reference and changes the pose" {
     var ws_reference = try Workspace.init(A, skel);
     defer ws_reference.deinit(A);
 
-    inst.setLayers(&[_]Layer{
+    try inst.setLayers(&[_]Layer{
         .{ .anim = walk, .ratio = 0.10, .weight = 1.0, .mode = .normal },
     });
     inst.setIkJobs(&.{});
@@ -1091,20 +2088,1344 @@ test "two-bone IK matches upstream reference and changes the pose" {
     try std.testing.expect(actual_distance < base_distance * 0.4);
 }
 
-test "load-time Ozz allocations route through installed Zig allocator" {
-    var counting = CountingAllocator{ .backing = std.testing.allocator };
-    try installAllocator(counting.allocator());
+test "retargeting a skeleton onto itself matches direct sampling" {
+    const A = testAllocator();
     defer resetAllocator() catch unreachable;
 
-    {
-        var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
-        defer skel.deinit();
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
 
-        var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
-        defer walk.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+
+    var rt = try Retarget.init(skel, skel);
+    defer rt.deinit();
+    try std.testing.expectEqual(skel.numJoints(), rt.sourceTracks());
+    try std.testing.expectEqual(@as(i32, 3), rt.sourceJoint(3));
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws_direct = try Workspace.init(A, skel);
+    defer ws_direct.deinit(A);
+
+    var ws_retarget = try Workspace.init(A, skel);
+    defer ws_retarget.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.30, .weight = 1.0, .mode = .normal },
+        .{ .anim = curl, .ratio = 0.0, .weight = 0.7, .mode = .additive },
+    });
+    const direct = try copyPalette(A, try evalModel3x4(&inst, &ws_direct));
+    defer A.free(direct);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.30, .weight = 1.0, .mode = .normal, .retarget = rt },
+        .{ .anim = curl, .ratio = 0.0, .weight = 0.7, .mode = .additive, .retarget = rt },
+    });
+    const retargeted = try evalModel3x4(&inst, &ws_retarget);
+    try expectSlicesApproxEqAbs(direct, retargeted, 1e-4);
+}
+
+test "retarget with no mapped joints yields the target rest pose" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+
+    const joints: usize = @intCast(skel.numJoints());
+    const unmapped = try A.alloc(i32, joints);
+    defer A.free(unmapped);
+    @memset(unmapped, -1);
+
+    var rt = try Retarget.initWithMap(skel, skel, unmapped);
+    defer rt.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws_a = try Workspace.init(A, skel);
+    defer ws_a.deinit(A);
+
+    var ws_b = try Workspace.init(A, skel);
+    defer ws_b.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.30, .weight = 1.0, .mode = .normal, .retarget = rt },
+    });
+    const from_walk = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
+    defer A.free(from_walk);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = jog, .ratio = 0.80, .weight = 1.0, .mode = .normal, .retarget = rt },
+    });
+    const from_jog = try evalModel3x4(&inst, &ws_b);
+    try expectSlicesApproxEqAbs(from_walk, from_jog, 1e-5);
+}
+
+test "sparse track map masks normal layers like a zero/one joint mask" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+
+    // Drives every third joint from the matching walk track, as a clip
+    // exported with only those tracks would.
+    const joints: usize = @intCast(skel.numJoints());
+    const track_to_joint = try A.alloc(i32, joints);
+    defer A.free(track_to_joint);
+    const mask = try A.alloc(f32, joints);
+    defer A.free(mask);
+    for (track_to_joint, mask, 0..) |*joint, *weight, j| {
+        const driven = j % 3 == 0;
+        joint.* = if (driven) @intCast(j) else -1;
+        weight.* = if (driven) 1.0 else 0.0;
     }
 
-    try std.testing.expect(counting.allocations > 0);
-    try std.testing.expect(counting.deallocations > 0);
-    try std.testing.expectEqual(counting.allocated_bytes, counting.freed_bytes);
+    var rt = try Retarget.initSparse(skel, track_to_joint);
+    defer rt.deinit();
+    try std.testing.expectEqual(@as(i32, 3), rt.sourceJoint(3));
+    try std.testing.expectEqual(@as(i32, -1), rt.sourceJoint(4));
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws_a = try Workspace.init(A, skel);
+    defer ws_a.deinit(A);
+
+    var ws_b = try Workspace.init(A, skel);
+    defer ws_b.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = jog, .ratio = 0.25, .weight = 1.0, .mode = .normal },
+        .{ .anim = walk, .ratio = 0.60, .weight = 1.0, .mode = .normal, .joint_weights = mask },
+    });
+    const masked = try copyPalette(A, try evalModel3x4(&inst, &ws_a));
+    defer A.free(masked);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = jog, .ratio = 0.25, .weight = 1.0, .mode = .normal },
+        .{ .anim = walk, .ratio = 0.60, .weight = 1.0, .mode = .normal, .retarget = rt },
+    });
+    const sparse = try evalModel3x4(&inst, &ws_b);
+    try expectSlicesApproxEqAbs(masked, sparse, 1e-4);
+}
+
+test "staged parallel local-to-model matches a single eval at every split depth" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws_serial = try Workspace.init(A, skel);
+    defer ws_serial.deinit(A);
+
+    var ws_staged = try Workspace.init(A, skel);
+    defer ws_staged.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.30, .weight = 1.0, .mode = .normal },
+        .{ .anim = curl, .ratio = 0.0, .weight = 0.6, .mode = .additive },
+    });
+    const serial = try evalModel3x4(&inst, &ws_serial);
+
+    var split_depth: i32 = 0;
+    while (split_depth < 8) : (split_depth += 1) {
+        var partition = try LtmPartition.init(skel, split_depth, 3);
+        defer partition.deinit();
+
+        var joints = partition.trunkJoints();
+        var task: i32 = 0;
+        while (task < partition.taskCount()) : (task += 1) joints += partition.taskJoints(task);
+        try std.testing.expectEqual(skel.numJoints(), joints);
+
+        // Tasks are independent: run them back to front.
+        try evalLocals(&inst, &ws_staged);
+        try evalLtmTrunk(&inst, &ws_staged, partition);
+        task = partition.taskCount();
+        while (task > 0) {
+            task -= 1;
+            try evalLtmTask(&inst, &ws_staged, partition, task);
+        }
+        try std.testing.expectEqualSlices(f32, serial, ws_staged.palette3x4());
+    }
+}
+
+test "level-ordered SoA local-to-model matches upstream with IK" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws_actual = try Workspace.init(A, skel);
+    defer ws_actual.deinit(A);
+
+    var ws_reference = try Workspace.init(A, skel);
+    defer ws_reference.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.45, .weight = 1.0, .mode = .normal },
+    });
+    inst.setIkJobs(&[_]IkJob{
+        IkJob.aim(skel.findJointZ("Head"), .{ .x = 1.0, .y = 1.5, .z = 1.0 }, .{ .x = 1.0, .y = 0.0, .z = 0.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 }, 1.0),
+    });
+    inst.setLtmMode(.level_soa);
+
+    const actual = try copyPalette(A, try evalModel3x4(&inst, &ws_actual));
+    defer A.free(actual);
+
+    const reference = try evalModel3x4Reference(&inst, &ws_reference);
+    try expectSlicesApproxEqAbs(reference, actual, 1e-5);
+}
+
+test "skinning matches ozz SkinningJob for full and compact vertex formats" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.3, .weight = 1.0, .mode = .normal },
+    });
+    const palette = try evalModel3x4(&inst, &ws);
+    const num_joints: usize = @intCast(skel.numJoints());
+
+    // Odd count so the SIMD path leaves a scalar tail.
+    const vertex_count = 1003;
+    const influences = 4;
+
+    var prng = std.Random.DefaultPrng.init(0x5eed);
+    const random = prng.random();
+
+    const joints = try A.alloc(u8, vertex_count * influences);
+    defer A.free(joints);
+    const joints16 = try A.alloc(u16, joints.len);
+    defer A.free(joints16);
+    for (joints, joints16) |*j, *j16| {
+        j.* = @intCast(random.uintLessThan(usize, num_joints));
+        j16.* = j.*;
+    }
+
+    const weights = try A.alloc(u8, vertex_count * (influences - 1));
+    defer A.free(weights);
+    const weights32 = try A.alloc(f32, weights.len);
+    defer A.free(weights32);
+    for (weights, weights32) |*w, *w32| {
+        w.* = random.uintLessThan(u8, 85);
+        w32.* = @as(f32, @floatFromInt(w.*)) / 255.0;
+    }
+
+    const positions = try A.alloc(f16, vertex_count * 3);
+    defer A.free(positions);
+    const positions32 = try A.alloc(f32, positions.len);
+    defer A.free(positions32);
+    const normals = try A.alloc(f16, vertex_count * 3);
+    defer A.free(normals);
+    const normals32 = try A.alloc(f32, normals.len);
+    defer A.free(normals32);
+    for (positions, positions32, normals, normals32) |*p, *p32, *n, *n32| {
+        p.* = @floatCast(random.float(f32) * 2.0 - 1.0);
+        p32.* = p.*;
+        n.* = @floatCast(random.float(f32) * 2.0 - 1.0);
+        n32.* = n.*;
+    }
+
+    const out = try A.alloc(f32, vertex_count * 3 * 4);
+    defer A.free(out);
+    const expected_positions = out[0 .. vertex_count * 3];
+    const expected_normals = out[vertex_count * 3 .. vertex_count * 6];
+    const actual_positions = out[vertex_count * 6 .. vertex_count * 9];
+    const actual_normals = out[vertex_count * 9 ..];
+
+    const full = SkinningDesc{
+        .matrices = palette,
+        .influences = influences,
+        .joints = .{ .u16 = joints16 },
+        .weights = .{ .f32 = weights32 },
+        .positions = .{ .f32 = positions32 },
+        .normals = .{ .f32 = normals32 },
+        .out_positions = expected_positions,
+        .out_normals = expected_normals,
+    };
+    try skinReference(full);
+
+    var actual = full;
+    actual.out_positions = actual_positions;
+    actual.out_normals = actual_normals;
+    try skin(actual);
+    try expectSlicesApproxEqAbs(expected_positions, actual_positions, 1e-5);
+    try expectSlicesApproxEqAbs(expected_normals, actual_normals, 1e-5);
+
+    const compact = SkinningDesc{
+        .matrices = palette,
+        .influences = influences,
+        .joints = .{ .u8 = joints },
+        .weights = .{ .unorm8 = weights },
+        .positions = .{ .f16 = positions },
+        .normals = .{ .f16 = normals },
+        .out_positions = actual_positions,
+        .out_normals = actual_normals,
+    };
+    try skin(compact);
+    try expectSlicesApproxEqAbs(expected_positions, actual_positions, 1e-5);
+    try expectSlicesApproxEqAbs(expected_normals, actual_normals, 1e-5);
+}
+
+test "dual quaternion skinning matches rigid matrix skinning and keeps twist volume" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.3, .weight = 1.0, .mode = .normal },
+    });
+    const palette = try evalModel3x4(&inst, &ws);
+    const num_joints: usize = @intCast(skel.numJoints());
+
+    const dq_storage = try A.alloc(f32, num_joints * 8);
+    defer A.free(dq_storage);
+    const dual_quats = try ws.dualQuats(null, dq_storage);
+
+    // With a single influence both methods apply the joint's rigid transform.
+    const vertex_count = 1003;
+    var prng = std.Random.DefaultPrng.init(0xd0a1);
+    const random = prng.random();
+
+    const joints = try A.alloc(u16, vertex_count);
+    defer A.free(joints);
+    for (joints) |*j| j.* = @intCast(random.uintLessThan(usize, num_joints));
+    const positions = try A.alloc(f32, vertex_count * 3);
+    defer A.free(positions);
+    for (positions) |*p| p.* = random.float(f32) * 2.0 - 1.0;
+
+    const out = try A.alloc(f32, vertex_count * 3 * 2);
+    defer A.free(out);
+    const expected = out[0 .. vertex_count * 3];
+    const actual = out[vertex_count * 3 ..];
+
+    try skin(.{
+        .matrices = palette,
+        .influences = 1,
+        .joints = .{ .u16 = joints },
+        .weights = .none,
+        .positions = .{ .f32 = positions },
+        .out_positions = expected,
+    });
+    try skin(.{
+        .dual_quats = dual_quats,
+        .influences = 1,
+        .joints = .{ .u16 = joints },
+        .weights = .none,
+        .positions = .{ .f32 = positions },
+        .out_positions = actual,
+    });
+    try expectSlicesApproxEqAbs(expected, actual, 1e-4);
+
+    // Half way between identity and a half turn about x (stored in the
+    // opposite hemisphere): matrix blending collapses onto the axis, dual
+    // quaternions keep the distance to it.
+    const twist = [_]f32{ 0, 0, 0, 1, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0 };
+    const twist_joints = [_]u16{ 0, 1 };
+    const twist_weights = [_]f32{0.5};
+    const twist_position = [_]f32{ 0.25, 1.0, 0.0 };
+    var twisted: [3]f32 = undefined;
+    try skin(.{
+        .dual_quats = &twist,
+        .influences = 2,
+        .joints = .{ .u16 = &twist_joints },
+        .weights = .{ .f32 = &twist_weights },
+        .positions = .{ .f32 = &twist_position },
+        .out_positions = &twisted,
+    });
+    try std.testing.expectApproxEqAbs(@as(f32, 0.25), twisted[0], 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), @sqrt(twisted[1] * twisted[1] + twisted[2] * twisted[2]), 1e-5);
+}
+
+test "mesh palettes gather the mesh joints with inverse binds applied" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.6, .weight = 1.0, .mode = .normal },
+    });
+    const palette = try evalModel3x4(&inst, &ws);
+
+    // Inverse binds are pure translations, so the expected matrices are easy
+    // to build from the full palette.
+    const joints = [_]i32{ skel.findJointZ("LeftHand"), skel.findJointZ("Head"), 0 };
+    var inverse_binds = [_]f32{0} ** (joints.len * 12);
+    for (0..joints.len) |k| {
+        inverse_binds[k * 12 + 0] = 1;
+        inverse_binds[k * 12 + 4] = 1;
+        inverse_binds[k * 12 + 8] = 1;
+        inverse_binds[k * 12 + 10] = -@as(f32, @floatFromInt(k));
+    }
+
+    var mesh = try MeshRemap.init(skel, &joints, &inverse_binds);
+    defer mesh.deinit();
+    try std.testing.expectEqual(joints.len, mesh.jointCount());
+
+    var too_small: [joints.len * 12 - 1]f32 = undefined;
+    try std.testing.expectError(OzzError.InvalidArgument, ws.meshPalette3x4(mesh, &too_small));
+
+    var storage: [joints.len * 12]f32 = undefined;
+    const mesh_palette = try ws.meshPalette3x4(mesh, &storage);
+    for (joints, 0..) |joint, k| {
+        const full = palette[@as(usize, @intCast(joint)) * 12 ..][0..12];
+        const compact = mesh_palette[k * 12 ..][0..12];
+        try expectSlicesApproxEqAbs(full[0..9], compact[0..9], 1e-6);
+        const offset = -@as(f32, @floatFromInt(k));
+        const t = vec3Add(paletteTranslation(palette, @intCast(joint)), .{
+            .x = full[3] * offset,
+            .y = full[4] * offset,
+            .z = full[5] * offset,
+        });
+        try std.testing.expectApproxEqAbs(t.x, compact[9], 1e-5);
+        try std.testing.expectApproxEqAbs(t.y, compact[10], 1e-5);
+        try std.testing.expectApproxEqAbs(t.z, compact[11], 1e-5);
+    }
+
+    var dq_storage: [joints.len * 8]f32 = undefined;
+    const dual_quats = try ws.meshDualQuats(mesh, &dq_storage);
+    try std.testing.expectEqual(joints.len * 8, dual_quats.len);
+}
+
+test "eval bounds enclose joint positions, or the posed mesh joint boxes" {
+    const A = testAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.3, .weight = 1.0, .mode = .normal },
+    });
+    const palette = try evalModel3x4(&inst, &ws);
+    const num_joints: usize = @intCast(skel.numJoints());
+
+    const joint_bounds = try ws.bounds();
+    var min = paletteTranslation(palette, 0);
+    var max = min;
+    for (1..num_joints) |j| {
+        const t = paletteTranslation(palette, j);
+        min = .{ .x = @min(min.x, t.x), .y = @min(min.y, t.y), .z = @min(min.z, t.z) };
+        max = .{ .x = @max(max.x, t.x), .y = @max(max.y, t.y), .z = @max(max.z, t.z) };
+    }
+    try std.testing.expectEqual(min, joint_bounds.min);
+    try std.testing.expectEqual(max, joint_bounds.max);
+
+    // A 10cm cube around every joint, with identity inverse binds.
+    const joints = try A.alloc(i32, num_joints);
+    defer A.free(joints);
+    const inverse_binds = try A.alloc(f32, num_joints * 12);
+    defer A.free(inverse_binds);
+    const boxes = try A.alloc(f32, num_joints * 6);
+    defer A.free(boxes);
+    @memset(inverse_binds, 0);
+    for (joints, 0..) |*joint, j| {
+        joint.* = @intCast(j);
+        inverse_binds[j * 12 + 0] = 1;
+        inverse_binds[j * 12 + 4] = 1;
+        inverse_binds[j * 12 + 8] = 1;
+        @memcpy(boxes[j * 6 ..][0..6], &[_]f32{ -0.05, -0.05, -0.05, 0.05, 0.05, 0.05 });
+    }
+
+    var mesh = try MeshRemap.init(skel, joints, inverse_binds);
+    defer mesh.deinit();
+    try mesh.setJointBounds(boxes);
+    try inst.setBoundsMesh(mesh);
+    _ = try evalModel3x4(&inst, &ws);
+
+    const mesh_bounds = try ws.bounds();
+    for (0..num_joints) |j| {
+        const t = paletteTranslation(palette, j);
+        try std.testing.expect(t.x > mesh_bounds.min.x and t.x < mesh_bounds.max.x);
+        try std.testing.expect(t.y > mesh_bounds.min.y and t.y < mesh_bounds.max.y);
+        try std.testing.expect(t.z > mesh_bounds.min.z and t.z < mesh_bounds.max.z);
+    }
+    try std.testing.expect(mesh_bounds.min.x <= joint_bounds.min.x - 0.049);
+    try std.testing.expect(mesh_bounds.max.y >= joint_bounds.max.y + 0.049);
+
+    try inst.setBoundsMesh(null);
+}
+
+test "instance init and deinit never touch the Ozz allocator" {
+    var counting = CountingAllocator{ .backing = std.testing.allocator };
+    try installAllocator(counting.allocator());
+    defer resetAllocator() catch unreachable;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    const allocations = counting.allocations;
+    const deallocations = counting.deallocations;
+
+    // Sampling contexts live in caller memory, so workers spawning
+    // characters concurrently share no lock and no allocator.
+    const Worker = struct {
+        fn run(worker_skel: Skeleton, worker_walk: Animation, failures: *std.atomic.Value(u32)) void {
+            const A = std.heap.smp_allocator;
+            for (0..16) |i| {
+                var inst = Instance.init(A, worker_skel) catch {
+                    _ = failures.fetchAdd(1, .monotonic);
+                    return;
+                };
+                defer inst.deinit(A);
+                var ws = Workspace.init(A, worker_skel) catch {
+                    _ = failures.fetchAdd(1, .monotonic);
+                    return;
+                };
+                defer ws.deinit(A);
+
+                const ratio = @as(f32, @floatFromInt(i)) / 16.0;
+                inst.setLayers(&[_]Layer{
+                    .{ .anim = worker_walk, .ratio = ratio, .weight = 1.0, .mode = .normal },
+                }) catch unreachable;
+                _ = evalModel3x4(&inst, &ws) catch {
+                    _ = failures.fetchAdd(1, .monotonic);
+                };
+            }
+        }
+    };
+
+    var failures = std.atomic.Value(u32).init(0);
+    var threads: [4]std.Thread = undefined;
+    for (&threads) |*thread| thread.* = try std.Thread.spawn(.{}, Worker.run, .{ skel, walk, &failures });
+    for (threads) |thread| thread.join();
+
+    try std.testing.expectEqual(@as(u32, 0), failures.load(.monotonic));
+    try std.testing.expectEqual(allocations, counting.allocations);
+    try std.testing.expectEqual(deallocations, counting.deallocations);
+}
+
+test "group varint stream decoder matches the scalar group decoder" {
+    var prng = std.Random.DefaultPrng.init(0x6f7a7a);
+    const random = prng.random();
+
+    var values: [256]u32 = undefined;
+    var decoded: [256]u32 = undefined;
+    var reference: [256]u32 = undefined;
+    // Worst case size plus the 3 bytes the scalar decoder may read past a group.
+    var buffer: [256 * 4 + 256 / 4 + 3]u8 = undefined;
+
+    for (0..500) |_| {
+        const count = random.uintLessThan(usize, values.len / 4 + 1) * 4;
+        for (values[0..count]) |*v| {
+            const bytes = random.uintLessThan(u5, 4) + 1;
+            v.* = if (bytes == 4) random.int(u32) else random.int(u32) & ((@as(u32, 1) << (bytes * 8)) - 1);
+        }
+        const written = ozz_gv4_encode_stream(&values, count, &buffer, buffer.len);
+        const size = @max(written + 3, count + count / 4);
+        try std.testing.expectEqual(written, ozz_gv4_decode_stream(&buffer, size, &decoded, count));
+        try std.testing.expectEqualSlices(u32, values[0..count], decoded[0..count]);
+
+        // Arbitrary bytes decode to whatever the scalar decoder reads.
+        random.bytes(&buffer);
+        const in_size = count * 4 + count / 4 + 3;
+        try std.testing.expectEqual(
+            ozz_gv4_decode_stream_reference(&buffer, in_size, &reference, count),
+            ozz_gv4_decode_stream(&buffer, in_size, &decoded, count),
+        );
+        try std.testing.expectEqualSlices(u32, reference[0..count], decoded[0..count]);
+    }
+}
+
+test "arena allocator pools loads per thread and frees across threads" {
+    // Heap blocks freed after the switch would reach the arena.
+    var heap_skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    try std.testing.expectError(OzzError.InvalidArgument, installArenaAllocator());
+    heap_skel.deinit();
+
+    try installArenaAllocator();
+    defer resetAllocator() catch unreachable;
+
+    var skels: [4]Skeleton = undefined;
+    var anims: [4]Animation = undefined;
+    const Worker = struct {
+        fn run(skel: *Skeleton, anim: *Animation, failures: *std.atomic.Value(u32)) void {
+            skel.* = Skeleton.loadFromFileZ("assets/pab_skeleton.ozz") catch {
+                _ = failures.fetchAdd(1, .monotonic);
+                return;
+            };
+            anim.* = Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz") catch {
+                _ = failures.fetchAdd(1, .monotonic);
+                return;
+            };
+        }
+    };
+
+    var failures = std.atomic.Value(u32).init(0);
+    var threads: [4]std.Thread = undefined;
+    for (&threads, &skels, &anims) |*thread, *skel, *anim| {
+        thread.* = try std.Thread.spawn(.{}, Worker.run, .{ skel, anim, &failures });
+    }
+    for (threads) |thread| thread.join();
+    try std.testing.expectEqual(@as(u32, 0), failures.load(.monotonic));
+
+    var stats_buf: [16]ArenaStats = undefined;
+    var live: usize = 0;
+    for (try arenaStats(&stats_buf)) |stats| live += stats.live_bytes;
+    try std.testing.expect(live > 0);
+    try std.testing.expectError(OzzError.InvalidArgument, resetArenaAllocator());
+
+    // The workers are gone, so every block goes back to its arena's remote list.
+    for (&skels, &anims) |*skel, *anim| {
+        anim.deinit();
+        skel.deinit();
+    }
+
+    var peak: usize = 0;
+    for (try arenaStats(&stats_buf)) |stats| {
+        try std.testing.expectEqual(@as(usize, 0), stats.live_bytes);
+        peak = @max(peak, stats.peak_bytes);
+    }
+    try std.testing.expect(peak > 0);
+
+    try resetArenaAllocator();
+    for (try arenaStats(&stats_buf)) |stats| {
+        try std.testing.expectEqual(@as(usize, 0), stats.reserved_bytes);
+        try std.testing.expectEqual(@as(u64, 0), stats.allocations);
+    }
+}
+
+test "evaluation never allocates over a long run" {
+    var counting = CountingAllocator{ .backing = std.testing.allocator };
+    try installAllocator(counting.allocator());
+    defer resetAllocator() catch unreachable;
+    const A = std.testing.allocator;
+
+    const skeleton_live = allocCounters(.skeleton).live_bytes;
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    try std.testing.expect(allocCounters(.skeleton).live_bytes > skeleton_live);
+
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+
+    var partition = try LtmPartition.init(skel, 3, 4);
+    defer partition.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+
+    setHotPathGuard(true);
+    defer setHotPathGuard(false);
+    const hot_path = hotPathAllocations();
+    const allocations = counting.allocations;
+    var totals: [std.meta.fields(AllocCategory).len]u64 = undefined;
+    for (&totals, 0..) |*total, category| total.* = allocCounters(@enumFromInt(category)).total_blocks;
+
+    for (0..10_000) |frame| {
+        const ratio = @as(f32, @floatFromInt(frame % 1000)) / 1000.0;
+        try inst.setLayers(&[_]Layer{
+            .{ .anim = walk, .ratio = ratio, .weight = 0.6, .mode = .normal },
+            .{ .anim = jog, .ratio = ratio, .weight = 0.4, .mode = .normal },
+            .{ .anim = curl, .ratio = ratio, .weight = 1.0, .mode = .additive },
+        });
+        if (frame % 2 == 0) {
+            _ = try evalModel3x4(&inst, &ws);
+        } else {
+            try evalLocals(&inst, &ws);
+            try evalLtmTrunk(&inst, &ws, partition);
+            var task: i32 = 0;
+            while (task < partition.taskCount()) : (task += 1) try evalLtmTask(&inst, &ws, partition, task);
+            try evalBounds(&inst, &ws);
+        }
+    }
+
+    try std.testing.expectEqual(hot_path, hotPathAllocations());
+    try std.testing.expectEqual(allocations, counting.allocations);
+    for (totals, 0..) |total, category| {
+        try std.testing.expectEqual(total, allocCounters(@enumFromInt(category)).total_blocks);
+    }
+}
+
+test "kernel tiers agree with each other and with staged evaluation" {
+    const A = std.testing.allocator;
+    defer setKernelTier(null) catch unreachable;
+    try std.testing.expectError(OzzError.InvalidArgument, setKernelTier("sse9"));
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+    var partition = try LtmPartition.init(skel, 3, 4);
+    defer partition.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    try inst.setLayers(&[_]Layer{
+        .{ .anim = walk, .ratio = 0.3, .weight = 0.6, .mode = .normal },
+        .{ .anim = jog, .ratio = 0.7, .weight = 0.4, .mode = .normal },
+        .{ .anim = curl, .ratio = 0.5, .weight = 1.0, .mode = .additive },
+    });
+
+    const floats = ws.palette3x4().len;
+    const baseline = try A.alloc(f32, floats);
+    defer A.free(baseline);
+    const staged = try A.alloc(f32, floats);
+    defer A.free(staged);
+
+    for ([_][:0]const u8{ "baseline", "avx2" }) |tier| {
+        setKernelTier(tier) catch |err| {
+            // Builds or cpus without the tier refuse it.
+            try std.testing.expectEqual(OzzError.InvalidArgument, err);
+            continue;
+        };
+        try std.testing.expectEqualStrings(tier, kernelTier());
+
+        for ([_]LtmMode{ .depth_first, .level_soa }) |mode| {
+            inst.setLtmMode(mode);
+            const palette = try evalModel3x4(&inst, &ws);
+            if (std.mem.eql(u8, tier, "baseline")) {
+                @memcpy(baseline, palette);
+            } else {
+                // FMA rounds differently, the poses are otherwise the same.
+                for (baseline, palette) |a, b| try std.testing.expectApproxEqAbs(a, b, 1e-5);
+            }
+        }
+
+        // Staged evaluation runs on the same tier, bit for bit.
+        inst.setLtmMode(.depth_first);
+        @memcpy(staged, try evalModel3x4(&inst, &ws));
+        try evalLocals(&inst, &ws);
+        try evalLtmTrunk(&inst, &ws, partition);
+        var task: i32 = 0;
+        while (task < partition.taskCount()) : (task += 1) try evalLtmTask(&inst, &ws, partition, task);
+        try std.testing.expectEqualSlices(f32, staged, ws.palette3x4());
+    }
+}
+
+test "batch evaluation over worker threads matches per-instance evaluation" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+
+    const count = 37;
+    var instances: [count]Instance = undefined;
+    var ready: usize = 0;
+    defer for (instances[0..ready]) |*inst| inst.deinit(A);
+    while (ready < count) : (ready += 1) instances[ready] = try Instance.init(A, skel);
+
+    // One contiguous descriptor array for the whole batch.
+    var layers: [count][3]LayerDesc = undefined;
+    var items: [count]BatchItem = undefined;
+    for (&layers, &items, &instances, 0..) |*item_layers, *item, *inst, i| {
+        const ratio = @as(f32, @floatFromInt(i)) / count;
+        item_layers.* = .{
+            LayerDesc.atRatio(walk, ratio, 0.6, .normal),
+            LayerDesc.atRatio(jog, 1.0 - ratio, 0.4, .normal),
+            LayerDesc.atRatio(curl, 0.5, 1.0, .additive),
+        };
+        item.* = BatchItem.init(inst, item_layers);
+    }
+
+    var batch = try BatchEvaluator.init(A, skel, 4);
+    defer batch.deinit(A);
+    const floats = batch.paletteFloats();
+    const palettes = try A.alloc(f32, count * floats);
+    defer A.free(palettes);
+    var bounds: [count]Bounds = undefined;
+    // One thread per worker here; a job system would reuse its own.
+    const Worker = struct {
+        fn run(evaluator: *BatchEvaluator, worker: usize, batch_items: []const BatchItem, out: []f32, out_bounds: []Bounds, result: *?anyerror) void {
+            evaluator.evaluateChunk(worker, 0, batch_items, out, out_bounds) catch |err| {
+                result.* = err;
+            };
+        }
+    };
+    var results = [_]?anyerror{null} ** 4;
+    var threads: [4]std.Thread = undefined;
+    for (&threads, &results, 0..) |*thread, *result, worker| {
+        thread.* = try std.Thread.spawn(.{}, Worker.run, .{ &batch, worker, &items, palettes, &bounds, result });
+    }
+    for (threads) |thread| thread.join();
+    for (results) |result| if (result) |err| return err;
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    for (&instances, &layers, 0..) |*inst, *item_layers, i| {
+        try inst.setLayerDescs(item_layers);
+        try std.testing.expectEqualSlices(f32, try evalModel3x4(inst, &ws), palettes[i * floats ..][0..floats]);
+        try std.testing.expectEqual(try ws.bounds(), bounds[i]);
+    }
+
+    // Items without layers keep the ones set on their instance.
+    for (&items) |*item| item.layers = null;
+    @memset(palettes, 0);
+    try evalBatch3x4(&ws, 0, items[0..1], palettes, null);
+    try std.testing.expectEqualSlices(f32, try evalModel3x4(&instances[0], &ws), palettes[0..floats]);
+
+    try std.testing.expectError(OzzError.InvalidArgument, batch.evaluateChunk(0, 0, &items, palettes[0 .. floats * 2], null));
+    try std.testing.expectError(OzzError.InvalidArgument, batch.evaluateChunk(4, 0, &items, palettes, null));
+
+    // Past OZZ_MAX_LAYERS is an error rather than a panic.
+    const too_many = [_]Layer{Layer.atRatio(walk, 0.0, 1.0, .normal)} ** (c.OZZ_MAX_LAYERS + 1);
+    try std.testing.expectError(OzzError.InvalidArgument, instances[0].setLayers(&too_many));
+    const too_many_descs = [_]LayerDesc{LayerDesc.atRatio(walk, 0.0, 1.0, .normal)} ** (c.OZZ_MAX_LAYERS + 1);
+    items[0] = BatchItem.init(&instances[0], &too_many_descs);
+    try std.testing.expectError(OzzError.InvalidArgument, batch.evaluateChunk(0, 0, items[0..1], palettes, null));
+}
+
+test "strided caller output and palette rings hand evals over without copies" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    const joints: usize = @intCast(skel.numJoints());
+
+    // Padded 16-float joints, as in a GPU buffer of 3x4 matrices plus a spare row.
+    try inst.setLayers(&[_]Layer{.{ .anim = walk, .ratio = 0.25, .weight = 1.0 }});
+    const expected = try A.dupe(f32, try evalModel3x4(&inst, &ws));
+    defer A.free(expected);
+    const strided = try A.alloc(f32, stridedPaletteFloats(joints, 16));
+    defer A.free(strided);
+    @memset(strided, -1.0);
+    @memset(@constCast(ws.palette3x4()), 0.0);
+    try evalModel3x4Into(&inst, &ws, strided, 16);
+    for (0..joints) |j| {
+        try std.testing.expectEqualSlices(f32, expected[j * 12 ..][0..12], strided[j * 16 ..][0..12]);
+        if (j + 1 < joints) try std.testing.expectEqualSlices(f32, &.{ -1, -1, -1, -1 }, strided[j * 16 + 12 ..][0..4]);
+    }
+    try std.testing.expectEqual(@as(f32, 0.0), ws.palette3x4()[0]);
+    try std.testing.expectError(OzzError.InvalidArgument, evalModel3x4Into(&inst, &ws, strided, 8));
+
+    // A depth-3 ring lets the reader pin one frame while the writer keeps going.
+    var ring = try PaletteRing.init(A, skel, .{ .depth = 3 });
+    defer ring.deinit(A);
+    try std.testing.expectError(OzzError.Busy, ring.acquire());
+
+    try evalModel3x4Ring(&inst, &ws, &ring);
+    const pinned = try ring.acquire();
+    try std.testing.expectEqual(@as(u64, 1), pinned.sequence);
+    try std.testing.expectEqualSlices(f32, expected, pinned.palette);
+    try std.testing.expectEqual(try ws.bounds(), pinned.bounds);
+
+    for (0..10) |frame| {
+        try inst.setLayers(&[_]Layer{.{ .anim = walk, .ratio = @as(f32, @floatFromInt(frame)) / 10.0, .weight = 1.0 }});
+        try evalModel3x4Ring(&inst, &ws, &ring);
+        const latest = try ring.acquire();
+        defer ring.release(latest);
+        try std.testing.expectEqual(@as(u64, frame + 2), latest.sequence);
+        try std.testing.expect(latest.slot != pinned.slot);
+    }
+    // The pinned frame was never overwritten.
+    try std.testing.expectEqualSlices(f32, expected, pinned.palette);
+
+    // Two pinned frames plus the latest one fill a depth-3 ring.
+    const second = try ring.acquire();
+    try evalModel3x4Ring(&inst, &ws, &ring);
+    try std.testing.expectError(OzzError.Busy, evalModel3x4Ring(&inst, &ws, &ring));
+    ring.release(second);
+    ring.release(pinned);
+    try evalModel3x4Ring(&inst, &ws, &ring);
+
+    // Slots in caller memory, strided like the padded palette above.
+    const slot_floats = stridedPaletteFloats(joints, 16) + 4;
+    const slots = try A.alloc(f32, 2 * slot_floats);
+    defer A.free(slots);
+    var mapped = try PaletteRing.init(A, skel, .{ .depth = 2, .joint_stride = 16, .slots = slots, .slot_stride = slot_floats });
+    defer mapped.deinit(A);
+    try evalModel3x4Ring(&inst, &ws, &mapped);
+    const mapped_frame = try mapped.acquire();
+    defer mapped.release(mapped_frame);
+    try std.testing.expect(mapped_frame.palette.ptr == slots.ptr);
+    try std.testing.expectEqual(@as(usize, 16), mapped_frame.joint_stride);
+}
+
+test "palette ring readers on other threads never cost the writer a slot" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    var ring = try PaletteRing.init(A, skel, .{ .depth = 2 });
+    defer ring.deinit(A);
+
+    // Readers pin and drop the latest frame as fast as they can, so they
+    // keep landing on slots the writer has just claimed and backing out.
+    const Reader = struct {
+        fn run(reader_ring: *PaletteRing, done: *std.atomic.Value(bool), failures: *std.atomic.Value(u32)) void {
+            var last: u64 = 0;
+            while (!done.load(.acquire)) {
+                const frame = reader_ring.acquire() catch continue;
+                defer reader_ring.release(frame);
+                if (frame.sequence < last) _ = failures.fetchAdd(1, .monotonic);
+                last = frame.sequence;
+            }
+        }
+    };
+
+    try inst.setLayers(&[_]Layer{.{ .anim = walk, .ratio = 0.0, .weight = 1.0 }});
+    try evalModel3x4Ring(&inst, &ws, &ring);
+
+    var done = std.atomic.Value(bool).init(false);
+    var failures = std.atomic.Value(u32).init(0);
+    var threads: [4]std.Thread = undefined;
+    for (&threads) |*thread| thread.* = try std.Thread.spawn(.{}, Reader.run, .{ &ring, &done, &failures });
+    for (0..20000) |frame| {
+        try inst.setLayers(&[_]Layer{.{ .anim = walk, .ratio = @as(f32, @floatFromInt(frame % 100)) / 100.0, .weight = 1.0 }});
+        evalModel3x4Ring(&inst, &ws, &ring) catch |err| if (err != OzzError.Busy) return err;
+    }
+    done.store(true, .release);
+    for (threads) |thread| thread.join();
+    try std.testing.expectEqual(@as(u32, 0), failures.load(.monotonic));
+
+    // With the readers gone, both slots can still be written and pinned in turn.
+    try evalModel3x4Ring(&inst, &ws, &ring);
+    const first = try ring.acquire();
+    try evalModel3x4Ring(&inst, &ws, &ring);
+    const second = try ring.acquire();
+    try std.testing.expect(first.slot != second.slot);
+    try std.testing.expectError(OzzError.Busy, evalModel3x4Ring(&inst, &ws, &ring));
+    ring.release(first);
+    ring.release(second);
+    try evalModel3x4Ring(&inst, &ws, &ring);
+}
+
+test "update-rate LOD staggers full evals and fills the frames in between" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    const floats = ws.palette3x4().len;
+    const joints: usize = @intCast(skel.numJoints());
+
+    // Every joint with identity inverse binds: mesh palettes are the model matrices.
+    const all_joints = try A.alloc(i32, joints);
+    defer A.free(all_joints);
+    const identities = try A.alloc(f32, joints * 12);
+    defer A.free(identities);
+    for (all_joints, 0..) |*joint, j| {
+        joint.* = @intCast(j);
+        @memcpy(identities[j * 12 ..][0..12], &[12]f32{ 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0 });
+    }
+    var everything = try MeshRemap.init(skel, all_joints, identities);
+    defer everything.deinit();
+    const mesh_palette = try A.alloc(f32, floats);
+    defer A.free(mesh_palette);
+
+    const walkAt = struct {
+        fn layers(anim: Animation, frame: u64) [1]LayerDesc {
+            return .{LayerDesc.atRatio(anim, @as(f32, @floatFromInt(frame)) / 30.0, 1.0, .normal)};
+        }
+    }.layers;
+
+    // Full evals at frames 0 and 4 of a plain instance, for reference.
+    var plain = try Instance.init(A, skel);
+    defer plain.deinit(A);
+    var poses: [2][]f32 = undefined;
+    for (&poses, [_]u64{ 0, 4 }) |*pose, frame| {
+        try plain.setLayerDescs(&walkAt(walk, frame));
+        pose.* = try A.dupe(f32, try evalModel3x4(&plain, &ws));
+    }
+    defer for (poses) |pose| A.free(pose);
+
+    for ([_]UpdateMode{ .interpolate, .extrapolate_root }) |mode| {
+        var inst = try Instance.init(A, skel);
+        defer inst.deinit(A);
+        try inst.setUpdateRate(A, skel, .{ .interval = 4, .phase = 0, .mode = mode });
+        for (0..7) |f| {
+            const frame: u64 = @intCast(f);
+            try std.testing.expectEqual(frame % 4 == 0, inst.updateDue(frame));
+            try inst.setLayerDescs(&walkAt(walk, frame));
+            const palette = try evalModel3x4At(&inst, &ws, frame);
+            // Filled in frames hand the same pose to the model matrix outputs.
+            for (palette, try ws.meshPalette3x4(everything, mesh_palette)) |a, b| {
+                try std.testing.expectApproxEqAbs(a, b, 1e-6);
+            }
+            if (frame != 6) continue;
+
+            // Halfway past the frame 4 full eval.
+            for (0..floats) |i| {
+                const expected = switch (mode) {
+                    .interpolate => poses[0][i] + (poses[1][i] - poses[0][i]) * 0.5,
+                    .extrapolate_root => if (i % 12 >= 9)
+                        poses[1][i] + (poses[1][9 + i % 3] - poses[0][9 + i % 3]) * 0.5
+                    else
+                        poses[1][i],
+                };
+                try std.testing.expectApproxEqAbs(expected, palette[i], 1e-5);
+            }
+        }
+        // Going back in time drops the history.
+        try std.testing.expect(inst.updateDue(2));
+        try inst.setLayerDescs(&walkAt(walk, 0));
+        try std.testing.expectEqualSlices(f32, poses[0], try evalModel3x4At(&inst, &ws, 0));
+
+        // Interval 1 is a plain eval every frame and gives the history back.
+        try inst.setUpdateRate(A, skel, .{});
+        try std.testing.expect(inst.history == null);
+        try inst.setLayerDescs(&walkAt(walk, 4));
+        try std.testing.expectEqualSlices(f32, poses[1], try evalModel3x4At(&inst, &ws, 5));
+    }
+
+    // Round-robin phases spread a crowd's full evals evenly over the interval.
+    const count = 8;
+    var crowd: [count]Instance = undefined;
+    var ready: usize = 0;
+    defer for (crowd[0..ready]) |*inst| inst.deinit(A);
+    while (ready < count) : (ready += 1) {
+        crowd[ready] = try Instance.init(A, skel);
+        try crowd[ready].setUpdateRate(A, skel, .{ .interval = 4 });
+    }
+    const layers = walkAt(walk, 0);
+    var items: [count]BatchItem = undefined;
+    for (&items, &crowd) |*item, *inst| item.* = BatchItem.init(inst, &layers);
+    const palettes = try A.alloc(f32, count * floats);
+    defer A.free(palettes);
+
+    var batch = try BatchEvaluator.init(A, skel, 2);
+    defer batch.deinit(A);
+    for (0..batch.workerCount()) |worker| try batch.evaluateChunk(worker, 0, &items, palettes, null);
+    for (1..9) |f| {
+        const frame: u64 = @intCast(f);
+        var due: usize = 0;
+        for (&crowd) |inst| due += @intFromBool(inst.updateDue(frame));
+        try std.testing.expectEqual(@as(usize, count / 4), due);
+        for (0..batch.workerCount()) |worker| try batch.evaluateChunk(worker, frame, &items, palettes, null);
+    }
+    // Same clip time throughout, so every frame matches a plain eval.
+    try plain.setLayerDescs(&layers);
+    const expected = try evalModel3x4(&plain, &ws);
+    for (0..count) |i| {
+        for (expected, palettes[i * floats ..][0..floats]) |e, p| try std.testing.expectApproxEqAbs(e, p, 1e-6);
+    }
+
+    try std.testing.expectError(OzzError.InvalidArgument, crowd[0].setUpdateRate(A, skel, .{ .interval = 4, .phase = 4 }));
+}
+
+test "load-time Ozz allocations route through installed Zig allocator" {
+    var counting = CountingAllocator{ .backing = std.testing.allocator };
+    try installAllocator(counting.allocator());
+    defer resetAllocator() catch unreachable;
+
+    {
+        var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+        defer skel.deinit();
+
+        var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+        defer walk.deinit();
+    }
+
+    try std.testing.expect(counting.allocations > 0);
+    try std.testing.expect(counting.deallocations > 0);
+    try std.testing.expectEqual(counting.allocated_bytes, counting.freed_bytes);
+}
+
+test "baked clips replay model-space frames without sampling" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+
+    var clip = try BakedClip.init(skel, walk, 30.0);
+    defer clip.deinit();
+    try std.testing.expectEqual(skel.numJoints(), clip.numJoints());
+    try std.testing.expect(clip.numFrames() >= 2);
+    try std.testing.expectEqual(walk.duration(), clip.duration());
+
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    var plain = try Instance.init(A, skel);
+    defer plain.deinit(A);
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+
+    // On baked frames both forms match the full eval up to quantization.
+    const last: f32 = @floatFromInt(clip.numFrames() - 1);
+    for ([_]usize{ 0, 1, clip.numFrames() / 2, clip.numFrames() - 1 }) |frame| {
+        const ratio = @as(f32, @floatFromInt(frame)) / last;
+        try plain.setLayerDescs(&.{LayerDesc.atRatio(walk, ratio, 1.0, .normal)});
+        const expected = try A.dupe(f32, try evalModel3x4(&plain, &ws));
+        defer A.free(expected);
+        for ([_]bool{ false, true }) |nearest| {
+            try inst.setLayerDescs(&.{LayerDesc.atBaked(clip, ratio, nearest)});
+            for (expected, try evalModel3x4(&inst, &ws)) |e, b| try std.testing.expectApproxEqAbs(e, b, 1e-3);
+        }
+    }
+
+    // Nearest snaps to the closest frame; the default lerps towards the next.
+    const quarter = 0.25 / last;
+    try inst.setLayerDescs(&.{LayerDesc.atBaked(clip, 0.0, true)});
+    const first = try A.dupe(f32, try evalModel3x4(&inst, &ws));
+    defer A.free(first);
+    try inst.setLayerDescs(&.{LayerDesc.atBaked(clip, quarter, true)});
+    try std.testing.expectEqualSlices(f32, first, try evalModel3x4(&inst, &ws));
+    try inst.setLayerDescs(&.{LayerDesc.atBaked(clip, quarter, false)});
+    try std.testing.expect(!std.mem.eql(f32, first, try evalModel3x4(&inst, &ws)));
+
+    // Baked layers stand alone and only go through full evals.
+    try std.testing.expectError(OzzError.InvalidArgument, evalLocals(&inst, &ws));
+    try inst.setLayerDescs(&.{ LayerDesc.atBaked(clip, 0.0, false), LayerDesc.atRatio(walk, 0.0, 1.0, .normal) });
+    try std.testing.expectError(OzzError.InvalidArgument, evalModel3x4(&inst, &ws));
+    try inst.setLayerDescs(&.{LayerDesc.atBaked(clip, 1.5, false)});
+    try std.testing.expectError(OzzError.InvalidArgument, evalModel3x4(&inst, &ws));
+
+    try std.testing.expectError(OzzError.InvalidArgument, BakedClip.init(skel, walk, 0.0));
+    try std.testing.expectError(OzzError.Io, BakedClip.loadFromFileZ("assets/does_not_exist.ozz"));
+}
+
+test "motion database finds the frame closest to a query" {
+    const A = std.testing.allocator;
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+    var jog = try Animation.loadFromFileZ("assets/pab_jog_no_motion.ozz");
+    defer jog.deinit();
+    var run = try Animation.loadFromFileZ("assets/pab_run_no_motion.ozz");
+    defer run.deinit();
+
+    const joints = [_]i32{ skel.findJointZ("LeftFoot"), skel.findJointZ("RightFoot"), skel.findJointZ("LeftHand") };
+    const desc = MotionDbDesc{
+        .clips = &.{ walk.handle, jog.handle, run.handle },
+        .feature_joints = &joints,
+        .trajectory_times = &.{ 0.2, 0.4, 0.6 },
+        .sample_rate = 60,
+    };
+    var db = try MotionDb.init(skel, desc);
+    defer db.deinit();
+    const dims = db.featureCount();
+    try std.testing.expectEqual(@as(usize, 3 * 6 + 3 * 4), dims);
+    try std.testing.expect(db.frameCount() > 3 * 60 / 2);
+
+    var mean: [64]f32 = undefined;
+    var scale: [64]f32 = undefined;
+    try db.normalization(mean[0..dims], scale[0..dims]);
+
+    // Perturbed frames, searched in one batch and checked against a scan.
+    const count = 64;
+    const queries = try A.alloc(f32, count * dims);
+    defer A.free(queries);
+    var prng = std.Random.DefaultPrng.init(0x6d6d);
+    const random = prng.random();
+    for (0..count) |i| {
+        const query = queries[i * dims ..][0..dims];
+        _ = try db.frameFeatures((i * 37) % db.frameCount(), query);
+        for (query) |*f| f.* += random.floatNorm(f32) * 0.01;
+    }
+    var matches: [count]MotionMatch = undefined;
+    try db.search(queries, dims, &matches);
+
+    var features: [64]f32 = undefined;
+    for (matches, 0..) |match, i| {
+        const query = queries[i * dims ..][0..dims];
+        var best = std.math.inf(f32);
+        for (0..db.frameCount()) |frame| {
+            var cost: f32 = 0;
+            for (try db.frameFeatures(frame, &features), query, scale[0..dims]) |f, q, s| cost += (f - q) * s * (f - q) * s;
+            best = @min(best, cost);
+        }
+        try std.testing.expectApproxEqRel(best, match.cost, 1e-4);
+        try std.testing.expect(match.clip >= 0 and match.clip < 3);
+        try std.testing.expect(match.ratio >= 0 and match.ratio <= 1);
+    }
+
+    // Reloaded databases give the same answers.
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    var path_buf: [256]u8 = undefined;
+    const path = try std.fmt.bufPrintZ(&path_buf, ".zig-cache/tmp/{s}/locomotion.mmdb", .{tmp.sub_path});
+    try db.saveToFileZ(path);
+    var loaded = try MotionDb.loadFromFileZ(path);
+    defer loaded.deinit();
+    var reloaded: [count]MotionMatch = undefined;
+    try loaded.search(queries, dims, &reloaded);
+    for (matches, reloaded) |a, b| {
+        try std.testing.expectEqual(a.frame, b.frame);
+        try std.testing.expectEqual(a.ratio, b.ratio);
+    }
+    try std.testing.expectError(OzzError.OzzFailure, MotionDb.loadFromFileZ("assets/pab_skeleton.ozz"));
+
+    // A frame's own features match it exactly.
+    const last = try db.frameFeatures(db.frameCount() - 1, &features);
+    const match = try db.searchOne(last);
+    try std.testing.expectApproxEqAbs(@as(f32, 0), match.cost, 1e-6);
+    try std.testing.expectEqual(@as(i32, 2), match.clip);
+
+    features[0] = std.math.nan(f32);
+    try std.testing.expectError(OzzError.InvalidArgument, db.searchOne(features[0..dims]));
+    var bad = desc;
+    bad.velocity_weight = 0;
+    try std.testing.expectError(OzzError.InvalidArgument, MotionDb.init(skel, bad));
+    bad = desc;
+    bad.facing_axis = 3;
+    try std.testing.expectError(OzzError.InvalidArgument, MotionDb.init(skel, bad));
+}
+
+test "shared keyframe segments sample crowds exactly like private contexts" {
+    const A = std.testing.allocator;
+    defer setSegmentCache(null);
+    try std.testing.expectError(OzzError.InvalidArgument, SegmentCache.init(0, 1 << 20));
+    try std.testing.expectError(OzzError.InvalidArgument, SegmentCache.init(64, 16));
+
+    var skel = try Skeleton.loadFromFileZ("assets/pab_skeleton.ozz");
+    defer skel.deinit();
+    var walk = try Animation.loadFromFileZ("assets/pab_walk_no_motion.ozz");
+    defer walk.deinit();
+    var run = try Animation.loadFromFileZ("assets/pab_run_no_motion.ozz");
+    defer run.deinit();
+    var curl = try Animation.loadFromFileZ("assets/pab_curl_additive.ozz");
+    defer curl.deinit();
+
+    var inst = try Instance.init(A, skel);
+    defer inst.deinit(A);
+    var ws = try Workspace.init(A, skel);
+    defer ws.deinit(A);
+    const floats = ws.palette3x4().len;
+    const expected = try A.alloc(f32, floats);
+    defer A.free(expected);
+
+    // A tiny cache evicts all along, a big one keeps everything.
+    for ([_]usize{ 64 << 10, 4 << 20 }) |budget| {
+        var cache = try SegmentCache.init(skel.numJoints(), budget);
+        defer cache.deinit();
+        for (0..200) |i| {
+            const ratio = @mod(@as(f32, @floatFromInt(i % 10)) * 0.001 + @as(f32, @floatFromInt(i / 10)) * 0.05, 1.0);
+            try inst.setLayers(&[_]Layer{
+                .{ .anim = if (i % 2 == 0) walk else run, .ratio = ratio, .weight = 1.0, .mode = .normal },
+                .{ .anim = curl, .ratio = 1.0 - ratio, .weight = 1.0, .mode = .additive },
+            });
+            setSegmentCache(null);
+            @memcpy(expected, try evalModel3x4(&inst, &ws));
+            setSegmentCache(cache);
+            try std.testing.expectEqualSlices(f32, expected, try evalModel3x4(&inst, &ws));
+        }
+        setSegmentCache(null);
+        const stats = cache.stats();
+        try std.testing.expect(stats.hits > 0);
+        try std.testing.expect(stats.inserts > 0);
+        try std.testing.expectEqual(@as(u64, 0), stats.bypasses);
+        try std.testing.expect(stats.bytes <= budget);
+    }
+
+    // Clips with more tracks than a slot holds sample without the cache.
+    var small = try SegmentCache.init(1, 1 << 16);
+    defer small.deinit();
+    setSegmentCache(small);
+    try inst.setLayers(&[_]Layer{.{ .anim = walk, .ratio = 0.4, .weight = 1.0, .mode = .normal }});
+    _ = try evalModel3x4(&inst, &ws);
+    setSegmentCache(null);
+    try std.testing.expect(small.stats().bypasses > 0);
+    try std.testing.expectEqual(@as(u64, 0), small.stats().hits);
 }